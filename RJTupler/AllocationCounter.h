@@ -0,0 +1,41 @@
+#ifndef RJTupler_AllocationCounter_h
+#define RJTupler_AllocationCounter_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// AllocationCounter
+//
+// RJTuplerLib replaces the global operator new/delete with versions that
+// count the allocations (and bytes) made by each thread while counting is
+// switched on. Switched off, which is the default, the only cost is a
+// relaxed load of the switch per allocation.
+//
+// The counts are read by PerfCounters to charge allocations to the stages
+// of the event loop (--alloc-audit), and by the microbenchmarks to check
+// that the variable blocks do not allocate once they are warmed up.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <cstdint>
+
+namespace rjt {
+namespace alloc {
+
+    struct Counts {
+        Counts() : allocations(0), bytes(0) {}
+        uint64_t allocations;
+        uint64_t bytes;
+    };
+
+    // switch counting on or off (for all threads)
+    void set_counting(bool on);
+    bool counting();
+
+    // allocations made by the calling thread while counting was on
+    Counts thread_counts();
+
+} // namespace alloc
+} // namespace rjt
+
+#endif
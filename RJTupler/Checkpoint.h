@@ -0,0 +1,92 @@
+#ifndef RJTupler_Checkpoint_h
+#define RJTupler_Checkpoint_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Checkpoint
+//
+// The sidecar file of a checkpointed job. The entries of the job are
+// processed in segments (consecutive cluster ranges, see EventLoop), each
+// written to its own output file, and after every segment the sidecar is
+// rewritten with the segments completed so far:
+//
+//      input <sample>
+//      entries <entries in the job>
+//      segment_entries <entries per segment>
+//      segment <first> <last> <file>     one line per completed segment
+//
+// A completed segment file is closed and complete, with its own cutflow
+// and sum-of-weights histograms, so a job that is killed loses at most
+// the segment in progress. A resumed job checks that it runs on the same
+// input with the same segmentation, skips the completed segments and at
+// the end merges all segment files into one output (see OrderedMerge).
+// The merged output equals that of an uninterrupted run as long as every
+// per-event quantity depends only on the event itself; the ntupler's random
+// trigger draw is seeded from the event for this reason.
+//
+// The sidecar is written to a temporary file and renamed into place, so
+// a job killed while saving leaves the previous checkpoint intact.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+
+// RJTupler
+#include "RJTupler/EventLoop.h"
+
+namespace rjt {
+
+    struct CheckpointSegment {
+        EntryRange range;
+        std::string file;
+    };
+
+    class Checkpoint {
+
+        public :
+            Checkpoint(const std::string& filename, const std::string& input,
+                    Long64_t n_entries, Long64_t segment_entries);
+
+            const std::string& filename() const { return m_filename; }
+
+            bool exists() const;
+
+            // read the sidecar of an earlier run of the same job, returns
+            // false if it can't be read, belongs to another job, or a
+            // completed segment's file is missing; the segmentation of the
+            // earlier run is adopted
+            bool load(const std::string& label);
+
+            // write the sidecar
+            bool save() const;
+
+            // delete the sidecar, once the job's output is complete
+            void remove() const;
+
+            Long64_t segment_entries() const { return m_segment_entries; }
+            const std::vector<CheckpointSegment>& segments() const { return m_segments; }
+
+            // the entry after the last one fully processed
+            Long64_t last_entry() const;
+
+            void add_segment(const EntryRange& range, const std::string& file);
+
+        private :
+            std::string m_filename;
+            std::string m_input;
+            Long64_t m_n_entries;
+            Long64_t m_segment_entries;
+            std::vector<CheckpointSegment> m_segments;
+
+    }; // class Checkpoint
+
+    // the ranges grouped into segments of about segment_entries entries
+    // each (whole ranges, in order)
+    std::vector<std::vector<EntryRange> > checkpoint_segments(const std::vector<EntryRange>& ranges,
+            Long64_t segment_entries);
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef RJTupler_ClockedSuperflow_h
+#define RJTupler_ClockedSuperflow_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// ClockedSuperflow
+//
+// Superflow with the start and end of every entry, and every input file
+// change, reported to a StageClock, and the start of every entry to the
+// hardware counters (either may be null). Only used when the stage
+// breakdown or the counters are requested, the plain Superflow is used
+// otherwise.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Superflow
+#include "Superflow/Superflow.h"
+
+// RJTupler
+#include "RJTupler/StageClock.h"
+#include "RJTupler/PerfCounters.h"
+
+namespace rjt {
+
+    class ClockedSuperflow : public sflow::Superflow {
+
+        public :
+            explicit ClockedSuperflow(StageClock* clock, PerfCounters* counters = nullptr);
+
+            virtual void Init(TTree* tree);
+            virtual Bool_t Notify();
+            virtual Bool_t Process(Long64_t entry);
+
+        private :
+            StageClock* m_clock;
+            PerfCounters* m_counters;
+            TTree* m_input;
+
+    }; // class ClockedSuperflow
+
+} // namespace rjt
+
+#endif
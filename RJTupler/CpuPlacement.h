@@ -0,0 +1,57 @@
+#ifndef RJTupler_CpuPlacement_h
+#define RJTupler_CpuPlacement_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CpuPlacement
+//
+// Pins forked workers to CPUs (--cpu-list) and keeps the memory they
+// allocate on the NUMA node of their CPU. Worker i runs on the i-th CPU
+// of the list (wrapping around), so the list order decides how the
+// workers are spread over the sockets, e.g. "0-7" fills the cores of the
+// first socket before any other, while "0,8,1,9,..." alternates.
+//
+// A worker is placed first thing after the fork, before it opens its
+// input or output. Its event buffers, baskets and the pages it copies
+// from the parent are then allocated on its local node. The node
+// preference is not strict, so a full node spills over to the others.
+//
+//      std::vector<rjt::CpuPlacement> placement = rjt::plan_placement(cpus, n_workers);
+//      ...
+//      rjt::apply_placement(placement[worker], label);     // in the workers
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+namespace rjt {
+
+    struct CpuPlacement {
+        CpuPlacement() : cpu(-1), node(-1) {}
+        int cpu;
+        int node;   // NUMA node of the cpu, -1 if unknown
+    };
+
+    // parse a CPU list as the kernel writes them ("0-7,16-23"), returns
+    // false if it is malformed
+    bool parse_cpu_list(const std::string& spec, std::vector<int>& cpus);
+
+    // NUMA node of the cpu, -1 if unknown (no NUMA information)
+    int cpu_node(int cpu);
+
+    // the placement of each of n_workers on the cpus
+    std::vector<CpuPlacement> plan_placement(const std::vector<int>& cpus, int n_workers);
+
+    // pin the calling process to the placement's cpu and prefer its node
+    // for new memory, returns false (after a warning) if either fails
+    bool apply_placement(const CpuPlacement& placement, const std::string& label);
+
+    void print_placement(std::ostream& out, const std::string& label,
+            const std::vector<CpuPlacement>& placement);
+
+} // namespace rjt
+
+#endif
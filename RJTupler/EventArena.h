@@ -0,0 +1,98 @@
+#ifndef RJTupler_EventArena_h
+#define RJTupler_EventArena_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EventArena
+//
+// Bump-pointer memory for objects that live for one event. Objects and
+// small arrays are carved out of a few large blocks, and reset() releases
+// all of them at once (running the destructors of objects that have one):
+//
+//      rjt::EventArena arena;
+//      TLorentzVector* ll = arena.make<TLorentzVector>(*l0 + *l1);
+//      double* pts = arena.make_array<double>(leptons.size());
+//      ...
+//      arena.reset(); // end of event
+//
+// The blocks are kept across resets, so once the first events have sized
+// the arena it no longer touches the heap.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <vector>
+
+namespace rjt {
+
+    class EventArena {
+
+        public :
+            explicit EventArena(size_t block_size = 16384);
+            ~EventArena();
+
+            // construct a T in the arena, valid until the next reset()
+            template <class T, class... Args>
+            T* make(Args&&... args)
+            {
+                void* memory = allocate(sizeof(T), alignof(T));
+                T* object = new (memory) T(std::forward<Args>(args)...);
+                if(!std::is_trivially_destructible<T>::value) {
+                    m_cleanups.push_back(Cleanup(&destroy<T>, object));
+                }
+                return object;
+            }
+
+            // n value-initialised elements, valid until the next reset()
+            template <class T>
+            T* make_array(size_t n)
+            {
+                static_assert(std::is_trivially_destructible<T>::value,
+                        "EventArena arrays hold trivially destructible types only");
+                T* array = static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+                for(size_t i = 0; i < n; i++) new (array + i) T();
+                return array;
+            }
+
+            // destroy everything made since the last reset and rewind
+            void reset();
+
+            // bytes handed out since the last reset, and held in blocks
+            size_t used() const { return m_used; }
+            size_t capacity() const;
+
+        private :
+            struct Block {
+                char* data;
+                size_t size;
+            };
+            struct Cleanup {
+                Cleanup(void (*destroy_)(void*), void* object_) : destroy(destroy_), object(object_) {}
+                void (*destroy)(void*);
+                void* object;
+            };
+
+            size_t m_block_size;
+            std::vector<Block> m_blocks;
+            size_t m_current;   // block being carved
+            size_t m_offset;    // into the current block
+            size_t m_used;
+            std::vector<Cleanup> m_cleanups;
+
+            void* allocate(size_t size, size_t align);
+
+            template <class T>
+            static void destroy(void* object) { static_cast<T*>(object)->~T(); }
+
+            EventArena(const EventArena&);
+            EventArena& operator=(const EventArena&);
+
+    }; // class EventArena
+
+} // namespace rjt
+
+#endif
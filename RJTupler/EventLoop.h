@@ -0,0 +1,71 @@
+#ifndef RJTupler_EventLoop_h
+#define RJTupler_EventLoop_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EventLoop
+//
+// Runs a TSelector (Superflow) over a sequence of entry ranges of a chain
+// rather than over one contiguous block, the way TTree::Process does it
+// for a single block: Begin/SlaveBegin/Init once, Process for every entry
+// of every range (Notify whenever the chain moves to another file), and
+// SlaveTerminate/Terminate at the end.
+//
+// The ranges are handed out one at a time by a callback, so that forked
+// workers can take them from a shared queue (see WorkStealingQueue):
+//
+//      rjt::process_ranges(chain, superflow, option,
+//              [&](rjt::EntryRange& range) { return queue.next(worker, range); });
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <functional>
+
+// ROOT
+#include "Rtypes.h"
+
+class TChain;
+class TSelector;
+
+namespace rjt {
+
+    // entries [first, last) of a chain
+    struct EntryRange {
+        EntryRange() : first(0), last(0) {}
+        EntryRange(Long64_t first_, Long64_t last_) : first(first_), last(last_) {}
+        Long64_t first;
+        Long64_t last;
+        Long64_t size() const { return last - first; }
+    };
+
+    // the first n_entries of the chain (all of them if negative) split at
+    // the cluster boundaries of its trees, in entry order
+    std::vector<EntryRange> cluster_ranges(TChain* chain, Long64_t n_entries = -1);
+
+    // split the ranges into n_parts contiguous runs of about the same number
+    // of entries, returns the index of the first range of each part
+    // followed by ranges.size()
+    std::vector<size_t> split_ranges(const std::vector<EntryRange>& ranges, int n_parts);
+
+    // the ranges of part shard_index of such a split into n_shards; the
+    // shards merged in order equal a full run as long as nothing computed
+    // for an event depends on which job processes it (random draws have to
+    // be seeded from the event, not from the job)
+    std::vector<EntryRange> shard_ranges(const std::vector<EntryRange>& ranges, int shard_index, int n_shards);
+
+    // the ranges cut down to the entries [first, last), last < 0 meaning
+    // up to the end
+    std::vector<EntryRange> clip_ranges(const std::vector<EntryRange>& ranges, Long64_t first, Long64_t last);
+
+    // process the ranges given by next_range (false: no more) with the
+    // selector, keeping *current_entry (if given) at the chain entry being
+    // processed, returns the number of entries processed
+    Long64_t process_ranges(TChain* chain, TSelector* selector, const std::string& option,
+            const std::function<bool(EntryRange&)>& next_range, Long64_t* current_entry = nullptr);
+
+} // namespace rjt
+
+#endif
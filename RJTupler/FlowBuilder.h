@@ -0,0 +1,243 @@
+#ifndef RJTupler_FlowBuilder_h
+#define RJTupler_FlowBuilder_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// FlowBuilder
+//
+// A recording front-end for Superflow. It accepts exactly the same
+// streaming syntax as Superflow (CutName, NewVar/HFTname/<lambda>/SaveVar,
+// var_void lambdas, NewSystematic/...), but records every cut, variable
+// and producer as a node instead of handing it straight to Superflow.
+// The nodes are emitted into a Superflow instance with build().
+//
+// Recording first lets the ntupler attach information that Superflow does
+// not know about to each node, in particular which inputs it reads:
+//
+//      *cutflow << rjt::InputScope("leptons");   // all nodes that follow
+//      *cutflow << rjt::Inputs("jets");          // the next node only
+//
+// and lets build() decide, per Superflow instance, which variables are
+// actually stored (e.g. only the ones depending on systematically varied
+// objects in a systematic tree).
+//
+// Producers (var_void blocks filling shared state) and variables whose
+// lambdas fill state used by later nodes name what they provide:
+//
+//      *cutflow << rjt::Outputs("restframes") << [&](Superlink* sl, var_void*) { ... };
+//
+// Inputs and outputs make up the dependency graph: a node reading a name
+// depends on the (single) node providing it. Names that no node provides
+// must be declared as external inputs (the objects read from the
+// Superlink). build() then
+//
+//  - prunes everything not needed: it keeps cuts, stored variables,
+//    producers without declared outputs, and whatever provides an input
+//    read by one of those (a variable needed only for what it provides is
+//    evaluated but not stored),
+//  - emits the nodes in dependency order, keeping the recorded order
+//    wherever the graph does not constrain it,
+//  - refuses graphs with cycles, two providers of the same name, duplicate
+//    HFTnames or undeclared inputs.
+//
+// Nodes can also be grouped into the stages the hardware counters are
+// charged to (see PerfCounters), nodes without one are in "other":
+//
+//      *cutflow << rjt::CounterStage("restframes");  // all nodes that follow
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <functional>
+
+// Superflow
+#include "Superflow/Superflow.h"
+#include "Superflow/Superlink.h"
+
+// RJTupler
+#include "RJTupler/StageTimer.h"
+#include "RJTupler/PerfCounters.h"
+
+namespace rjt {
+
+    // inputs read by every node registered after this, until the next InputScope
+    struct InputScope {
+        explicit InputScope(const std::string& names_) : names(names_) {}
+        std::string names;
+    };
+
+    // inputs read by the next node only, in addition to the current scope
+    struct Inputs {
+        explicit Inputs(const std::string& names_) : names(names_) {}
+        std::string names;
+    };
+
+    // names provided by the next node only
+    struct Outputs {
+        explicit Outputs(const std::string& names_) : names(names_) {}
+        std::string names;
+    };
+
+    // hardware-counter stage (see PerfCounters) of every node registered
+    // after this, until the next CounterStage
+    struct CounterStage {
+        explicit CounterStage(const std::string& name_) : name(name_) {}
+        std::string name;
+    };
+
+    // instrumentation wrapped around a node's function by build()
+    struct NodeHooks {
+        NodeHooks() : timer(nullptr), stage(0), counters(nullptr), counter_stage(0) {}
+        StageTimer* timer;
+        size_t stage;
+        PerfCounters* counters;
+        size_t counter_stage;
+    };
+
+    // split a space or comma separated list of names
+    std::vector<std::string> split_names(const std::string& names);
+
+    struct FlowNode {
+        enum Kind { Cut, Var, Void, Systematic };
+
+        FlowNode() : kind(Void), save(false), counter_stage("other") {}
+
+        Kind kind;
+        std::string name;   // CutName or NewVar description
+        std::string hft;    // HFTname (variables only)
+        std::vector<std::string> inputs;
+        std::vector<std::string> outputs;
+        bool save;          // SaveVar was given
+        std::string counter_stage;
+
+        // hands the node's function (or systematic item) to Superflow
+        std::function<void(sflow::Superflow&)> emit;
+
+        // same, with the function wrapped in the given timer and counter
+        // hooks (not used for systematic items)
+        std::function<void(sflow::Superflow&, const NodeHooks&)> emit_instrumented;
+
+        // evaluates the node's function and discards the result
+        std::function<void(sflow::Superlink*)> evaluate;
+
+        bool reads(const std::string& input) const;
+        bool provides(const std::string& output) const;
+
+        // description used in messages
+        std::string label() const;
+    };
+
+    class FlowBuilder {
+
+        public :
+            FlowBuilder();
+
+            ///////////////////////////////////////////////////////////
+            // Superflow streaming interface
+            ///////////////////////////////////////////////////////////
+            FlowBuilder& operator<<(sflow::CutName cut_name);
+            FlowBuilder& operator<<(std::function<bool(sflow::Superlink*)> cut);
+
+            FlowBuilder& operator<<(sflow::NewVar new_var);
+            FlowBuilder& operator<<(sflow::HFTname hft_name);
+            FlowBuilder& operator<<(std::function<double(sflow::Superlink*, sflow::var_float*)> var);
+            FlowBuilder& operator<<(std::function<double(sflow::Superlink*, sflow::var_double*)> var);
+            FlowBuilder& operator<<(std::function<int(sflow::Superlink*, sflow::var_int*)> var);
+            FlowBuilder& operator<<(std::function<bool(sflow::Superlink*, sflow::var_bool*)> var);
+            FlowBuilder& operator<<(std::function<std::vector<double>(sflow::Superlink*, sflow::var_float_array*)> var);
+            FlowBuilder& operator<<(std::function<std::vector<int>(sflow::Superlink*, sflow::var_int_array*)> var);
+            FlowBuilder& operator<<(std::function<void(sflow::Superlink*, sflow::var_void*)> var);
+            FlowBuilder& operator<<(sflow::SaveVar save_var);
+
+            FlowBuilder& operator<<(sflow::NewSystematic new_sys);
+            FlowBuilder& operator<<(sflow::EventSystematic event_sys);
+            FlowBuilder& operator<<(sflow::WeightSystematic weight_sys);
+            FlowBuilder& operator<<(sflow::TreeName tree_name);
+            FlowBuilder& operator<<(sflow::SaveSystematic save_sys);
+
+            ///////////////////////////////////////////////////////////
+            // dependency annotations
+            ///////////////////////////////////////////////////////////
+            FlowBuilder& operator<<(InputScope scope);
+            FlowBuilder& operator<<(Inputs inputs);
+            FlowBuilder& operator<<(Outputs outputs);
+            FlowBuilder& operator<<(CounterStage stage);
+
+            // names read from outside the flow (the Superlink objects)
+            void set_external_inputs(const std::string& names);
+
+            ///////////////////////////////////////////////////////////
+            // output configuration
+            ///////////////////////////////////////////////////////////
+
+            // store only the variables that read at least one of the given
+            // inputs (directly or through a node's outputs), plus the key
+            // columns
+            void save_only_dependent_on(const std::vector<std::string>& inputs,
+                    const std::vector<std::string>& key_columns);
+
+            // store only the variables whose HFTname fully matches one of the
+            // regular expressions; returns false if a pattern is invalid
+            bool select_variables(const std::vector<std::string>& patterns);
+
+            // the HFTnames that build() will store
+            std::vector<std::string> saved_columns() const;
+
+            // number of variables (stored or not) and producers build() will
+            // emit, and the number recorded
+            size_t n_active() const;
+            size_t n_evaluable() const;
+
+            // check the dependency graph, printing any problem found
+            bool validate() const;
+
+            // indices of the nodes build() emits, in emission order
+            std::vector<size_t> schedule() const;
+
+            // emit the needed nodes into the given Superflow, if a timer is
+            // given every cut, variable and producer is timed as a stage, if
+            // counters are given every node enters its counter stage
+            void build(sflow::Superflow& superflow, StageTimer* timer = nullptr,
+                    PerfCounters* counters = nullptr) const;
+
+            const std::vector<FlowNode>& nodes() const { return m_nodes; }
+
+        private :
+            std::vector<FlowNode> m_nodes;
+            FlowNode m_pending;
+            bool m_has_pending;
+            std::string m_pending_cut;
+            std::vector<std::string> m_scope;
+            std::vector<std::string> m_next_inputs;
+            std::vector<std::string> m_next_outputs;
+            std::string m_counter_stage;
+
+            std::vector<std::string> m_external;
+
+            bool m_has_selection;
+            std::vector<std::string> m_selected;
+
+            bool m_differential;
+            std::vector<std::string> m_varied_inputs;
+            std::vector<std::string> m_key_columns;
+
+            // start a node, attaching the current input annotations
+            FlowNode make_node(FlowNode::Kind kind);
+            void add_systematic_item(const std::function<void(sflow::Superflow&)>& emit);
+            bool is_selected(const FlowNode& node) const;
+            std::vector<bool> saved_nodes() const;
+            std::vector<bool> active_nodes() const;
+
+            // node providing each name, -1 if none (or a duplicate is found)
+            int provider(const std::string& name) const;
+
+            template <class R, class Tag>
+            FlowBuilder& add_var(const std::function<R(sflow::Superlink*, Tag*)>& var);
+
+    }; // class FlowBuilder
+
+} // namespace rjt
+
+#endif
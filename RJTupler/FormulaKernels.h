@@ -0,0 +1,47 @@
+#ifndef RJTupler_FormulaKernels_h
+#define RJTupler_FormulaKernels_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// FormulaKernels
+//
+// Stateless, compiled replacements for the ROOT TFormula expressions used
+// by event-level variables. Each kernel evaluates the expression of the
+// corresponding ROOT built-in with the same operations in the same order,
+// so that the values stored in the output ntuple agree with the TF1 ones
+// to within rounding (bench/microbench checks this), but without going
+// through the formula interpreter or touching shared mutable TF1 state.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+namespace rjt {
+namespace kernels {
+
+    // pi, as TMath::Pi()
+    constexpr double pi = 3.14159265358979323846;
+
+    // Normalized Gaussian, TF1("f", "gausn") with parameters [0] = norm,
+    // [1] = mean, [2] = sigma evaluated at x, written as TFormula expands it:
+    //      norm * exp(-0.5*((x-mean)/sigma)*((x-mean)/sigma)) / (sqrt(2*pi)*sigma)
+    // As with TF1, no protection is applied for sigma == 0.
+    inline double gausn(double x, double norm, double mean, double sigma)
+    {
+        const double arg = (x - mean) / sigma;
+        return norm * std::exp(-0.5 * (arg * arg)) / (std::sqrt(2 * pi) * sigma);
+    }
+
+    // Density of pileup interactions at the primary vertex position, taking
+    // the luminous region to be a Gaussian beam spot along z carrying the
+    // actual number of interactions per bunch crossing.
+    inline double pileup_density(double actual_mu, double beam_pos_z,
+            double beam_sigma_z, double pv_z)
+    {
+        return gausn(pv_z, actual_mu, beam_pos_z, beam_sigma_z);
+    }
+
+} // namespace kernels
+} // namespace rjt
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef RJTupler_IOPipeline_h
+#define RJTupler_IOPipeline_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// IOPipeline
+//
+// Overlaps the input and output work of the event loop with the (serial)
+// Superflow processing of the entries:
+//
+//      reader : a prefetching thread reads the baskets of the upcoming
+//               entries into a read-ahead cache of bounded size, and helper
+//               threads decompress them ahead of GetEntry
+//      writer : full output baskets are compressed by parallel tasks
+//               instead of inline in TTree::Fill
+//
+// The read-ahead cache is the queue between the reader and the event loop,
+// a full cache holds the reader back until the loop catches up.
+//
+// Superflow builds the objects, evaluates the cuts and variables and fills
+// the output trees within one Process() call, so those stay on the thread
+// running the event loop.
+//
+//      rjt::enable_read_ahead();                    // before opening any input
+//      ...
+//      rjt::start_io_pipeline(chain, n_threads, cache_mb);  // in the process running the loop
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+
+class TChain;
+
+namespace rjt {
+
+    // let ROOT prefetch input baskets on a separate thread, must be called
+    // before the input files are opened
+    void enable_read_ahead();
+
+    // attach a read-ahead cache of the given size (MB) to the chain and
+    // start n_threads helper threads for unzipping and output compression,
+    // to be called by the process running the event loop (the threads do
+    // not survive a fork), returns false if the cache can't be set up
+    bool start_io_pipeline(TChain* chain, int n_threads, int cache_mb, const std::string& label);
+
+} // namespace rjt
+
+#endif
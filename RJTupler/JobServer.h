@@ -0,0 +1,84 @@
+#ifndef RJTupler_JobServer_h
+#define RJTupler_JobServer_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// JobServer
+//
+// Serves ntupler jobs on a Unix-domain socket from a process that has
+// already done all of its (slow) initialization. Every job runs in a
+// child forked from that state, so each one starts with the dictionaries
+// loaded, the tools initialized and the variables registered, and a
+// failing job can't take the server down. What depends on the input, the
+// trigger tool (set up from the input's trigger histogram) in particular,
+// is set up again in the child from the job's own input.
+//
+// A request is a few "<key> <value>" lines closed by an empty line:
+//
+//      input <sample>          as given to -i
+//      events <n>              entries to process (default: all)
+//      output <dir>            directory the output is written to
+//      suffix <s>              output file suffix
+//
+// or the single line "shutdown". The job's output (progress reports,
+// cutflow, ...) is streamed back on the connection as it is printed,
+// followed by the status line
+//
+//      ntupler-server: exit <status>
+//
+// The client closing the connection cancels the job. submit_job() is the
+// client side, as used by util/ntupler_submit.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <functional>
+#include <iosfwd>
+
+// ROOT
+#include "Rtypes.h"
+
+namespace rjt {
+
+    struct JobRequest {
+        JobRequest() : n_events(-1), shutdown(false) {}
+        std::string input;
+        Long64_t n_events;
+        std::string output_dir;
+        std::string suffix;
+        bool shutdown;
+    };
+
+    class JobServer {
+
+        public :
+            JobServer(const std::string& socket_path, const std::string& label = "JobServer");
+            ~JobServer();
+
+            // bind and listen on the socket (replacing a stale socket file)
+            bool listen();
+
+            // serve the requests one at a time until a shutdown request,
+            // SIGINT or SIGTERM, running run_job(request) in a forked child
+            // whose stdout and stderr go to the client; returns the number
+            // of jobs that failed
+            int serve(const std::function<int(const JobRequest&)>& run_job);
+
+        private :
+            std::string m_path;
+            std::string m_label;
+            int m_fd;
+
+            bool read_request(int fd, JobRequest& request, std::string& error) const;
+
+    }; // class JobServer
+
+    // send the request to the server at socket_path, copying the streamed
+    // output to out; returns the job's exit status (-1 if the server can't
+    // be reached or the connection is lost)
+    int submit_job(const std::string& socket_path, const JobRequest& request, std::ostream& out);
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef RJTupler_MemoryReport_h
+#define RJTupler_MemoryReport_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// MemoryReport
+//
+// How much of the memory of forked workers is still shared copy-on-write
+// with the process they were forked from. The parent's usage is taken
+// when the report is created (after initialization, before forking), and
+// each worker records its own at the end of its event loop into shared
+// memory, from /proc/self/smaps_rollup:
+//
+//      rss     resident
+//      pss     proportional: shared pages divided among their sharers
+//      shared  resident and shared with another process
+//
+// The job really uses about the parent's RSS plus the unshared part of
+// each worker's, to compare with the RSS of as many independent processes.
+//
+//      rjt::MemoryReport memory(n_workers);                  // before forking
+//      ... memory.record(worker); ...                        // in the workers
+//      memory.print_report(cout, label);                     // once they are done
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace rjt {
+
+    struct MemoryUsage {
+        MemoryUsage() : rss(0), pss(0), shared(0) {}
+        uint64_t rss;
+        uint64_t pss;
+        uint64_t shared;
+
+        // the usage of this process (bytes), false if unknown
+        bool read();
+    };
+
+    class MemoryReport {
+
+        public :
+            explicit MemoryReport(int n_workers);
+            ~MemoryReport();
+
+            // record the calling worker's usage
+            void record(int worker);
+
+            void print_report(std::ostream& out, const std::string& label) const;
+
+        private :
+            int m_n_workers;
+            MemoryUsage m_parent;
+            MemoryUsage* m_workers;     // shared with the workers
+
+            MemoryReport(const MemoryReport&);
+            MemoryReport& operator=(const MemoryReport&);
+
+    }; // class MemoryReport
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef RJTupler_OrderedMerge_h
+#define RJTupler_OrderedMerge_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// OrderedMerge
+//
+// Merges the output files of workers that processed the entries of one
+// job in whatever order the scheduling gave them (--workers) into a single
+// file whose trees hold the entries in input order, as a serial run would
+// write them.
+//
+// Every output entry carries its global input entry number in a key
+// branch. The entries of a worker come in runs of increasing key (one or
+// more entry ranges processed in a row). The merge indexes the runs by
+// reading only the key branch, and then does a k-way merge over them.
+// The memory used grows with the number of runs, not the number of
+// entries.
+//
+//      rjt::ordered_merge(worker_files, "CENTRAL_123456.root", "globalEntry");
+//
+// The key branch is not copied to the merged trees. Histograms are summed,
+// and any other object is taken from the first input.
+//
+// 'ntuple_digest --check-ordered-merge' merges worker files with
+// interleaved, out-of-order runs and checks the result against the digest
+// of a serial run.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+
+namespace rjt {
+
+    bool ordered_merge(const std::vector<std::string>& inputs, const std::string& output,
+            const std::string& key_branch, const std::string& label = "ordered_merge");
+
+    // merge the inputs as hadd does: the trees' entries concatenated in the
+    // order of the inputs, histograms (e.g. the cutflows) summed
+    bool concatenate_outputs(const std::vector<std::string>& inputs, const std::string& output,
+            const std::string& label = "concatenate_outputs");
+
+    // rewrite the file keeping only the named objects (e.g. the trees of one
+    // group of systematics), everything else is dropped
+    bool keep_only(const std::string& file, const std::vector<std::string>& names,
+            const std::string& label = "keep_only");
+
+} // namespace rjt
+
+#endif
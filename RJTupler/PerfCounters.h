@@ -0,0 +1,125 @@
+#ifndef RJTupler_PerfCounters_h
+#define RJTupler_PerfCounters_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// PerfCounters
+//
+// Hardware performance counters (cycles, instructions, cache misses and
+// branch misses, user space only) read with perf_event_open and charged to
+// named stages of the event loop, in the same way as the StageClock: the
+// event loop calls enter(stage) when it moves into a stage, and the counts
+// since the previous call go to the stage being left.
+//
+// The stages are named in the cutflow with the FlowBuilder CounterStage
+// annotation, FlowBuilder::build() then makes every node enter its stage.
+// Stage 0 is "input": from the start of the entry (see ClockedSuperflow)
+// to the first node, i.e. reading the entry and building the objects.
+// Nodes entering the stage that is already current cost a comparison,
+// stage changes a read() of the counter group.
+//
+// Opening the counters fails when the kernel does not allow it (see
+// /proc/sys/kernel/perf_event_paranoid) or in environments without a PMU;
+// open() then prints why and the profile stays empty.
+//
+// The heap allocations made by the event loop (see AllocationCounter.h)
+// can be charged to the same stages, with or without the hardware
+// counters. The first entries (the warmup, while caches fill and buffers
+// grow to their working size) can be left out of the counts.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+namespace rjt {
+
+    class PerfCounters {
+
+        public :
+            enum Counter { Cycles = 0, Instructions, CacheMisses, BranchMisses,
+                           Allocations, AllocatedBytes, NCounters };
+
+            struct CountedStage {
+                CountedStage();
+                std::string name;
+                uint64_t entered;
+                uint64_t counts[NCounters];
+            };
+
+            // counts start after the first warmup_entries entries
+            explicit PerfCounters(uint64_t warmup_entries = 0);
+            ~PerfCounters();
+
+            // open and start the counters for the calling thread, returns
+            // false if none of them can be opened
+            bool open();
+            bool is_open() const { return m_leader >= 0; }
+
+            // also charge the calling thread's heap allocations to the stages
+            void count_allocations();
+
+            // register a stage (or find the one with this name), returns its
+            // index for enter()
+            size_t add_stage(const std::string& name);
+
+            // charge the counts since the last call to the current stage and
+            // move to the given one
+            void enter(size_t stage)
+            {
+                if(stage == m_current) return;
+                switch_to(stage);
+            }
+
+            // start of an entry (stage 0, "input")
+            void begin_entry()
+            {
+                if(++m_entries == m_warmup + 1 && m_warmup > 0) discard();
+                enter(0);
+            }
+
+            // charge the counts so far and stop charging until the next enter()
+            void pause();
+
+            const std::vector<CountedStage>& stages() const { return m_stages; }
+
+            void print_report(std::ostream& out, const std::string& label) const;
+
+            static const char* counter_name(Counter counter);
+
+        private :
+            std::vector<CountedStage> m_stages;
+            size_t m_current;
+            uint64_t m_entries;
+            uint64_t m_warmup;
+            bool m_allocations;
+
+            int m_leader;
+            std::vector<int> m_fds;
+            // position of each counter in the group read, -1 if not opened
+            int m_slot[NCounters];
+            uint64_t m_last[NCounters];
+
+            // fraction of the time the group was actually counting
+            double m_running_fraction;
+
+            void switch_to(size_t stage);
+            bool read_counts(uint64_t counts[NCounters]);
+
+            // drop everything counted so far (end of the warmup)
+            void discard();
+
+            void print_hardware(std::ostream& out, const std::string& label) const;
+            void print_allocations(std::ostream& out, const std::string& label) const;
+
+            PerfCounters(const PerfCounters&);
+            PerfCounters& operator=(const PerfCounters&);
+
+    }; // class PerfCounters
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef RJTupler_ProgressReporter_h
+#define RJTupler_ProgressReporter_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// ProgressReporter
+//
+// Periodic progress reports during the event loop: events processed,
+// instantaneous and average rate, ETA, fraction of events passing the
+// cuts, resident memory and bytes written to the output files.
+//
+// The event loop only bumps two counters (event_read, event_selected);
+// formatting and printing happen on a background thread that wakes up
+// every interval. Everything that is not safe to touch from another
+// thread (the ROOT output byte count) is sampled by the event loop itself
+// when the reporter thread asks for it.
+//
+// Each report can also be appended, as one JSON object per line, to a
+// metrics file for batch monitoring to tail.
+//
+// Superflow runs the cuts once per systematic for every event, so events
+// are counted on a change of (run, event number) rather than per call.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+
+namespace rjt {
+
+    class ProgressReporter {
+
+        public :
+            // total_events is used for the ETA, a metrics_file of "" disables
+            // the metrics output
+            ProgressReporter(const std::string& label, int64_t total_events,
+                    double interval_seconds, const std::string& metrics_file = "");
+            ~ProgressReporter();
+
+            // start the reporter thread
+            void start();
+
+            // stop the reporter thread and print the final report
+            void stop();
+
+            ///////////////////////////////////////////////////////////
+            // event loop hooks
+            ///////////////////////////////////////////////////////////
+            void event_read(uint32_t run, uint64_t event)
+            {
+                if(run == m_last_read_run && event == m_last_read_event) return;
+                m_last_read_run = run;
+                m_last_read_event = event;
+                m_n_read.store(m_n_read.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if(m_sample_request.load(std::memory_order_relaxed)) sample_output();
+            }
+            void event_selected(uint32_t run, uint64_t event)
+            {
+                if(run == m_last_selected_run && event == m_last_selected_event) return;
+                m_last_selected_run = run;
+                m_last_selected_event = event;
+                m_n_selected.store(m_n_selected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            // resident set size of this process in bytes, 0 if unknown
+            static uint64_t resident_bytes();
+
+        private :
+            std::string m_label;
+            int64_t m_total;
+            double m_interval;
+            std::ofstream m_metrics;
+
+            // written by the event loop only
+            uint32_t m_last_read_run;
+            uint64_t m_last_read_event;
+            uint32_t m_last_selected_run;
+            uint64_t m_last_selected_event;
+
+            std::atomic<uint64_t> m_n_read;
+            std::atomic<uint64_t> m_n_selected;
+            std::atomic<uint64_t> m_output_bytes;
+            std::atomic<bool> m_sample_request;
+
+            // reporter thread
+            std::thread m_thread;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            bool m_running;
+            std::chrono::steady_clock::time_point m_start;
+            std::chrono::steady_clock::time_point m_last_time;
+            uint64_t m_last_n_read;
+
+            void run();
+            void report(bool final_report);
+
+            // called from the event loop
+            void sample_output();
+
+    }; // class ProgressReporter
+
+} // namespace rjt
+
+#endif
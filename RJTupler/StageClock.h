@@ -0,0 +1,121 @@
+#ifndef RJTupler_StageClock_h
+#define RJTupler_StageClock_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// StageClock
+//
+// Splits the event-loop time into the broad stages of an event:
+//
+//      read   : raw reads of the input baskets          (from TTreePerfStats)
+//      unzip  : decompression of the input baskets      (from TTreePerfStats)
+//      build  : rest of GetEntry, object building and selection in Superlink
+//      cuts   : the CutName functions
+//      vars   : the variables and producers
+//      fill   : filling (and compressing) the output trees
+//
+// The event loop calls enter(stage) when it moves into a new stage; the
+// time since the previous call is charged to the stage being left. The
+// clock is driven by ClockedSuperflow (start and end of each entry, file
+// changes) and by nodes at the stage boundaries in the cutflow.
+//
+// When several systematics are run, Superflow rebuilds the objects for
+// each of them after the previous one is done, and that time is charged to
+// fill.
+//
+// Totals are kept per input file and for the whole job. Time spent outside
+// of the entries (opening files, the TChain loop itself) shows up as
+// "other" in the job report.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+// RJTupler
+#include "RJTupler/StageTimer.h" // read_cycles
+
+class TTree;
+class TTreePerfStats;
+
+namespace rjt {
+
+    class StageClock {
+
+        public :
+            enum Stage { Build = 0, Cuts, Vars, Fill, NStages };
+
+            struct FileTotals {
+                FileTotals();
+                std::string name;
+                uint64_t entries;
+                uint64_t ticks[NStages];
+                double disk_seconds;
+                double unzip_seconds;
+                int64_t bytes_read;
+            };
+
+            StageClock();
+            ~StageClock();
+
+            // start the job clock again (e.g. right before the event loop)
+            void restart();
+
+            // start I/O accounting for the given input tree (chain)
+            void attach(TTree* tree);
+
+            // input file changed
+            void begin_file(const std::string& name);
+
+            // start of an entry, everything up to the first enter() is
+            // reading and object building
+            void begin_entry()
+            {
+                m_last = read_cycles();
+                m_current = Build;
+            }
+
+            // charge the time since the last call to the current stage and
+            // move to the given one
+            void enter(Stage stage)
+            {
+                uint64_t now = read_cycles();
+                m_file->ticks[m_current] += now - m_last;
+                m_last = now;
+                m_current = stage;
+            }
+
+            // end of an entry, also collects the I/O time spent in it
+            void end_entry();
+
+            void print_report(std::ostream& out, const std::string& label) const;
+
+            static const char* stage_name(Stage stage);
+
+        private :
+            std::vector<FileTotals> m_files;
+            FileTotals* m_file;
+            Stage m_current;
+            uint64_t m_last;
+
+            TTreePerfStats* m_perf;
+            double m_last_disk;
+            double m_last_unzip;
+            int64_t m_last_bytes;
+
+            uint64_t m_start_ticks;
+            std::chrono::steady_clock::time_point m_start_time;
+
+            double ns_per_tick() const;
+            void print_totals(std::ostream& out, const std::string& label, const FileTotals& totals,
+                    double ns, double wall_seconds) const;
+
+    }; // class StageClock
+
+} // namespace rjt
+
+#endif
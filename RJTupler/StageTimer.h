@@ -0,0 +1,92 @@
+#ifndef RJTupler_StageTimer_h
+#define RJTupler_StageTimer_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// StageTimer
+//
+// Accumulates the time spent in each stage (cut, variable or producer) of
+// the event loop. Stages are timed with the CPU time-stamp counter, which
+// costs a few tens of cycles per read, and the counts are converted to
+// nanoseconds at the end of the job by comparing the TSC to the steady
+// clock over the lifetime of the timer.
+//
+// The timer is only used when instrumentation is requested: FlowBuilder
+// then wraps each stage's function with a pair of counter reads, otherwise
+// the functions are handed to Superflow untouched.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace rjt {
+
+    // raw cycle counter, falls back to the steady clock in ns elsewhere
+    inline uint64_t read_cycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct TimedStage {
+        TimedStage() : calls(0), ticks(0) {}
+        std::string name;
+        std::string kind;   // "cut", "var" or "producer"
+        uint64_t calls;
+        uint64_t ticks;
+    };
+
+    class StageTimer {
+
+        public :
+            StageTimer();
+
+            // register a stage, returns its index for add()
+            size_t add_stage(const std::string& name, const std::string& kind);
+
+            void add(size_t stage, uint64_t ticks)
+            {
+                TimedStage& s = m_stages[stage];
+                s.calls++;
+                s.ticks += ticks;
+            }
+
+            // conversion measured from the lifetime of the timer
+            double ns_per_tick() const;
+            double wall_seconds() const;
+
+            const std::vector<TimedStage>& stages() const { return m_stages; }
+
+            // ranked table of the stages, by total time
+            void print_report(std::ostream& out, const std::string& label, size_t n_rows = 0) const;
+
+            // same information as JSON, returns false if the file can't be written
+            bool write_json(const std::string& filename, const std::string& label) const;
+
+        private :
+            std::vector<TimedStage> m_stages;
+            uint64_t m_start_ticks;
+            std::chrono::steady_clock::time_point m_start_time;
+
+            // stage indices ordered by decreasing total time
+            std::vector<size_t> ranking() const;
+            uint64_t total_ticks() const;
+
+    }; // class StageTimer
+
+} // namespace rjt
+
+#endif
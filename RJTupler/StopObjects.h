@@ -0,0 +1,70 @@
+#ifndef RJTupler_StopObjects_h
+#define RJTupler_StopObjects_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// StopObjects
+//
+// The per-event copies of the Superlink leptons and jets used by the stop
+// 2L ntupler, together with the blocks of lepton and jet variables built
+// from them. Keeping the blocks here (rather than inline in the ntupler's
+// main) lets the microbenchmarks in bench/ record and evaluate exactly the
+// nodes the ntupler runs.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// ROOT
+#include "TLorentzVector.h"
+
+// SusyNtuple
+#include "SusyNtuple/SusyDefs.h"
+
+// RJTupler
+#include "RJTupler/FlowBuilder.h"
+#include "RJTupler/EventArena.h"
+
+namespace rjt {
+
+    class StopObjects {
+
+        public :
+            StopObjects();
+
+            // filled by the producers recorded in the blocks below
+            LeptonVector leptons;
+            ElectronVector electrons;
+            MuonVector muons;
+            JetVector jets;
+            JetVector bjets;
+            JetVector sjets;
+
+            // scratch objects of the current event, released by end_event()
+            EventArena arena;
+
+            // the system of the two leading leptons (rebuilt from their pt,
+            // eta, phi and m) and of the two leading b-jets, built in the
+            // arena the first time a variable asks for them in an event
+            const TLorentzVector& dilepton();
+            const TLorentzVector& dibjet();
+
+            // release the scratch objects, called once the event's
+            // variables have all been evaluated
+            void end_event();
+
+            // record the lepton producers and variables (outputs: leptons,
+            // electrons, muons)
+            void add_lepton_variables(FlowBuilder& flow);
+
+            // record the jet producers and variables (outputs: jets, bjets,
+            // sjets), the lepton-jet variables read the leptons
+            void add_jet_variables(FlowBuilder& flow);
+
+        private :
+            TLorentzVector* m_dilepton;
+            TLorentzVector* m_dibjet;
+
+    }; // class StopObjects
+
+} // namespace rjt
+
+#endif
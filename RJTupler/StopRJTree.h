@@ -0,0 +1,106 @@
+#ifndef RJTupler_StopRJTree_h
+#define RJTupler_StopRJTree_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// StopRJTree
+//
+// The RestFrames decay tree used by the stop 2L ntupler (two visible
+// leptons and two invisible systems, one per hemisphere) and the variables
+// computed from it. The ntupler calls analyze() once per event from its
+// "restframes" producer and stores the public members; the microbenchmarks
+// in bench/ drive it directly.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// ROOT
+#include "TVector3.h"
+#include "TLorentzVector.h"
+
+// RestFrames
+#include "RestFrames/RestFrames.hh"
+
+namespace rjt {
+
+    class StopRJTree {
+
+        public :
+            StopRJTree();
+
+            // connect the frames and jigsaws, returns false (after printing
+            // the reason) if RestFrames refuses the tree
+            bool initialize();
+
+            // analyze one event with the given missing momentum and the two
+            // leading leptons, filling the variables below
+            void analyze(const TVector3& met, const TLorentzVector& l0, const TLorentzVector& l1);
+
+            double H_11_SS;
+            double H_21_SS;
+            double H_12_SS;
+            double H_22_SS;
+            double H_11_S1;
+            double H_11_SS_T;
+            double H_21_SS_T;
+            double H_22_SS_T;
+            double H_11_S1_T;
+            double shat;
+            double pTT_T;
+            double pTT_Z;
+            double RPT;
+            double RPT_H_11_SS;
+            double RPT_H_21_SS;
+            double RPT_H_22_SS;
+            double RPZ_H_11_SS;
+            double RPZ_H_21_SS;
+            double RPZ_H_22_SS;
+            double RPT_H_11_SS_T;
+            double RPT_H_21_SS_T;
+            double RPT_H_22_SS_T;
+            double RPZ;
+            double RPZ_H_11_SS_T;
+            double RPZ_H_21_SS_T;
+            double RPZ_H_22_SS_T;
+            double gamInvRp1;
+            double MDR;
+            double costheta_SS;
+            double dphi_v_SS;
+            double DPB_vSS;
+            double cosB_1;
+            double cosB_2;
+            double cosB_3;
+            double cosB_4;
+            double dphi_v1_i1_ss;
+            double dphi_s1_s2_ss;
+            double dphiS_I_ss;
+            double dphiS_I_s1;
+
+        private :
+            StopRJTree(const StopRJTree&);
+            StopRJTree& operator=(const StopRJTree&);
+
+            // frames
+            RestFrames::LabRecoFrame lab;
+            RestFrames::DecayRecoFrame ss;
+            RestFrames::DecayRecoFrame s1;
+            RestFrames::DecayRecoFrame s2;
+            RestFrames::VisibleRecoFrame v1;
+            RestFrames::VisibleRecoFrame v2;
+            RestFrames::InvisibleRecoFrame i1;
+            RestFrames::InvisibleRecoFrame i2;
+
+            // groups
+            RestFrames::InvisibleGroup inv;
+            RestFrames::CombinatoricGroup vis;
+
+            // jigsaws
+            RestFrames::SetMassInvJigsaw MinMassJigsaw;
+            RestFrames::SetRapidityInvJigsaw RapidityJigsaw;
+            RestFrames::ContraBoostInvJigsaw ContraBoostJigsaw;
+            RestFrames::MinMassesCombJigsaw HemiJigsaw;
+
+    }; // class StopRJTree
+
+} // namespace rjt
+
+#endif
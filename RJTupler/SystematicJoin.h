@@ -0,0 +1,55 @@
+#ifndef RJTupler_SystematicJoin_h
+#define RJTupler_SystematicJoin_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// SystematicJoin
+//
+// Reader-side helper for shape systematic trees written with differential
+// storage (--syst-diff). Those trees only hold the variables that depend on
+// systematically varied objects plus the event key (runNumber, eventNumber);
+// everything else is read from the matching entry of the nominal tree.
+//
+// join_nominal indexes the nominal tree on the event key and attaches it as
+// a friend of the systematic tree, e.g.
+//
+//      rjt::join_nominal(syst_tree, nominal_tree, "nom");
+//      syst_tree->Draw("mt2", "nom.trig_2016dil && eventweight");
+//
+// Columns present in both trees resolve to the systematic values unless
+// they are prefixed with the alias.
+//
+// A shape variation can move events into the selection that are not in
+// the nominal tree. Those entries have no nominal match, and every column
+// read through the alias would hold stale values from another event.
+// join_nominal therefore checks every systematic entry and attaches an
+// in-memory friend "<alias>_match" with the flag "<alias>Matched", false
+// for the unmatched entries, which selections through the alias have to
+// require:
+//
+//      syst_tree->Draw("mt2", "nomMatched && nom.trig_2016dil");
+//
+// The number of unmatched entries is printed, and returned in n_unmatched
+// if given.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+
+// ROOT
+#include "Rtypes.h"
+
+class TTree;
+
+namespace rjt {
+
+    bool join_nominal(TTree* syst_tree, TTree* nominal_tree,
+            const std::string& alias = "nom",
+            const std::string& major_key = "runNumber",
+            const std::string& minor_key = "eventNumber",
+            Long64_t* n_unmatched = nullptr);
+
+} // namespace rjt
+
+#endif
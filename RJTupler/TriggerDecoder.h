@@ -0,0 +1,71 @@
+#ifndef RJTupler_TriggerDecoder_h
+#define RJTupler_TriggerDecoder_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// TriggerDecoder
+//
+// Decodes a fixed list of trigger chains from the event trigger bits. The
+// trigger tool looks each chain up by name (building a std::string per
+// call), so decoding all of the stored chains that way costs a map lookup
+// and often a heap allocation per chain and event. Here each chain's bit is
+// resolved once, with the trigger tool itself, and every event is then a
+// bit test per chain.
+//
+//      rjt::TriggerDecoder triggers;
+//      triggers.add("HLT_mu26_ivarmedium", &p_mu26_ivarmedium);
+//      ...
+//      if(!triggers.resolved()) triggers.resolve(pass_function);
+//      triggers.decode(evt->trigBits);
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <functional>
+
+// ROOT
+#include "TBits.h"
+
+namespace rjt {
+
+    class TriggerDecoder {
+
+        public :
+            TriggerDecoder();
+
+            // decode the named chain into *flag
+            void add(const std::string& name, bool* flag);
+
+            bool resolved() const { return m_resolved; }
+
+            // find the bit of each chain with the given decision function
+            // (the trigger tool's passTrigger). Chains it never passes are
+            // reported and always decoded as failed.
+            void resolve(const std::function<bool(const TBits&, const std::string&)>& pass);
+
+            // set the flags of all chains from the event trigger bits
+            void decode(const TBits& bits) const
+            {
+                for(const Chain& chain : m_chains) {
+                    *chain.flag = (chain.bit >= 0 && bits.TestBitNumber(chain.bit));
+                }
+            }
+
+            size_t size() const { return m_chains.size(); }
+
+        private :
+            struct Chain {
+                std::string name;
+                bool* flag;
+                int bit;
+            };
+            std::vector<Chain> m_chains;
+            bool m_resolved;
+
+    }; // class TriggerDecoder
+
+} // namespace rjt
+
+#endif
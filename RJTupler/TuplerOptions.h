@@ -0,0 +1,157 @@
+#ifndef RJTupler_TuplerOptions_h
+#define RJTupler_TuplerOptions_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// TuplerOptions
+//
+// Command-line options specific to the RJTupler ntuplers. These are read,
+// and removed from argv, before the remaining arguments are handed on to
+// Superflow's SFOptions/read_options.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+
+namespace rjt {
+
+    struct TuplerOptions {
+        TuplerOptions();
+
+        // store all event-weight variants also in a single (float) array
+        // branch, next to their double branches
+        bool weight_array;
+
+        // evaluate the weight systematics in the nominal pass and store
+        // them as branches of the nominal tree, one per variation, rather
+        // than as per-systematic trees
+        bool weight_syst_array;
+
+        // draw the random number of trig_2017dilrand from one stream over
+        // the job, as before the per-event seeding, to reproduce earlier
+        // productions (serial runs only)
+        bool legacy_trigger_rng;
+
+        // register the shape (event) systematics, one output tree each
+        bool shape_syst;
+
+        // number of forked workers the shape systematics are split across
+        int syst_workers;
+
+        // number of forked workers the entries are split across (in
+        // cluster ranges, with work stealing)
+        int workers;
+
+        // cpus the forked workers are pinned to, in order (see CpuPlacement)
+        std::string cpu_list;
+        std::vector<int> cpus;
+
+        // process only shard shard_index (of num_shards, split at cluster
+        // boundaries), or only the entries [first_entry, last_entry)
+        int num_shards;
+        int shard_index;
+        long long first_entry;
+        long long last_entry;
+
+        // merge the worker outputs into one file holding the entries in
+        // input order (as written by a serial run)
+        bool ordered_merge;
+
+        // give each worker one disjoint contiguous block of the entries
+        // (no work stealing), and merge the worker outputs (and cutflows)
+        // into one file in worker order
+        bool static_split;
+        bool merge_outputs;
+
+        // take work units (entry ranges of one file) from a work queue in
+        // this directory, shared with other ntupler processes, with the
+        // entries per unit and the seconds without a heartbeat after which
+        // a claimed unit is re-issued
+        std::string queue_dir;
+        long long queue_unit;
+        double queue_timeout;
+
+        // write the output in segments of about checkpoint_entries entries,
+        // recording the completed ones in a sidecar file (default: derived
+        // from the output suffix), and with resume skip the segments an
+        // earlier, interrupted run completed
+        long long checkpoint_entries;
+        std::string checkpoint_file;
+        bool resume;
+
+        // process every sample of the list (one input per line, as given
+        // to -i) in a child forked after the one-time initialization,
+        // sample_jobs of them at a time
+        std::string sample_list;
+        int sample_jobs;
+
+        // once initialized, serve jobs on this Unix-domain socket (see
+        // JobServer) instead of processing the input
+        std::string serve_socket;
+
+        // store only the variables depending on varied objects (plus the
+        // event key) in the shape systematic trees
+        bool syst_diff;
+
+        // HFTname patterns (regular expressions, full match) selecting the
+        // variables to compute and store, empty means all of them
+        std::vector<std::string> var_patterns;
+
+        // time the event-loop stages and report at the end of the job,
+        // optionally also writing the report as JSON
+        bool timing;
+        std::string timing_json;
+
+        // seconds between progress reports (0: none), and the file the
+        // reports are appended to as JSON lines
+        double progress_interval;
+        std::string progress_file;
+
+        // split the event-loop time into I/O, object building, cuts,
+        // variables and output filling
+        bool stage_clock;
+
+        // count hardware events (cycles, instructions, cache and branch
+        // misses) per stage of the event loop
+        bool perf_counters;
+
+        // count heap allocations per stage of the event loop
+        bool alloc_audit;
+
+        // entries processed before the counters start counting
+        int counter_warmup;
+
+        // read ahead (and unzip) the input and compress the output on
+        // helper threads, with the size of the read-ahead cache in MB
+        bool io_pipeline;
+        int io_threads;
+        int read_ahead_mb;
+    };
+
+    // only part of the input is processed (--num-shards or --first-entry/--last-entry)
+    bool is_sharded(const TuplerOptions& options);
+
+    // the output file tag of the part processed, e.g. "shard3of10"
+    std::string shard_tag(const TuplerOptions& options);
+
+    // parse and strip the RJTupler options from (argc, argv), returns
+    // false if an option is malformed; -h prints the usage under ana_name
+    bool read_tupler_options(int& argc, char* argv[], TuplerOptions& options, const std::string& ana_name);
+
+    // expand a --vars argument into patterns: a comma separated list whose
+    // items are regular expressions or '@<file>' profiles (one pattern per
+    // line, '#' starts a comment), returns false if a profile can't be read.
+    // Commas inside braces (quantifiers like {2,4}) don't separate items.
+    bool read_var_patterns(const std::string& spec, std::vector<std::string>& patterns);
+
+    // read a --sample-list file: one input per line, '#' starts a comment,
+    // returns false if it can't be read or holds no samples
+    bool read_sample_list(const std::string& filename, std::vector<std::string>& samples);
+
+    void print_tupler_usage(const std::string& ana_name);
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef RJTupler_WeightEngine_h
+#define RJTupler_WeightEngine_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// WeightEngine
+//
+// Computes every requested event-weight variant from a single read of the
+// per-event weight factors. Variants are declared once, up front, as a name
+// and a set of factors to multiply into the base weight; at event time the
+// factors are filled once and all variants are evaluated together.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace rjt {
+
+    // the per-event weight factors, read once per event
+    struct WeightFactors {
+        WeightFactors() :
+            product(1.0), product_multi(1.0), pileup(1.0), lepton(1.0), btag(1.0), jvt(1.0) {}
+        double product;       // Superweight::product()
+        double product_multi; // Superweight::product_multi()
+        double pileup;        // Event::wPileup
+        double lepton;        // Superweight::lepSf (already part of product())
+        double btag;          // Superweight::btagSf
+        double jvt;           // Superweight::jvtSf
+    };
+
+    // factors that a weight variant can be built from
+    namespace wf {
+        enum : unsigned {
+            Nominal = 0,
+            Multi   = 1u << 0, // base weight is product_multi() instead of product()
+            Pileup  = 1u << 1, // x wPileup
+            Btag    = 1u << 2, // x btagSf
+            Jvt     = 1u << 3  // x jvtSf
+        };
+    } // namespace wf
+
+    struct WeightSpec {
+        WeightSpec(const std::string& name_, unsigned factors_) :
+            name(name_), factors(factors_) {}
+        std::string name;
+        unsigned factors;
+    };
+
+    class WeightEngine {
+
+        public :
+            WeightEngine();
+
+            // declare a weight variant, returns its index in values()
+            size_t add(const std::string& name, unsigned factors);
+
+            // evaluate all declared variants for the current event
+            void compute(const WeightFactors& factors);
+
+            size_t size() const { return m_specs.size(); }
+            const std::vector<WeightSpec>& specs() const { return m_specs; }
+
+            // index of a declared variant, -1 if it is not known
+            int index(const std::string& name) const;
+
+            double value(size_t idx) const { return m_values[idx]; }
+            const std::vector<double>& values() const { return m_values; }
+
+            // the factors of the current event
+            const WeightFactors& factors() const { return m_factors; }
+
+        private :
+            std::vector<WeightSpec> m_specs;
+            WeightFactors m_factors;
+            std::vector<double> m_values;
+
+    }; // class WeightEngine
+
+} // namespace rjt
+
+#endif
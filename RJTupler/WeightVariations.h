@@ -0,0 +1,69 @@
+#ifndef RJTupler_WeightVariations_h
+#define RJTupler_WeightVariations_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// WeightVariations
+//
+// Evaluates a list of up/down weight systematics in the same event pass as
+// the nominal and stores them as consecutive entries of a single array:
+//
+//      [ var0_UP, var0_DN, var1_UP, var1_DN, ... ]
+//
+// Each variation is given as a pair of functions returning the ratio of the
+// varied to the nominal scale factor for the current event, together with
+// the base weight that the ratio multiplies: the array holds that base
+// weight times the ratio. The base has to be a weight that contains the
+// nominal scale factor being varied (e.g. a b-tagging variation goes on a
+// weight that includes btagSf).
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace sflow {
+    class Superlink;
+}
+
+namespace rjt {
+
+    class WeightVariations {
+
+        public :
+            typedef std::function<double(sflow::Superlink*)> RatioFunction;
+
+            WeightVariations();
+
+            // declare a systematic with its up and down ratio to nominal,
+            // applied to base_weights[base] in compute()
+            void add(const std::string& name, size_t base, RatioFunction up, RatioFunction down);
+
+            // evaluate all variations for the current event
+            void compute(sflow::Superlink* sl, const std::vector<double>& base_weights);
+
+            size_t size() const { return m_names.size(); }
+
+            // index of the base weight of systematic i
+            size_t base(size_t i) const { return m_base[i]; }
+
+            // names of the array entries, <name>_UP and <name>_DN
+            std::vector<std::string> entry_names() const;
+
+            const std::vector<double>& values() const { return m_values; }
+
+        private :
+            std::vector<std::string> m_names;
+            std::vector<size_t> m_base;
+            std::vector<RatioFunction> m_up;
+            std::vector<RatioFunction> m_down;
+            std::vector<double> m_values;
+
+    }; // class WeightVariations
+
+} // namespace rjt
+
+#endif
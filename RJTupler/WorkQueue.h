@@ -0,0 +1,121 @@
+#ifndef RJTupler_WorkQueue_h
+#define RJTupler_WorkQueue_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// WorkQueue
+//
+// A queue of work units (a file and an entry range of it) kept in a
+// directory on a filesystem shared by the processes working on it. It
+// needs no service other than the filesystem:
+//
+//      <dir>/todo/<unit>                 waiting to be processed
+//      <dir>/claimed/<unit>@<host>@<pid> being processed
+//      <dir>/done/<unit>                 finished
+//      <dir>/failed/<unit>               given up after repeated failures
+//
+// Every state change is a rename(), which is atomic, so two processes
+// can never claim or complete the same unit. The first process to find
+// no queue builds it in a private directory and renames it into place.
+// The others use whichever queue won.
+//
+// A claim is kept alive by heartbeats, which touch the claim file. Once
+// nothing is left to claim, the claims of processes that are known to
+// be dead (same host, pid gone) or that have stopped heartbeating are
+// put back into todo. If the original owner finishes anyway, its
+// complete() fails and it discards its output.
+//
+//      rjt::WorkQueue queue(dir, 900);
+//      if(!queue.exists()) queue.create(rjt::make_work_units(chain, -1, 100000));
+//      rjt::WorkUnit unit;
+//      while(queue.claim(unit)) { ... queue.heartbeat(unit); ... queue.complete(unit); }
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+// ROOT
+#include "Rtypes.h"
+
+// RJTupler
+#include "RJTupler/EventLoop.h"
+
+class TChain;
+
+namespace rjt {
+
+    struct WorkUnit {
+        WorkUnit() : offset(0), first(0), last(0), attempts(0) {}
+        std::string id;
+        std::string file;
+        Long64_t offset;    // chain entry of the file's first entry
+        Long64_t first;     // entries [first, last) of the file's tree
+        Long64_t last;
+        int attempts;       // failed attempts so far
+        std::string claim;  // claim file, while claimed
+    };
+
+    // units of at most about unit_entries entries (whole clusters, never
+    // spanning two files) covering the first n_entries of the chain
+    std::vector<WorkUnit> make_work_units(TChain* chain, Long64_t n_entries, Long64_t unit_entries);
+
+    // the clusters of the unit as entry ranges of the chain over the whole
+    // input the queue was made from. A unit is processed in that chain, not
+    // in a chain over its file alone, so that the sum of weights is that
+    // of the sample. Empty (with an error printed) if the chain does not
+    // hold the unit's file at the unit's offset.
+    std::vector<EntryRange> unit_ranges(TChain* chain, const WorkUnit& unit, const std::string& label = "unit_ranges");
+
+    class WorkQueue {
+
+        public :
+            WorkQueue(const std::string& dir, double timeout_seconds, const std::string& label = "WorkQueue");
+
+            bool exists() const;
+
+            // create the queue holding the units, unless another process
+            // has already created it
+            bool create(const std::vector<WorkUnit>& units);
+
+            // claim the next unit. When none is left it re-issues the units
+            // of dead or stalled workers, and while other units are still
+            // claimed it waits for them. Returns false once the queue is
+            // drained.
+            bool claim(WorkUnit& unit);
+
+            // keep the claim alive (called at least once per timeout)
+            void heartbeat(const WorkUnit& unit) const;
+
+            // mark the unit done, false if the claim was lost (the unit was
+            // re-issued, its output must be discarded)
+            bool complete(const WorkUnit& unit);
+
+            // give the unit back after a failure, it is parked in failed/
+            // after max_attempts failures
+            void release(WorkUnit& unit, int max_attempts = 3);
+
+            // number of units in each state
+            void print_status(std::ostream& out) const;
+
+        private :
+            std::string m_dir;
+            double m_timeout;
+            std::string m_label;
+            std::string m_host;
+            std::string m_owner;    // "<host>@<pid>"
+
+            std::string path(const std::string& state, const std::string& name = "") const;
+            std::vector<std::string> list(const std::string& state) const;
+            bool take(const std::string& name, WorkUnit& unit);
+            // put the claims of dead or stalled workers back, returns the
+            // number re-issued and sets n_live to the number left
+            int reissue_stale(int& n_live);
+
+    }; // class WorkQueue
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef RJTupler_WorkStealingQueue_h
+#define RJTupler_WorkStealingQueue_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// WorkStealingQueue
+//
+// Hands entry ranges out to forked workers. The ranges are dealt out up
+// front as one contiguous run per worker (about the same number of
+// entries each) held in shared memory. A worker takes ranges from the
+// front of its own run, and once that is empty steals single ranges from
+// the back of the run with the most ranges left. A worker only runs dry
+// when every range has been taken, so the job's tail is about one range
+// (cluster) long however uneven the input files are. Without stealing
+// every worker processes exactly its own run, one disjoint contiguous
+// block of the input.
+//
+// Each run is a (head, tail) pair packed into one atomic word, so taking
+// from the front and stealing from the back are single compare-and-swaps
+// and need no locks shared between the processes.
+//
+//      rjt::WorkStealingQueue queue(rjt::cluster_ranges(chain, n), n_workers);  // before forking
+//      ...
+//      rjt::EntryRange range;
+//      while(queue.next(worker, range)) { ... }                              // in the workers
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// RJTupler
+#include "RJTupler/EventLoop.h"
+
+namespace rjt {
+
+    class WorkStealingQueue {
+
+        public :
+            WorkStealingQueue(const std::vector<EntryRange>& ranges, int n_workers, bool stealing = true);
+            ~WorkStealingQueue();
+
+            // false if the shared memory could not be set up
+            bool valid() const { return m_shared != nullptr; }
+
+            // next range for the worker (its own, or stolen), false once
+            // every range has been taken
+            bool next(int worker, EntryRange& range);
+
+            int n_workers() const { return m_n_workers; }
+            size_t n_ranges() const { return m_n_ranges; }
+
+            // ranges and entries each worker processed, and how many of
+            // the ranges it stole
+            void print_report(std::ostream& out, const std::string& label) const;
+
+        private :
+            // one per worker, on its own cache line
+            struct alignas(64) Slot {
+                std::atomic<uint64_t> run;   // tail << 32 | head
+                std::atomic<uint64_t> n_ranges;
+                std::atomic<uint64_t> n_stolen;
+                std::atomic<uint64_t> n_entries;
+            };
+
+            int m_n_workers;
+            bool m_stealing;
+            size_t m_n_ranges;
+            size_t m_bytes;
+            void* m_shared;
+            Slot* m_slots;
+            EntryRange* m_ranges;
+
+            bool take_front(int worker, EntryRange& range);
+            bool steal_back(int victim, EntryRange& range);
+            void count(int worker, const EntryRange& range, bool stolen);
+
+            WorkStealingQueue(const WorkStealingQueue&);
+            WorkStealingQueue& operator=(const WorkStealingQueue&);
+
+    }; // class WorkStealingQueue
+
+} // namespace rjt
+
+#endif
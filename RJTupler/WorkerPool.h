@@ -0,0 +1,38 @@
+#ifndef RJTupler_WorkerPool_h
+#define RJTupler_WorkerPool_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// WorkerPool
+//
+// Runs a job body in N forked worker processes and waits for all of them.
+// Everything set up before the call (tools, RestFrames trees, registered
+// variables) is shared copy-on-write with the workers, and nothing mutable
+// is ever touched by two workers at once.
+//
+// Input files must not be held open across the fork (forked processes share
+// file offsets), so workers are expected to open their own TChain.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <functional>
+#include <string>
+
+namespace rjt {
+
+    // run body(worker_index) in n_workers child processes, the body's return
+    // value is used as the worker's exit code; returns the number of workers
+    // that failed (non-zero exit or killed by a signal)
+    int run_forked(int n_workers, const std::function<int(int)>& body,
+            const std::string& label = "run_forked");
+
+    // run body(task_index) for n_tasks tasks, each in its own child process,
+    // with at most n_parallel of them running at a time; returns the number
+    // of tasks that failed
+    int run_forked_pool(int n_tasks, int n_parallel, const std::function<int(int)>& body,
+            const std::string& label = "run_forked_pool");
+
+} // namespace rjt
+
+#endif
@@ -0,0 +1,98 @@
+#include "RJTupler/AllocationCounter.h"
+
+// std
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace rjt {
+namespace alloc {
+
+static std::atomic<bool> g_counting(false);
+
+// plain data only, so that no thread_local initialization can allocate
+static thread_local uint64_t t_allocations = 0;
+static thread_local uint64_t t_bytes = 0;
+
+void set_counting(bool on)
+{
+    g_counting.store(on, std::memory_order_relaxed);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool counting()
+{
+    return g_counting.load(std::memory_order_relaxed);
+}
+//////////////////////////////////////////////////////////////////////////////
+Counts thread_counts()
+{
+    Counts counts;
+    counts.allocations = t_allocations;
+    counts.bytes = t_bytes;
+    return counts;
+}
+//////////////////////////////////////////////////////////////////////////////
+static void* allocate(std::size_t size)
+{
+    if(g_counting.load(std::memory_order_relaxed)) {
+        t_allocations++;
+        t_bytes += size;
+    }
+    if(size == 0) size = 1;
+    while(true) {
+        void* p = std::malloc(size);
+        if(p) return p;
+        std::new_handler handler = std::get_new_handler();
+        if(!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace alloc
+} // namespace rjt
+
+//////////////////////////////////////////////////////////////////////////////
+// global replacements
+//////////////////////////////////////////////////////////////////////////////
+void* operator new(std::size_t size)
+{
+    return rjt::alloc::allocate(size);
+}
+void* operator new[](std::size_t size)
+{
+    return rjt::alloc::allocate(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return rjt::alloc::allocate(size); }
+    catch(...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return rjt::alloc::allocate(size); }
+    catch(...) { return nullptr; }
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,134 @@
+#include "RJTupler/Checkpoint.h"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+
+// posix
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace rjt {
+
+//////////////////////////////////////////////////////////////////////////////
+Checkpoint::Checkpoint(const string& filename, const string& input,
+        Long64_t n_entries, Long64_t segment_entries) :
+    m_filename(filename),
+    m_input(input),
+    m_n_entries(n_entries),
+    m_segment_entries(segment_entries)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+bool Checkpoint::exists() const
+{
+    struct stat info;
+    return stat(m_filename.c_str(), &info) == 0;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool Checkpoint::load(const string& label)
+{
+    ifstream in(m_filename.c_str());
+    if(!in.good()) {
+        cout << label << "    ERROR Unable to read checkpoint " << m_filename << endl;
+        return false;
+    }
+    string input;
+    Long64_t n_entries = -1;
+    Long64_t segment_entries = -1;
+    vector<CheckpointSegment> segments;
+    string line;
+    while(getline(in, line)) {
+        stringstream fields(line);
+        string key;
+        if(!(fields >> key)) continue;
+        if(key == "input") { fields >> ws; getline(fields, input); }
+        else if(key == "entries") fields >> n_entries;
+        else if(key == "segment_entries") fields >> segment_entries;
+        else if(key == "segment") {
+            CheckpointSegment segment;
+            fields >> segment.range.first >> segment.range.last >> ws;
+            getline(fields, segment.file);
+            segments.push_back(segment);
+        }
+    }
+    if(input != m_input || n_entries != m_n_entries || segment_entries <= 0) {
+        cout << label << "    ERROR Checkpoint " << m_filename << " is of another job (input '" << input
+                << "', " << n_entries << " entries), remove it to start over" << endl;
+        return false;
+    }
+    for(const CheckpointSegment& segment : segments) {
+        if(access(segment.file.c_str(), R_OK) != 0) {
+            cout << label << "    ERROR Output " << segment.file << " of checkpointed entries ["
+                    << segment.range.first << ", " << segment.range.last << ") is missing" << endl;
+            return false;
+        }
+    }
+    m_segment_entries = segment_entries;
+    m_segments = segments;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool Checkpoint::save() const
+{
+    string tmp = m_filename + ".tmp";
+    {
+        ofstream out(tmp.c_str());
+        out << "input " << m_input << "\n";
+        out << "entries " << m_n_entries << "\n";
+        out << "segment_entries " << m_segment_entries << "\n";
+        for(const CheckpointSegment& segment : m_segments) {
+            out << "segment " << segment.range.first << " " << segment.range.last << " " << segment.file << "\n";
+        }
+        out.flush();
+        if(out.fail()) {
+            cout << "Checkpoint::save    ERROR Unable to write " << tmp << endl;
+            return false;
+        }
+    }
+    if(rename(tmp.c_str(), m_filename.c_str()) != 0) {
+        cout << "Checkpoint::save    ERROR Unable to move " << tmp << " to " << m_filename << endl;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+void Checkpoint::remove() const
+{
+    std::remove(m_filename.c_str());
+}
+//////////////////////////////////////////////////////////////////////////////
+Long64_t Checkpoint::last_entry() const
+{
+    return (m_segments.empty() ? 0 : m_segments.back().range.last);
+}
+//////////////////////////////////////////////////////////////////////////////
+void Checkpoint::add_segment(const EntryRange& range, const string& file)
+{
+    CheckpointSegment segment;
+    segment.range = range;
+    segment.file = file;
+    m_segments.push_back(segment);
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<vector<EntryRange> > checkpoint_segments(const vector<EntryRange>& ranges, Long64_t segment_entries)
+{
+    Long64_t total = 0;
+    for(const EntryRange& range : ranges) total += range.size();
+    int n_segments = static_cast<int>(std::max<Long64_t>(1, (total + segment_entries - 1) / std::max<Long64_t>(segment_entries, 1)));
+
+    vector<vector<EntryRange> > segments;
+    vector<size_t> firsts = split_ranges(ranges, n_segments);
+    for(size_t is = 0; is + 1 < firsts.size(); is++) {
+        if(firsts[is] == firsts[is + 1]) continue;
+        segments.push_back(vector<EntryRange>(ranges.begin() + firsts[is], ranges.begin() + firsts[is + 1]));
+    }
+    return segments;
+}
+
+} // namespace rjt
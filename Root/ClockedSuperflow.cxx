@@ -0,0 +1,42 @@
+#include "RJTupler/ClockedSuperflow.h"
+
+// ROOT
+#include "TTree.h"
+#include "TFile.h"
+
+namespace rjt {
+
+ClockedSuperflow::ClockedSuperflow(StageClock* clock, PerfCounters* counters) :
+    sflow::Superflow(),
+    m_clock(clock),
+    m_counters(counters),
+    m_input(nullptr)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+void ClockedSuperflow::Init(TTree* tree)
+{
+    sflow::Superflow::Init(tree);
+    m_input = tree;
+    if(m_clock) m_clock->attach(tree);
+}
+//////////////////////////////////////////////////////////////////////////////
+Bool_t ClockedSuperflow::Notify()
+{
+    if(m_clock) {
+        TFile* file = (m_input ? m_input->GetCurrentFile() : nullptr);
+        m_clock->begin_file(file ? file->GetName() : "unknown");
+    }
+    return sflow::Superflow::Notify();
+}
+//////////////////////////////////////////////////////////////////////////////
+Bool_t ClockedSuperflow::Process(Long64_t entry)
+{
+    if(m_counters) m_counters->begin_entry();
+    if(m_clock) m_clock->begin_entry();
+    Bool_t status = sflow::Superflow::Process(entry);
+    if(m_clock) m_clock->end_entry();
+    return status;
+}
+
+} // namespace rjt
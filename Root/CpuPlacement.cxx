@@ -0,0 +1,130 @@
+#include "RJTupler/CpuPlacement.h"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+// posix
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// linux
+#include <linux/mempolicy.h>
+
+using namespace std;
+
+namespace rjt {
+
+//////////////////////////////////////////////////////////////////////////////
+bool parse_cpu_list(const string& spec, vector<int>& cpus)
+{
+    stringstream items(spec);
+    string item;
+    while(getline(items, item, ',')) {
+        if(item.empty()) continue;
+        char* end = nullptr;
+        long first = strtol(item.c_str(), &end, 10);
+        long last = first;
+        if(end == item.c_str()) return false;
+        if(*end == '-') {
+            const char* second = end + 1;
+            last = strtol(second, &end, 10);
+            if(end == second) return false;
+        }
+        if(*end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) return false;
+        for(long cpu = first; cpu <= last; cpu++) cpus.push_back(static_cast<int>(cpu));
+    }
+    return !cpus.empty();
+}
+//////////////////////////////////////////////////////////////////////////////
+int cpu_node(int cpu)
+{
+    // /sys/devices/system/node/node<n>/cpulist
+    for(int node = 0; node < 1024; node++) {
+        stringstream name;
+        name << "/sys/devices/system/node/node" << node << "/cpulist";
+        ifstream in(name.str().c_str());
+        if(!in.good()) {
+            if(node == 0) return -1;
+            continue;
+        }
+        string spec;
+        getline(in, spec);
+        vector<int> cpus;
+        if(!parse_cpu_list(spec, cpus)) continue;
+        for(int c : cpus) if(c == cpu) return node;
+    }
+    return -1;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<CpuPlacement> plan_placement(const vector<int>& cpus, int n_workers)
+{
+    vector<CpuPlacement> placement;
+    if(cpus.empty()) return placement;
+    map<int, int> nodes;
+    for(int iw = 0; iw < n_workers; iw++) {
+        CpuPlacement p;
+        p.cpu = cpus[iw % cpus.size()];
+        if(!nodes.count(p.cpu)) nodes[p.cpu] = cpu_node(p.cpu);
+        p.node = nodes[p.cpu];
+        placement.push_back(p);
+    }
+    return placement;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool apply_placement(const CpuPlacement& placement, const string& label)
+{
+    if(placement.cpu < 0) return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(placement.cpu, &set);
+    if(sched_setaffinity(0, sizeof(set), &set) != 0) {
+        cout << label << "    WARNING Unable to pin process " << getpid() << " to cpu " << placement.cpu
+                << ": " << strerror(errno) << endl;
+        return false;
+    }
+    if(placement.node < 0) return true;
+
+    // one bit per node, with room for the node's bit
+    const size_t bits = 8 * sizeof(unsigned long);
+    vector<unsigned long> mask(placement.node / bits + 1, 0);
+    mask[placement.node / bits] |= 1ul << (placement.node % bits);
+    if(syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.data(), mask.size() * bits + 1) != 0) {
+        cout << label << "    WARNING Unable to prefer memory on node " << placement.node
+                << ": " << strerror(errno) << endl;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+void print_placement(ostream& out, const string& label, const vector<CpuPlacement>& placement)
+{
+    if(placement.empty()) return;
+    set<int> cpus;
+    set<int> nodes;
+    for(const CpuPlacement& p : placement) {
+        cpus.insert(p.cpu);
+        nodes.insert(p.node);
+    }
+    out << label << "    Worker placement (" << placement.size() << " workers on " << cpus.size() << " cpus";
+    if(nodes.count(-1)) out << ", no NUMA information";
+    else { out << ", " << nodes.size() << " NUMA nodes"; }
+    out << "):";
+    for(size_t iw = 0; iw < placement.size(); iw++) {
+        out << " " << iw << "->cpu" << placement[iw].cpu;
+        if(placement[iw].node >= 0) out << "/node" << placement[iw].node;
+    }
+    out << endl;
+    if(cpus.size() < placement.size()) {
+        out << label << "    WARNING More workers than cpus in --cpu-list, some cpus run several workers" << endl;
+    }
+}
+
+} // namespace rjt
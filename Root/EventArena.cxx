@@ -0,0 +1,68 @@
+#include "RJTupler/EventArena.h"
+
+// std
+#include <cstdlib>
+
+using namespace std;
+
+namespace rjt {
+
+EventArena::EventArena(size_t block_size) :
+    m_block_size(block_size),
+    m_current(0),
+    m_offset(0),
+    m_used(0)
+{
+    m_cleanups.reserve(64);
+}
+//////////////////////////////////////////////////////////////////////////////
+EventArena::~EventArena()
+{
+    reset();
+    for(const Block& block : m_blocks) ::operator delete(block.data);
+}
+//////////////////////////////////////////////////////////////////////////////
+void EventArena::reset()
+{
+    for(size_t ic = m_cleanups.size(); ic > 0; ic--) {
+        m_cleanups[ic-1].destroy(m_cleanups[ic-1].object);
+    }
+    m_cleanups.clear();
+    m_current = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+//////////////////////////////////////////////////////////////////////////////
+size_t EventArena::capacity() const
+{
+    size_t total = 0;
+    for(const Block& block : m_blocks) total += block.size;
+    return total;
+}
+//////////////////////////////////////////////////////////////////////////////
+void* EventArena::allocate(size_t size, size_t align)
+{
+    if(size == 0) size = 1;
+    // carve from the current block, moving on to the next (kept from an
+    // earlier event, or new) when it is too small
+    while(m_current < m_blocks.size()) {
+        Block& block = m_blocks[m_current];
+        size_t start = (m_offset + align - 1) & ~(align - 1);
+        if(start + size <= block.size) {
+            m_offset = start + size;
+            m_used += size;
+            return block.data + start;
+        }
+        m_current++;
+        m_offset = 0;
+    }
+    Block block;
+    block.size = (size + align > m_block_size ? size + align : m_block_size);
+    block.data = static_cast<char*>(::operator new(block.size));
+    m_blocks.push_back(block);
+    m_current = m_blocks.size() - 1;
+    m_offset = 0;
+    return allocate(size, align);
+}
+
+} // namespace rjt
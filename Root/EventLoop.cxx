@@ -0,0 +1,121 @@
+#include "RJTupler/EventLoop.h"
+
+// std
+#include <algorithm>
+
+// ROOT
+#include "TChain.h"
+#include "TTree.h"
+#include "TSelector.h"
+
+using namespace std;
+
+namespace rjt {
+
+vector<EntryRange> cluster_ranges(TChain* chain, Long64_t n_entries)
+{
+    vector<EntryRange> ranges;
+    Long64_t total = chain->GetEntries();
+    if(n_entries < 0 || n_entries > total) n_entries = total;
+
+    Long64_t entry = 0;
+    while(entry < n_entries) {
+        Long64_t local = chain->LoadTree(entry);
+        if(local < 0) break;
+        TTree* tree = chain->GetTree();
+        Long64_t offset = entry - local;
+        Long64_t tree_entries = tree->GetEntries();
+
+        TTree::TClusterIterator clusters = tree->GetClusterIterator(local);
+        Long64_t start = clusters();
+        while(start < tree_entries && offset + start < n_entries) {
+            Long64_t end = clusters.GetNextEntry();
+            if(end > tree_entries) end = tree_entries;
+            ranges.push_back(EntryRange(offset + start, std::min(offset + end, n_entries)));
+            start = clusters();
+        }
+        // empty trees are skipped, LoadTree moves on to the next file
+        entry = offset + std::max<Long64_t>(tree_entries, 1);
+    }
+    return ranges;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<size_t> split_ranges(const vector<EntryRange>& ranges, int n_parts)
+{
+    if(n_parts < 1) n_parts = 1;
+    Long64_t total = 0;
+    for(const EntryRange& range : ranges) total += range.size();
+
+    vector<size_t> firsts;
+    size_t next = 0;
+    Long64_t dealt = 0;
+    for(int ip = 0; ip < n_parts; ip++) {
+        firsts.push_back(next);
+        Long64_t target = total * (ip + 1) / n_parts;
+        while(next < ranges.size() && (dealt < target || ip == n_parts - 1)) {
+            dealt += ranges[next].size();
+            next++;
+        }
+    }
+    firsts.push_back(ranges.size());
+    return firsts;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<EntryRange> shard_ranges(const vector<EntryRange>& ranges, int shard_index, int n_shards)
+{
+    vector<size_t> firsts = split_ranges(ranges, n_shards);
+    if(shard_index < 0 || shard_index + 1 >= (int)firsts.size()) return vector<EntryRange>();
+    return vector<EntryRange>(ranges.begin() + firsts[shard_index], ranges.begin() + firsts[shard_index + 1]);
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<EntryRange> clip_ranges(const vector<EntryRange>& ranges, Long64_t first, Long64_t last)
+{
+    vector<EntryRange> clipped;
+    for(const EntryRange& range : ranges) {
+        EntryRange clip(std::max(range.first, first), (last < 0 ? range.last : std::min(range.last, last)));
+        if(clip.size() > 0) clipped.push_back(clip);
+    }
+    return clipped;
+}
+//////////////////////////////////////////////////////////////////////////////
+Long64_t process_ranges(TChain* chain, TSelector* selector, const string& option,
+        const function<bool(EntryRange&)>& next_range, Long64_t* current_entry)
+{
+    // as TChain::Process, the tree of the first entry is loaded before the
+    // selector is initialised
+    EntryRange range;
+    bool have_range = next_range(range);
+    if(have_range) chain->LoadTree(range.first);
+
+    selector->SetOption(option.c_str());
+    selector->Begin(chain);
+    selector->SlaveBegin(chain);
+    selector->Init(chain);
+    selector->Notify();
+    chain->SetNotify(selector);
+
+    Long64_t n_processed = 0;
+    bool aborted = false;
+    while(have_range && !aborted) {
+        for(Long64_t entry = range.first; entry < range.last; entry++) {
+            // notifies the selector whenever the chain opens another file
+            Long64_t local = chain->LoadTree(entry);
+            if(local < 0) break;
+            if(current_entry) *current_entry = entry;
+            selector->Process(local);
+            n_processed++;
+            if(selector->GetAbort() == TSelector::kAbortProcess) {
+                aborted = true;
+                break;
+            }
+        }
+        if(!aborted) have_range = next_range(range);
+    }
+
+    chain->SetNotify(nullptr);
+    selector->SlaveTerminate();
+    selector->Terminate();
+    return n_processed;
+}
+
+} // namespace rjt
@@ -0,0 +1,586 @@
+#include "RJTupler/FlowBuilder.h"
+
+// std
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <regex>
+#include <set>
+#include <map>
+#include <queue>
+#include <functional>
+
+using namespace std;
+using namespace sflow;
+
+namespace rjt {
+
+// wrap a stage function with time-stamp counter reads
+template <class R, class... Args>
+static function<R(Args...)> timed(const function<R(Args...)>& f, StageTimer* timer, size_t stage)
+{
+    return [f, timer, stage](Args... args) -> R {
+        uint64_t start = read_cycles();
+        R value = f(args...);
+        timer->add(stage, read_cycles() - start);
+        return value;
+    };
+}
+template <class... Args>
+static function<void(Args...)> timed(const function<void(Args...)>& f, StageTimer* timer, size_t stage)
+{
+    return [f, timer, stage](Args... args) {
+        uint64_t start = read_cycles();
+        f(args...);
+        timer->add(stage, read_cycles() - start);
+    };
+}
+
+// make a stage function enter its hardware-counter stage first
+template <class R, class... Args>
+static function<R(Args...)> counted(const function<R(Args...)>& f, PerfCounters* counters, size_t stage)
+{
+    return [f, counters, stage](Args... args) -> R {
+        counters->enter(stage);
+        return f(args...);
+    };
+}
+
+template <class R, class... Args>
+static function<R(Args...)> instrumented(const function<R(Args...)>& f, const NodeHooks& hooks)
+{
+    function<R(Args...)> g = f;
+    if(hooks.timer) g = timed(g, hooks.timer, hooks.stage);
+    if(hooks.counters) g = counted(g, hooks.counters, hooks.counter_stage);
+    return g;
+}
+
+vector<string> split_names(const string& names)
+{
+    vector<string> out;
+    string list = names;
+    replace(list.begin(), list.end(), ',', ' ');
+    stringstream ss(list);
+    string name;
+    while(ss >> name) {
+        if(find(out.begin(), out.end(), name) == out.end()) out.push_back(name);
+    }
+    return out;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool FlowNode::reads(const string& input) const
+{
+    return find(inputs.begin(), inputs.end(), input) != inputs.end();
+}
+bool FlowNode::provides(const string& output) const
+{
+    return find(outputs.begin(), outputs.end(), output) != outputs.end();
+}
+string FlowNode::label() const
+{
+    stringstream out;
+    if(kind == Cut) out << "cut \"" << name << "\"";
+    else if(kind == Var) out << "variable \"" << hft << "\"";
+    else if(kind == Systematic) out << "systematic item";
+    else {
+        out << "producer";
+        if(!outputs.empty()) {
+            out << " of";
+            for(const string& output : outputs) out << " " << output;
+        }
+    }
+    return out.str();
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder::FlowBuilder() :
+    m_has_pending(false),
+    m_has_selection(false),
+    m_differential(false)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowNode FlowBuilder::make_node(FlowNode::Kind kind)
+{
+    FlowNode node;
+    node.kind = kind;
+    node.inputs = m_scope;
+    for(const string& input : m_next_inputs) {
+        if(!node.reads(input)) node.inputs.push_back(input);
+    }
+    m_next_inputs.clear();
+    node.outputs = m_next_outputs;
+    m_next_outputs.clear();
+    if(m_counter_stage != "") node.counter_stage = m_counter_stage;
+    return node;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(CutName cut_name)
+{
+    m_pending_cut = cut_name.name;
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(function<bool(Superlink*)> cut)
+{
+    FlowNode node = make_node(FlowNode::Cut);
+    node.name = m_pending_cut;
+    string name = m_pending_cut;
+    node.emit = [cut, name](Superflow& sf) {
+        sf << CutName(name) << cut;
+    };
+    node.emit_instrumented = [cut, name](Superflow& sf, const NodeHooks& hooks) {
+        sf << CutName(name) << instrumented(cut, hooks);
+    };
+    node.evaluate = [cut](Superlink* sl) { cut(sl); };
+    m_nodes.push_back(node);
+    m_pending_cut = "";
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(NewVar new_var)
+{
+    if(m_has_pending) {
+        cout << "FlowBuilder    ERROR NewVar(\"" << new_var.name << "\") given before SaveVar() of \""
+                << m_pending.name << "\"" << endl;
+        exit(1);
+    }
+    m_pending = make_node(FlowNode::Var);
+    m_pending.name = new_var.name;
+    m_has_pending = true;
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(HFTname hft_name)
+{
+    m_pending.hft = hft_name.name;
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+template <class R, class Tag>
+FlowBuilder& FlowBuilder::add_var(const function<R(Superlink*, Tag*)>& var)
+{
+    if(!m_has_pending) {
+        cout << "FlowBuilder    ERROR Variable function given without a preceding NewVar" << endl;
+        exit(1);
+    }
+    m_pending.emit = [var](Superflow& sf) { sf << var; };
+    m_pending.emit_instrumented = [var](Superflow& sf, const NodeHooks& hooks) {
+        sf << instrumented(var, hooks);
+    };
+    m_pending.evaluate = [var](Superlink* sl) { var(sl, nullptr); };
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(function<double(Superlink*, var_float*)> var)
+{
+    return add_var(var);
+}
+FlowBuilder& FlowBuilder::operator<<(function<double(Superlink*, var_double*)> var)
+{
+    return add_var(var);
+}
+FlowBuilder& FlowBuilder::operator<<(function<int(Superlink*, var_int*)> var)
+{
+    return add_var(var);
+}
+FlowBuilder& FlowBuilder::operator<<(function<bool(Superlink*, var_bool*)> var)
+{
+    return add_var(var);
+}
+FlowBuilder& FlowBuilder::operator<<(function<vector<double>(Superlink*, var_float_array*)> var)
+{
+    return add_var(var);
+}
+FlowBuilder& FlowBuilder::operator<<(function<vector<int>(Superlink*, var_int_array*)> var)
+{
+    return add_var(var);
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(function<void(Superlink*, var_void*)> var)
+{
+    FlowNode node = make_node(FlowNode::Void);
+    node.emit = [var](Superflow& sf) { sf << var; };
+    node.emit_instrumented = [var](Superflow& sf, const NodeHooks& hooks) {
+        sf << instrumented(var, hooks);
+    };
+    node.evaluate = [var](Superlink* sl) { var(sl, nullptr); };
+    m_nodes.push_back(node);
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(SaveVar /*save_var*/)
+{
+    if(!m_has_pending || !m_pending.emit) {
+        cout << "FlowBuilder    ERROR SaveVar() given without a complete NewVar/HFTname/function" << endl;
+        exit(1);
+    }
+    m_pending.save = true;
+    m_nodes.push_back(m_pending);
+    m_pending = FlowNode();
+    m_has_pending = false;
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+void FlowBuilder::add_systematic_item(const function<void(Superflow&)>& emit)
+{
+    FlowNode node;
+    node.kind = FlowNode::Systematic;
+    node.emit = emit;
+    m_nodes.push_back(node);
+}
+FlowBuilder& FlowBuilder::operator<<(NewSystematic new_sys)
+{
+    add_systematic_item([new_sys](Superflow& sf) { sf << new_sys; });
+    return *this;
+}
+FlowBuilder& FlowBuilder::operator<<(EventSystematic event_sys)
+{
+    add_systematic_item([event_sys](Superflow& sf) { sf << event_sys; });
+    return *this;
+}
+FlowBuilder& FlowBuilder::operator<<(WeightSystematic weight_sys)
+{
+    add_systematic_item([weight_sys](Superflow& sf) { sf << weight_sys; });
+    return *this;
+}
+FlowBuilder& FlowBuilder::operator<<(TreeName tree_name)
+{
+    add_systematic_item([tree_name](Superflow& sf) { sf << tree_name; });
+    return *this;
+}
+FlowBuilder& FlowBuilder::operator<<(SaveSystematic save_sys)
+{
+    add_systematic_item([save_sys](Superflow& sf) { sf << save_sys; });
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(InputScope scope)
+{
+    m_scope = split_names(scope.names);
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(Inputs inputs)
+{
+    vector<string> names = split_names(inputs.names);
+    m_next_inputs.insert(m_next_inputs.end(), names.begin(), names.end());
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(Outputs outputs)
+{
+    vector<string> names = split_names(outputs.names);
+    m_next_outputs.insert(m_next_outputs.end(), names.begin(), names.end());
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+FlowBuilder& FlowBuilder::operator<<(CounterStage stage)
+{
+    m_counter_stage = stage.name;
+    return *this;
+}
+//////////////////////////////////////////////////////////////////////////////
+void FlowBuilder::set_external_inputs(const string& names)
+{
+    m_external = split_names(names);
+}
+//////////////////////////////////////////////////////////////////////////////
+void FlowBuilder::save_only_dependent_on(const vector<string>& inputs, const vector<string>& key_columns)
+{
+    m_differential = true;
+    m_varied_inputs = inputs;
+    m_key_columns = key_columns;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool FlowBuilder::select_variables(const vector<string>& patterns)
+{
+    vector<regex> expressions;
+    for(const string& pattern : patterns) {
+        try {
+            expressions.push_back(regex(pattern));
+        }
+        catch(const regex_error& e) {
+            cout << "FlowBuilder    ERROR Invalid variable pattern '" << pattern << "': " << e.what() << endl;
+            return false;
+        }
+    }
+
+    m_has_selection = true;
+    m_selected.clear();
+    vector<bool> used(patterns.size(), false);
+    for(const FlowNode& node : m_nodes) {
+        if(node.kind != FlowNode::Var || !node.save) continue;
+        for(size_t ip = 0; ip < expressions.size(); ip++) {
+            if(!regex_match(node.hft, expressions[ip])) continue;
+            used[ip] = true;
+            if(find(m_selected.begin(), m_selected.end(), node.hft) == m_selected.end())
+                m_selected.push_back(node.hft);
+        }
+    }
+    for(size_t ip = 0; ip < patterns.size(); ip++) {
+        if(!used[ip]) cout << "FlowBuilder    WARNING Variable pattern '" << patterns[ip] << "' matches no variable" << endl;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool FlowBuilder::is_selected(const FlowNode& node) const
+{
+    if(!m_has_selection) return true;
+    return find(m_selected.begin(), m_selected.end(), node.hft) != m_selected.end();
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<bool> FlowBuilder::saved_nodes() const
+{
+    vector<bool> saved(m_nodes.size(), false);
+
+    // with differential storage a node depends on a varied input if it reads
+    // one directly, or reads something provided by a node that does
+    set<string> varied(m_varied_inputs.begin(), m_varied_inputs.end());
+    bool changed = m_differential;
+    while(changed) {
+        changed = false;
+        for(const FlowNode& node : m_nodes) {
+            bool reads_varied = false;
+            for(const string& input : node.inputs) {
+                if(varied.count(input) && !node.provides(input)) { reads_varied = true; break; }
+            }
+            if(!reads_varied) continue;
+            for(const string& output : node.outputs) {
+                if(varied.insert(output).second) changed = true;
+            }
+        }
+    }
+
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        const FlowNode& node = m_nodes[in];
+        if(node.kind != FlowNode::Var || !node.save) continue;
+        bool is_key = find(m_key_columns.begin(), m_key_columns.end(), node.hft) != m_key_columns.end();
+        if(m_differential && is_key) { saved[in] = true; continue; }
+        if(!is_selected(node)) continue;
+        if(!m_differential) { saved[in] = true; continue; }
+        for(const string& input : node.inputs) {
+            if(varied.count(input)) { saved[in] = true; break; }
+        }
+    }
+    return saved;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<bool> FlowBuilder::active_nodes() const
+{
+    // cuts, systematic items, stored variables and producers that don't say
+    // what they provide always run, anything else only if it provides an
+    // input that is read by a node that runs
+    vector<bool> active = saved_nodes();
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        const FlowNode& node = m_nodes[in];
+        if(node.kind == FlowNode::Cut || node.kind == FlowNode::Systematic) active[in] = true;
+        else if(node.kind == FlowNode::Void && node.outputs.empty()) active[in] = true;
+    }
+
+    set<string> needed;
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t in = 0; in < m_nodes.size(); in++) {
+            if(!active[in]) continue;
+            for(const string& input : m_nodes[in].inputs) {
+                if(!m_nodes[in].provides(input)) needed.insert(input);
+            }
+        }
+        for(size_t in = 0; in < m_nodes.size(); in++) {
+            if(active[in]) continue;
+            for(const string& output : m_nodes[in].outputs) {
+                if(needed.count(output)) { active[in] = true; changed = true; break; }
+            }
+        }
+    }
+    return active;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<string> FlowBuilder::saved_columns() const
+{
+    vector<string> out;
+    vector<bool> saved = saved_nodes();
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        if(saved[in]) out.push_back(m_nodes[in].hft);
+    }
+    return out;
+}
+//////////////////////////////////////////////////////////////////////////////
+size_t FlowBuilder::n_active() const
+{
+    vector<bool> active = active_nodes();
+    size_t n = 0;
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        if(active[in] && (m_nodes[in].kind == FlowNode::Var || m_nodes[in].kind == FlowNode::Void)) n++;
+    }
+    return n;
+}
+size_t FlowBuilder::n_evaluable() const
+{
+    size_t n = 0;
+    for(const FlowNode& node : m_nodes) {
+        if(node.kind == FlowNode::Var || node.kind == FlowNode::Void) n++;
+    }
+    return n;
+}
+//////////////////////////////////////////////////////////////////////////////
+int FlowBuilder::provider(const string& name) const
+{
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        if(m_nodes[in].provides(name)) return static_cast<int>(in);
+    }
+    return -1;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool FlowBuilder::validate() const
+{
+    bool ok = true;
+    if(m_has_pending) {
+        cout << "FlowBuilder    ERROR Variable \"" << m_pending.name << "\" is missing its SaveVar()" << endl;
+        ok = false;
+    }
+
+    map<string, size_t> hft_names;
+    map<string, size_t> providers;
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        const FlowNode& node = m_nodes[in];
+        if(node.kind == FlowNode::Var && node.save) {
+            if(hft_names.count(node.hft)) {
+                cout << "FlowBuilder    ERROR Duplicate HFTname \"" << node.hft << "\" (\""
+                        << m_nodes[hft_names[node.hft]].name << "\" and \"" << node.name << "\")" << endl;
+                ok = false;
+            }
+            else {
+                hft_names[node.hft] = in;
+            }
+        }
+        for(const string& output : node.outputs) {
+            if(providers.count(output)) {
+                cout << "FlowBuilder    ERROR \"" << output << "\" is provided by both the "
+                        << m_nodes[providers[output]].label() << " and the " << node.label() << endl;
+                ok = false;
+            }
+            else {
+                providers[output] = in;
+            }
+        }
+    }
+
+    bool check_inputs = !m_external.empty();
+    for(const FlowNode& node : m_nodes) {
+        if(!check_inputs) break;
+        for(const string& input : node.inputs) {
+            if(providers.count(input)) continue;
+            if(find(m_external.begin(), m_external.end(), input) != m_external.end()) continue;
+            cout << "FlowBuilder    ERROR The " << node.label() << " reads \"" << input
+                    << "\", which is neither provided by a node nor an external input" << endl;
+            ok = false;
+        }
+    }
+    if(!ok) return false;
+
+    // a cycle shows up as nodes that can never be scheduled
+    vector<bool> active = active_nodes();
+    size_t n_active = count(active.begin(), active.end(), true);
+    return schedule().size() == n_active;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<size_t> FlowBuilder::schedule() const
+{
+    vector<bool> active = active_nodes();
+
+    // edges from the provider of each input to the nodes reading it
+    vector<vector<size_t> > dependents(m_nodes.size());
+    vector<int> n_missing(m_nodes.size(), 0);
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        if(!active[in]) continue;
+        set<int> sources;
+        for(const string& input : m_nodes[in].inputs) {
+            int source = provider(input);
+            if(source < 0 || source == static_cast<int>(in)) continue;
+            sources.insert(source);
+        }
+        for(int source : sources) {
+            dependents[source].push_back(in);
+            n_missing[in]++;
+        }
+    }
+
+    // Kahn's algorithm, always taking the earliest recorded node that is
+    // ready so that the recorded order is kept wherever possible
+    priority_queue<size_t, vector<size_t>, greater<size_t> > ready;
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        if(active[in] && n_missing[in] == 0) ready.push(in);
+    }
+    vector<size_t> order;
+    while(!ready.empty()) {
+        size_t in = ready.top();
+        ready.pop();
+        order.push_back(in);
+        for(size_t dep : dependents[in]) {
+            if(--n_missing[dep] == 0) ready.push(dep);
+        }
+    }
+
+    for(size_t in = 0; in < m_nodes.size(); in++) {
+        if(active[in] && n_missing[in] > 0) {
+            cout << "FlowBuilder    ERROR The " << m_nodes[in].label() << " is part of, or depends on, a dependency cycle" << endl;
+        }
+    }
+    return order;
+}
+//////////////////////////////////////////////////////////////////////////////
+void FlowBuilder::build(Superflow& superflow, StageTimer* timer, PerfCounters* counters) const
+{
+    if(!validate()) {
+        cout << "FlowBuilder    ERROR Invalid flow, exiting" << endl;
+        exit(1);
+    }
+    vector<bool> saved = saved_nodes();
+    for(size_t in : schedule()) {
+        const FlowNode& node = m_nodes[in];
+        if(node.kind == FlowNode::Systematic) {
+            node.emit(superflow);
+            continue;
+        }
+
+        NodeHooks hooks;
+        if(timer) {
+            string name = (node.kind == FlowNode::Cut ? node.name : node.label());
+            if(node.kind == FlowNode::Var) name = node.hft;
+            else if(node.kind == FlowNode::Void && node.outputs.empty()) {
+                stringstream unnamed;
+                unnamed << "producer [node " << in << "]";
+                name = unnamed.str();
+            }
+            const char* kind = (node.kind == FlowNode::Cut ? "cut" : (node.kind == FlowNode::Var ? "var" : "producer"));
+            hooks.timer = timer;
+            hooks.stage = timer->add_stage(name, kind);
+        }
+        if(counters) {
+            hooks.counters = counters;
+            hooks.counter_stage = counters->add_stage(node.counter_stage);
+        }
+        const bool instrument = (hooks.timer || hooks.counters);
+
+        if(node.kind == FlowNode::Var && !saved[in]) {
+            // only needed for what it provides to other nodes
+            function<void(Superlink*)> evaluate = node.evaluate;
+            if(instrument) evaluate = instrumented(evaluate, hooks);
+            superflow << function<void(Superlink*, var_void*)>(
+                [evaluate](Superlink* sl, var_void*) { evaluate(sl); });
+            continue;
+        }
+        if(node.kind == FlowNode::Var) {
+            superflow << NewVar(node.name);
+            superflow << HFTname(node.hft);
+        }
+        if(instrument) node.emit_instrumented(superflow, hooks);
+        else { node.emit(superflow); }
+        if(node.kind == FlowNode::Var) superflow << SaveVar();
+    }
+}
+
+} // namespace rjt
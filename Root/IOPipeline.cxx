@@ -0,0 +1,54 @@
+#include "RJTupler/IOPipeline.h"
+
+// std
+#include <iostream>
+
+// ROOT
+#include "RConfigure.h"
+#include "TEnv.h"
+#include "TChain.h"
+#include "TTreeCacheUnzip.h"
+#include "TROOT.h"
+
+using namespace std;
+
+namespace rjt {
+
+void enable_read_ahead()
+{
+    gEnv->SetValue("TFile.AsyncPrefetching", 1);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool start_io_pipeline(TChain* chain, int n_threads, int cache_mb, const string& label)
+{
+    if(!chain || cache_mb <= 0) {
+        cout << label << "    ERROR Invalid read-ahead cache of " << cache_mb << " MB" << endl;
+        return false;
+    }
+
+    // the unzip threads are attached when the cache is created
+    TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+#ifdef R__USE_IMT
+    if(n_threads > 0) ROOT::EnableImplicitMT(n_threads);
+#else
+    if(n_threads > 0) {
+        cout << label << "    WARNING ROOT is built without implicit multi-threading, output compression"
+                << " stays in the event loop" << endl;
+    }
+#endif
+
+    Long64_t cache_bytes = static_cast<Long64_t>(cache_mb) * 1024 * 1024;
+    if(chain->SetCacheSize(cache_bytes) < 0) {
+        cout << label << "    ERROR Unable to set a read-ahead cache of " << cache_mb << " MB" << endl;
+        return false;
+    }
+    // every branch is read, no need to learn which ones
+    chain->AddBranchToCache("*", true);
+    chain->StopCacheLearningPhase();
+
+    cout << label << "    I/O pipeline: " << cache_mb << " MB read-ahead, "
+            << n_threads << " unzip/compression threads" << endl;
+    return true;
+}
+
+} // namespace rjt
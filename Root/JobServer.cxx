@@ -0,0 +1,243 @@
+#include "RJTupler/JobServer.h"
+
+// std
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+// posix
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// RJTupler
+#include "RJTupler/WorkerPool.h"
+
+using namespace std;
+
+namespace rjt {
+
+static const string status_prefix = "ntupler-server: exit ";
+
+static volatile sig_atomic_t stop_requested = 0;
+static void request_stop(int) { stop_requested = 1; }
+
+// write all of data to the socket
+static bool write_all(int fd, const string& data)
+{
+    size_t written = 0;
+    while(written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        written += n;
+    }
+    return true;
+}
+// read one line (without the newline), false at the end of the stream
+static bool read_line(int fd, string& line)
+{
+    line.clear();
+    char c;
+    while(true) {
+        ssize_t n = ::read(fd, &c, 1);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return !line.empty();
+        if(c == '\n') return true;
+        line += c;
+    }
+}
+static bool socket_address(const string& path, struct sockaddr_un& address, const string& label)
+{
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) {
+        cout << label << "    ERROR Socket path too long: " << path << endl;
+        return false;
+    }
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+JobServer::JobServer(const string& socket_path, const string& label) :
+    m_path(socket_path),
+    m_label(label),
+    m_fd(-1)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+JobServer::~JobServer()
+{
+    if(m_fd < 0) return;
+    close(m_fd);
+    unlink(m_path.c_str());
+}
+//////////////////////////////////////////////////////////////////////////////
+bool JobServer::listen()
+{
+    struct sockaddr_un address;
+    if(!socket_address(m_path, address, m_label)) return false;
+    m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(m_fd < 0) {
+        cout << m_label << "    ERROR Unable to create a socket: " << strerror(errno) << endl;
+        return false;
+    }
+
+    // a socket file left by a server that is gone can be replaced, one
+    // that still accepts connections can't
+    struct stat info;
+    if(stat(m_path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = (connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0);
+        close(probe);
+        if(live) {
+            cout << m_label << "    ERROR A server is already listening on " << m_path << endl;
+            close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+        unlink(m_path.c_str());
+    }
+    if(bind(m_fd, (struct sockaddr*)&address, sizeof(address)) != 0 || ::listen(m_fd, 16) != 0) {
+        cout << m_label << "    ERROR Unable to listen on " << m_path << ": " << strerror(errno) << endl;
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool JobServer::read_request(int fd, JobRequest& request, string& error) const
+{
+    string line;
+    while(read_line(fd, line)) {
+        if(!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if(line.empty()) break;
+        stringstream fields(line);
+        string key, value;
+        fields >> key >> ws;
+        getline(fields, value);
+        if(key == "input") request.input = value;
+        else if(key == "events") request.n_events = atoll(value.c_str());
+        else if(key == "output") request.output_dir = value;
+        else if(key == "suffix") request.suffix = value;
+        else if(key == "shutdown") { request.shutdown = true; return true; }
+        else {
+            error = "unknown request field '" + key + "'";
+            return false;
+        }
+    }
+    if(request.input == "") {
+        error = "no input given";
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+int JobServer::serve(const function<int(const JobRequest&)>& run_job)
+{
+    if(m_fd < 0) return 0;
+
+    // no SA_RESTART: a signal interrupts accept()
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    cout << m_label << "    Listening on " << m_path << endl;
+    int n_jobs = 0;
+    int n_failed = 0;
+    while(!stop_requested) {
+        int client = accept(m_fd, nullptr, nullptr);
+        if(client < 0) {
+            if(errno == EINTR) continue;
+            cout << m_label << "    ERROR accept failed: " << strerror(errno) << endl;
+            break;
+        }
+        JobRequest request;
+        string error;
+        if(!read_request(client, request, error)) {
+            write_all(client, "ntupler-server: bad request, " + error + "\n" + status_prefix + "2\n");
+            close(client);
+            continue;
+        }
+        if(request.shutdown) {
+            write_all(client, status_prefix + "0\n");
+            close(client);
+            break;
+        }
+
+        cout << m_label << "    Job " << n_jobs << " : " << request.input << endl;
+        int failed = run_forked(1, [&](int) -> int {
+            close(m_fd);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            dup2(client, STDOUT_FILENO);
+            dup2(client, STDERR_FILENO);
+            close(client);
+            if(request.output_dir != "" && chdir(request.output_dir.c_str()) != 0) {
+                cout << m_label << "    ERROR Unable to use output directory " << request.output_dir
+                        << ": " << strerror(errno) << endl;
+                return 1;
+            }
+            return run_job(request);
+        }, m_label);
+        n_jobs++;
+        if(failed > 0) n_failed++;
+        write_all(client, status_prefix + (failed > 0 ? "1" : "0") + "\n");
+        close(client);
+        cout << m_label << "    Job " << (n_jobs - 1) << (failed > 0 ? " failed" : " done") << endl;
+    }
+    cout << m_label << "    Served " << n_jobs << " jobs (" << n_failed << " failed), shutting down" << endl;
+    return n_failed;
+}
+//////////////////////////////////////////////////////////////////////////////
+int submit_job(const string& socket_path, const JobRequest& request, ostream& out)
+{
+    struct sockaddr_un address;
+    if(!socket_address(socket_path, address, "submit_job")) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        cout << "submit_job    ERROR Unable to connect to " << socket_path << ": " << strerror(errno) << endl;
+        if(fd >= 0) close(fd);
+        return -1;
+    }
+
+    stringstream message;
+    if(request.shutdown) {
+        message << "shutdown\n";
+    }
+    else {
+        message << "input " << request.input << "\n";
+        if(request.n_events >= 0) message << "events " << request.n_events << "\n";
+        if(request.output_dir != "") message << "output " << request.output_dir << "\n";
+        if(request.suffix != "") message << "suffix " << request.suffix << "\n";
+    }
+    message << "\n";
+    if(!write_all(fd, message.str())) {
+        cout << "submit_job    ERROR Unable to send the request: " << strerror(errno) << endl;
+        close(fd);
+        return -1;
+    }
+
+    int status = -1;
+    string line;
+    while(read_line(fd, line)) {
+        if(line.compare(0, status_prefix.size(), status_prefix) == 0) {
+            status = atoi(line.c_str() + status_prefix.size());
+            continue;
+        }
+        out << line << "\n";
+        out.flush();
+    }
+    close(fd);
+    return status;
+}
+
+} // namespace rjt
@@ -0,0 +1,98 @@
+#include "RJTupler/MemoryReport.h"
+
+// std
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <new>
+
+// posix
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace rjt {
+
+//////////////////////////////////////////////////////////////////////////////
+bool MemoryUsage::read()
+{
+    ifstream smaps("/proc/self/smaps_rollup");
+    if(smaps.good()) {
+        // "<Field>: <n> kB" lines
+        *this = MemoryUsage();
+        string line;
+        while(getline(smaps, line)) {
+            stringstream fields(line);
+            string field;
+            uint64_t kb = 0;
+            if(!(fields >> field >> kb)) continue;
+            if(field == "Rss:") rss = kb * 1024;
+            else if(field == "Pss:") pss = kb * 1024;
+            else if(field == "Shared_Clean:" || field == "Shared_Dirty:") shared += kb * 1024;
+        }
+        return rss > 0;
+    }
+
+    // older kernels: resident and shared (file-backed) pages only
+    ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0, file_pages = 0;
+    if(!(statm >> size >> resident >> file_pages)) return false;
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    rss = resident * page;
+    shared = file_pages * page;
+    pss = rss;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+MemoryReport::MemoryReport(int n_workers) :
+    m_n_workers(n_workers > 0 ? n_workers : 1),
+    m_workers(nullptr)
+{
+    m_parent.read();
+    void* memory = mmap(nullptr, m_n_workers * sizeof(MemoryUsage), PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED) return;
+    m_workers = static_cast<MemoryUsage*>(memory);
+    for(int iw = 0; iw < m_n_workers; iw++) new (m_workers + iw) MemoryUsage();
+}
+//////////////////////////////////////////////////////////////////////////////
+MemoryReport::~MemoryReport()
+{
+    if(m_workers) munmap(m_workers, m_n_workers * sizeof(MemoryUsage));
+}
+//////////////////////////////////////////////////////////////////////////////
+void MemoryReport::record(int worker)
+{
+    if(!m_workers || worker < 0 || worker >= m_n_workers) return;
+    MemoryUsage usage;
+    if(usage.read()) m_workers[worker] = usage;
+}
+//////////////////////////////////////////////////////////////////////////////
+void MemoryReport::print_report(ostream& out, const string& label) const
+{
+    if(!m_workers || m_parent.rss == 0) return;
+    const double mb = 1048576.;
+    out << label << "    Memory of the forked workers (MB):" << endl;
+    out << label << "      " << setw(8) << "process" << setw(10) << "RSS" << setw(10) << "PSS"
+            << setw(10) << "shared" << endl;
+    out << fixed << setprecision(1);
+    out << label << "      " << setw(8) << "parent" << setw(10) << m_parent.rss / mb << setw(10)
+            << m_parent.pss / mb << setw(10) << m_parent.shared / mb << endl;
+    uint64_t total = m_parent.rss;
+    uint64_t total_rss = m_parent.rss;
+    for(int iw = 0; iw < m_n_workers; iw++) {
+        const MemoryUsage& usage = m_workers[iw];
+        out << label << "      " << setw(8) << iw << setw(10) << usage.rss / mb << setw(10)
+                << usage.pss / mb << setw(10) << usage.shared / mb << endl;
+        total += (usage.rss > usage.shared ? usage.rss - usage.shared : 0);
+        total_rss += usage.rss;
+    }
+    out << label << "    About " << total / mb << " MB in use by " << (m_n_workers + 1)
+            << " processes (the parent and the unshared memory of each worker), "
+            << total_rss / mb << " MB without copy-on-write sharing" << endl;
+    out << defaultfloat << setprecision(6);
+}
+
+} // namespace rjt
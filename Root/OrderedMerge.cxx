@@ -0,0 +1,240 @@
+#include "RJTupler/OrderedMerge.h"
+
+// std
+#include <iostream>
+#include <set>
+#include <queue>
+#include <functional>
+#include <cstdio>
+
+// ROOT
+#include "TFile.h"
+#include "TKey.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TH1.h"
+#include "TClass.h"
+#include "TFileMerger.h"
+
+using namespace std;
+
+namespace rjt {
+
+// entries [first, last) of one input tree, in increasing key order
+struct KeyRun {
+    size_t input;
+    Long64_t first;
+    Long64_t last;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+static bool merge_tree(const vector<TFile*>& inputs, const string& name, const string& key_branch,
+        TFile* output, const string& label)
+{
+    vector<TTree*> trees;
+    vector<TBranch*> keys;
+    vector<double> key_values(inputs.size(), 0);
+    for(size_t ii = 0; ii < inputs.size(); ii++) {
+        TTree* tree = dynamic_cast<TTree*>(inputs[ii]->Get(name.c_str()));
+        if(!tree) {
+            cout << label << "    ERROR Tree " << name << " missing from " << inputs[ii]->GetName() << endl;
+            return false;
+        }
+        TBranch* key = tree->GetBranch(key_branch.c_str());
+        if(!key) {
+            cout << label << "    ERROR Key branch '" << key_branch << "' missing from tree " << name
+                    << " in " << inputs[ii]->GetName() << endl;
+            return false;
+        }
+        tree->SetBranchAddress(key_branch.c_str(), &key_values[ii]);
+        trees.push_back(tree);
+        keys.push_back(key);
+    }
+
+    // index the runs of increasing key, reading only the key branch
+    vector<KeyRun> runs;
+    for(size_t ii = 0; ii < trees.size(); ii++) {
+        Long64_t n_entries = trees[ii]->GetEntries();
+        Long64_t first = 0;
+        double previous = 0;
+        for(Long64_t entry = 0; entry < n_entries; entry++) {
+            keys[ii]->GetEntry(entry);
+            if(entry > first && key_values[ii] <= previous) {
+                runs.push_back(KeyRun{ ii, first, entry });
+                first = entry;
+            }
+            previous = key_values[ii];
+        }
+        if(n_entries > first) runs.push_back(KeyRun{ ii, first, n_entries });
+    }
+
+    // the key is not copied, the merged tree takes the structure (and the
+    // basket and compression settings) of the first input. A disabled
+    // branch is skipped by TBranch::GetEntry unless getall is set, so the
+    // key is read below with GetEntry(entry, 1).
+    for(TTree* tree : trees) tree->SetBranchStatus(key_branch.c_str(), 0);
+    output->cd();
+    TTree* merged = trees[0]->CloneTree(0);
+    if(!merged) {
+        cout << label << "    ERROR Unable to clone tree " << name << endl;
+        return false;
+    }
+
+    // k-way merge over the runs, smallest key first
+    typedef pair<double, size_t> Cursor; // (key of the next entry, run)
+    priority_queue<Cursor, vector<Cursor>, greater<Cursor>> heap;
+    vector<Long64_t> next(runs.size());
+    for(size_t ir = 0; ir < runs.size(); ir++) {
+        next[ir] = runs[ir].first;
+        keys[runs[ir].input]->GetEntry(next[ir], 1);
+        heap.push(Cursor(key_values[runs[ir].input], ir));
+    }
+    size_t current = 0;
+    while(!heap.empty()) {
+        size_t ir = heap.top().second;
+        heap.pop();
+        size_t ii = runs[ir].input;
+        // point the merged branches at the buffers of the input being read
+        if(ii != current) {
+            trees[ii]->CopyAddresses(merged);
+            current = ii;
+        }
+        trees[ii]->GetEntry(next[ir]);
+        merged->Fill();
+        if(++next[ir] < runs[ir].last) {
+            keys[ii]->GetEntry(next[ir], 1);
+            heap.push(Cursor(key_values[ii], ir));
+        }
+    }
+
+    output->cd();
+    merged->Write("", TObject::kOverwrite);
+    cout << label << "    Merged " << merged->GetEntries() << " entries of " << name << " from "
+            << trees.size() << " files (" << runs.size() << " runs)" << endl;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool ordered_merge(const vector<string>& input_names, const string& output_name,
+        const string& key_branch, const string& label)
+{
+    if(input_names.empty()) {
+        cout << label << "    ERROR No files to merge" << endl;
+        return false;
+    }
+    vector<TFile*> inputs;
+    bool ok = true;
+    for(const string& name : input_names) {
+        TFile* file = TFile::Open(name.c_str(), "READ");
+        if(!file || file->IsZombie()) {
+            cout << label << "    ERROR Unable to open " << name << endl;
+            delete file;
+            ok = false;
+            break;
+        }
+        inputs.push_back(file);
+    }
+    TFile* output = nullptr;
+    if(ok) {
+        output = TFile::Open(output_name.c_str(), "RECREATE");
+        if(!output || output->IsZombie()) {
+            cout << label << "    ERROR Unable to create " << output_name << endl;
+            ok = false;
+        }
+    }
+
+    // the keys of the first input define what the merged file holds
+    set<string> done;
+    TIter next_key(ok ? inputs[0]->GetListOfKeys() : nullptr);
+    while(ok) {
+        TKey* key = static_cast<TKey*>(next_key());
+        if(!key) break;
+        string name = key->GetName();
+        if(!done.insert(name).second) continue; // older cycles
+        TClass* cls = TClass::GetClass(key->GetClassName());
+        if(cls && cls->InheritsFrom(TTree::Class())) {
+            ok = merge_tree(inputs, name, key_branch, output, label);
+        }
+        else if(cls && cls->InheritsFrom(TH1::Class())) {
+            TH1* sum = static_cast<TH1*>(key->ReadObj());
+            sum->SetDirectory(0);
+            for(size_t ii = 1; ii < inputs.size(); ii++) {
+                TH1* h = dynamic_cast<TH1*>(inputs[ii]->Get(name.c_str()));
+                if(h) sum->Add(h);
+            }
+            output->cd();
+            sum->Write(name.c_str(), TObject::kOverwrite);
+            delete sum;
+        }
+        else {
+            TObject* object = key->ReadObj();
+            output->cd();
+            object->Write(name.c_str(), TObject::kOverwrite);
+            delete object;
+        }
+    }
+
+    if(output) output->Close();
+    delete output;
+    for(TFile* file : inputs) {
+        file->Close();
+        delete file;
+    }
+    return ok;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool concatenate_outputs(const vector<string>& input_names, const string& output_name, const string& label)
+{
+    if(input_names.empty()) {
+        cout << label << "    ERROR No files to merge" << endl;
+        return false;
+    }
+    TFileMerger merger(false, false);
+    merger.SetPrintLevel(0);
+    if(!merger.OutputFile(output_name.c_str(), "RECREATE")) {
+        cout << label << "    ERROR Unable to create " << output_name << endl;
+        return false;
+    }
+    for(const string& name : input_names) {
+        if(!merger.AddFile(name.c_str(), false)) {
+            cout << label << "    ERROR Unable to open " << name << endl;
+            return false;
+        }
+    }
+    if(!merger.Merge()) {
+        cout << label << "    ERROR Merging into " << output_name << " failed" << endl;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool keep_only(const string& file, const vector<string>& names, const string& label)
+{
+    // copied into a new file rather than deleted in place, which would
+    // leave the space of the dropped objects in the file
+    string kept = file + ".keep";
+    TFileMerger merger(false, false);
+    merger.SetPrintLevel(0);
+    if(!merger.OutputFile(kept.c_str(), "RECREATE")) {
+        cout << label << "    ERROR Unable to create " << kept << endl;
+        return false;
+    }
+    if(!merger.AddFile(file.c_str(), false)) {
+        cout << label << "    ERROR Unable to open " << file << endl;
+        return false;
+    }
+    for(const string& name : names) merger.AddObjectNames(name.c_str());
+    if(!merger.PartialMerge(TFileMerger::kAll | TFileMerger::kRegular | TFileMerger::kOnlyListed)) {
+        cout << label << "    ERROR Copying " << file << " failed" << endl;
+        remove(kept.c_str());
+        return false;
+    }
+    if(rename(kept.c_str(), file.c_str()) != 0) {
+        cout << label << "    ERROR Unable to replace " << file << endl;
+        remove(kept.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace rjt
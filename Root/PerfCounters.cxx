@@ -0,0 +1,253 @@
+#include "RJTupler/PerfCounters.h"
+
+// std
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+
+// RJTupler
+#include "RJTupler/AllocationCounter.h"
+
+// linux
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+using namespace std;
+
+namespace rjt {
+
+static const size_t no_stage = static_cast<size_t>(-1);
+
+static int perf_event_open(perf_event_attr* attr, pid_t pid, int cpu, int group_fd, unsigned long flags)
+{
+    return static_cast<int>(syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags));
+}
+//////////////////////////////////////////////////////////////////////////////
+PerfCounters::CountedStage::CountedStage() :
+    entered(0)
+{
+    for(int ic = 0; ic < NCounters; ic++) counts[ic] = 0;
+}
+//////////////////////////////////////////////////////////////////////////////
+PerfCounters::PerfCounters(uint64_t warmup_entries) :
+    m_current(no_stage),
+    m_entries(0),
+    m_warmup(warmup_entries),
+    m_allocations(false),
+    m_leader(-1),
+    m_running_fraction(1.0)
+{
+    for(int ic = 0; ic < NCounters; ic++) {
+        m_slot[ic] = -1;
+        m_last[ic] = 0;
+    }
+    add_stage("input");
+}
+//////////////////////////////////////////////////////////////////////////////
+PerfCounters::~PerfCounters()
+{
+    for(int fd : m_fds) close(fd);
+}
+//////////////////////////////////////////////////////////////////////////////
+const char* PerfCounters::counter_name(Counter counter)
+{
+    switch(counter) {
+        case Cycles       : return "cycles";
+        case Instructions : return "instructions";
+        case CacheMisses  : return "cache-misses";
+        case BranchMisses : return "branch-misses";
+        case Allocations  : return "allocations";
+        case AllocatedBytes : return "allocated-bytes";
+        default           : return "unknown";
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+bool PerfCounters::open()
+{
+    if(is_open()) return true;
+    const uint64_t configs[Allocations] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    int n_open = 0;
+    for(int ic = 0; ic < Allocations; ic++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[ic];
+        attr.disabled = (m_leader < 0 ? 1 : 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = perf_event_open(&attr, 0, -1, m_leader, 0);
+        if(fd < 0) {
+            cout << "PerfCounters    WARNING Unable to open the " << counter_name(Counter(ic))
+                    << " counter: " << strerror(errno) << endl;
+            if(m_leader < 0) {
+                cout << "PerfCounters    WARNING Hardware counters not available"
+                        << " (check /proc/sys/kernel/perf_event_paranoid)" << endl;
+                return false;
+            }
+            continue;
+        }
+        if(m_leader < 0) m_leader = fd;
+        m_fds.push_back(fd);
+        m_slot[ic] = n_open++;
+    }
+
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    read_counts(m_last);
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::count_allocations()
+{
+    m_allocations = true;
+    alloc::set_counting(true);
+    alloc::Counts counts = alloc::thread_counts();
+    m_last[Allocations] = counts.allocations;
+    m_last[AllocatedBytes] = counts.bytes;
+}
+//////////////////////////////////////////////////////////////////////////////
+size_t PerfCounters::add_stage(const string& name)
+{
+    for(size_t is = 0; is < m_stages.size(); is++) {
+        if(m_stages[is].name == name) return is;
+    }
+    CountedStage stage;
+    stage.name = name;
+    m_stages.push_back(stage);
+    return m_stages.size() - 1;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool PerfCounters::read_counts(uint64_t counts[NCounters])
+{
+    for(int ic = 0; ic < NCounters; ic++) counts[ic] = m_last[ic];
+    if(m_allocations) {
+        alloc::Counts allocated = alloc::thread_counts();
+        counts[Allocations] = allocated.allocations;
+        counts[AllocatedBytes] = allocated.bytes;
+    }
+    if(!is_open()) return m_allocations;
+
+    // nr, time enabled, time running, then one value per counter
+    uint64_t buffer[3 + Allocations];
+    ssize_t n = read(m_leader, buffer, sizeof(buffer));
+    if(n < static_cast<ssize_t>(3 * sizeof(uint64_t))) return false;
+    if(buffer[1] > 0) m_running_fraction = static_cast<double>(buffer[2]) / buffer[1];
+    for(int ic = 0; ic < Allocations; ic++) {
+        counts[ic] = (m_slot[ic] >= 0 && m_slot[ic] < static_cast<int>(buffer[0]) ? buffer[3 + m_slot[ic]] : 0);
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::switch_to(size_t stage)
+{
+    if(is_open() || m_allocations) {
+        uint64_t now[NCounters];
+        if(read_counts(now)) {
+            if(m_current != no_stage) {
+                CountedStage& current = m_stages[m_current];
+                for(int ic = 0; ic < NCounters; ic++) current.counts[ic] += now[ic] - m_last[ic];
+            }
+            for(int ic = 0; ic < NCounters; ic++) m_last[ic] = now[ic];
+        }
+    }
+    m_current = stage;
+    if(stage != no_stage) m_stages[stage].entered++;
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::pause()
+{
+    switch_to(no_stage);
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::discard()
+{
+    switch_to(no_stage);
+    for(CountedStage& stage : m_stages) {
+        stage.entered = 0;
+        for(int ic = 0; ic < NCounters; ic++) stage.counts[ic] = 0;
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::print_report(ostream& out, const string& label) const
+{
+    if(!is_open() && !m_allocations) {
+        out << label << "    Hardware counters: not available" << endl;
+        return;
+    }
+    if(is_open()) print_hardware(out, label);
+    if(m_allocations) print_allocations(out, label);
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::print_hardware(ostream& out, const string& label) const
+{
+    uint64_t total_cycles = 0;
+    for(const CountedStage& stage : m_stages) total_cycles += stage.counts[Cycles];
+
+    out << label << "    Hardware counters (user space)";
+    if(m_running_fraction < 0.999) {
+        out << ", counting " << fixed << setprecision(1) << 100. * m_running_fraction
+                << "% of the time (multiplexed)";
+    }
+    out << endl;
+    out << label << "    " << setw(24) << left << "stage" << right << "  " << setw(12) << "entered"
+            << "  " << setw(12) << "Mcycles" << "  " << setw(12) << "Minstr" << "  " << setw(6) << "IPC"
+            << "  " << setw(10) << "cache/ki" << "  " << setw(10) << "branch/ki" << "  " << setw(7) << "share" << endl;
+    for(const CountedStage& stage : m_stages) {
+        if(stage.entered == 0) continue;
+        const double cycles = static_cast<double>(stage.counts[Cycles]);
+        const double instr = static_cast<double>(stage.counts[Instructions]);
+        out << label << "    " << setw(24) << left << stage.name << right << "  " << setw(12) << stage.entered
+                << fixed << setprecision(1)
+                << "  " << setw(12) << cycles * 1e-6
+                << "  " << setw(12) << instr * 1e-6
+                << "  " << setw(6) << setprecision(2) << (cycles > 0 ? instr / cycles : 0.)
+                << "  " << setw(10) << setprecision(2);
+        if(m_slot[CacheMisses] >= 0) out << (instr > 0 ? 1e3 * stage.counts[CacheMisses] / instr : 0.);
+        else { out << "n/a"; }
+        out << "  " << setw(10);
+        if(m_slot[BranchMisses] >= 0) out << (instr > 0 ? 1e3 * stage.counts[BranchMisses] / instr : 0.);
+        else { out << "n/a"; }
+        out << "  " << setw(6) << setprecision(2) << (total_cycles > 0 ? 100. * cycles / total_cycles : 0.) << "%" << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+//////////////////////////////////////////////////////////////////////////////
+void PerfCounters::print_allocations(ostream& out, const string& label) const
+{
+    // every counted entry starts in the input stage
+    const uint64_t n_events = m_stages[0].entered;
+    uint64_t total = 0;
+    for(const CountedStage& stage : m_stages) total += stage.counts[Allocations];
+
+    out << label << "    Heap allocations in " << n_events << " entries";
+    if(m_warmup > 0) out << " (after " << m_warmup << " warmup entries)";
+    out << ": " << total << endl;
+    out << label << "    " << setw(24) << left << "stage" << right << "  " << setw(12) << "allocations"
+            << "  " << setw(12) << "per entry" << "  " << setw(14) << "bytes/entry" << endl;
+    for(const CountedStage& stage : m_stages) {
+        if(stage.entered == 0) continue;
+        const double n = static_cast<double>(n_events > 0 ? n_events : 1);
+        out << label << "    " << setw(24) << left << stage.name << right
+                << "  " << setw(12) << stage.counts[Allocations]
+                << fixed << setprecision(2)
+                << "  " << setw(12) << stage.counts[Allocations] / n
+                << "  " << setw(14) << setprecision(1) << stage.counts[AllocatedBytes] / n << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+
+} // namespace rjt
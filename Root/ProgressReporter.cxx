@@ -0,0 +1,156 @@
+#include "RJTupler/ProgressReporter.h"
+
+// std
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+
+// posix
+#include <unistd.h>
+
+// ROOT
+#include "TFile.h"
+
+using namespace std;
+
+namespace rjt {
+
+// hh:mm:ss
+static string format_duration(double seconds)
+{
+    if(seconds < 0 || seconds > 1e8) return "--:--:--";
+    long s = static_cast<long>(seconds + 0.5);
+    stringstream out;
+    out << setfill('0') << setw(2) << s / 3600 << ":" << setw(2) << (s / 60) % 60 << ":" << setw(2) << s % 60;
+    return out.str();
+}
+//////////////////////////////////////////////////////////////////////////////
+ProgressReporter::ProgressReporter(const string& label, int64_t total_events,
+        double interval_seconds, const string& metrics_file) :
+    m_label(label),
+    m_total(total_events),
+    m_interval(interval_seconds),
+    m_last_read_run(0),
+    m_last_read_event(UINT64_MAX),
+    m_last_selected_run(0),
+    m_last_selected_event(UINT64_MAX),
+    m_n_read(0),
+    m_n_selected(0),
+    m_output_bytes(0),
+    m_sample_request(false),
+    m_running(false),
+    m_last_n_read(0)
+{
+    if(metrics_file != "") {
+        m_metrics.open(metrics_file.c_str(), ios::out | ios::app);
+        if(!m_metrics.good()) {
+            cout << m_label << "    ProgressReporter WARNING Unable to open metrics file " << metrics_file << endl;
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+ProgressReporter::~ProgressReporter()
+{
+    stop();
+}
+//////////////////////////////////////////////////////////////////////////////
+void ProgressReporter::start()
+{
+    if(m_running || m_interval <= 0) return;
+    m_start = chrono::steady_clock::now();
+    m_last_time = m_start;
+    m_running = true;
+    m_thread = thread(&ProgressReporter::run, this);
+}
+//////////////////////////////////////////////////////////////////////////////
+void ProgressReporter::stop()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if(!m_running) return;
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if(m_thread.joinable()) m_thread.join();
+
+    // the event loop is done, so this thread may read the output size itself
+    m_output_bytes.store(TFile::GetFileBytesWritten(), memory_order_relaxed);
+    report(true);
+}
+//////////////////////////////////////////////////////////////////////////////
+void ProgressReporter::run()
+{
+    unique_lock<mutex> lock(m_mutex);
+    auto interval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(m_interval));
+    while(m_running) {
+        if(m_wake.wait_for(lock, interval, [this] { return !m_running; })) break;
+        lock.unlock();
+        report(false);
+        m_sample_request.store(true, memory_order_relaxed);
+        lock.lock();
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void ProgressReporter::sample_output()
+{
+    m_output_bytes.store(TFile::GetFileBytesWritten(), memory_order_relaxed);
+    m_sample_request.store(false, memory_order_relaxed);
+}
+//////////////////////////////////////////////////////////////////////////////
+uint64_t ProgressReporter::resident_bytes()
+{
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if(!statm) return 0;
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+    if(n != 2) return 0;
+    return static_cast<uint64_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+//////////////////////////////////////////////////////////////////////////////
+void ProgressReporter::report(bool final_report)
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    uint64_t n_read = m_n_read.load(memory_order_relaxed);
+    uint64_t n_selected = m_n_selected.load(memory_order_relaxed);
+    uint64_t output_bytes = m_output_bytes.load(memory_order_relaxed);
+    uint64_t rss = resident_bytes();
+
+    double elapsed = chrono::duration<double>(now - m_start).count();
+    double dt = chrono::duration<double>(now - m_last_time).count();
+    double avg_rate = (elapsed > 0 ? n_read / elapsed : 0.);
+    double inst_rate = (dt > 0 ? (n_read - m_last_n_read) / dt : 0.);
+    double fraction = (m_total > 0 ? static_cast<double>(n_read) / m_total : 0.);
+    double eta = (avg_rate > 0 && m_total > 0 ? (m_total - static_cast<double>(n_read)) / avg_rate : -1.);
+    double selected = (n_read > 0 ? static_cast<double>(n_selected) / n_read : 0.);
+    m_last_time = now;
+    m_last_n_read = n_read;
+
+    stringstream line;
+    line << m_label << "    " << (final_report ? "Done    " : "Progress") << " : "
+            << n_read << "/" << m_total << " (" << fixed << setprecision(1) << 100. * fraction << "%)"
+            << "  inst " << inst_rate << " Hz  avg " << avg_rate << " Hz"
+            << "  elapsed " << format_duration(elapsed) << "  ETA " << (final_report ? format_duration(0) : format_duration(eta))
+            << "  selected " << setprecision(2) << 100. * selected << "%"
+            << "  RSS " << setprecision(1) << rss / 1048576. << " MB"
+            << "  output " << output_bytes / 1048576. << " MB";
+    cout << line.str() << endl;
+
+    if(m_metrics.is_open() && m_metrics.good()) {
+        m_metrics << "{\"job\": \"" << m_label << "\""
+                << ", \"time\": " << chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count()
+                << ", \"elapsed_s\": " << fixed << setprecision(3) << elapsed
+                << ", \"events\": " << n_read
+                << ", \"total\": " << m_total
+                << ", \"inst_hz\": " << inst_rate
+                << ", \"avg_hz\": " << avg_rate
+                << ", \"eta_s\": " << (final_report ? 0. : eta)
+                << ", \"selected\": " << n_selected
+                << ", \"rss_bytes\": " << rss
+                << ", \"output_bytes\": " << output_bytes
+                << ", \"final\": " << (final_report ? "true" : "false") << "}" << endl;
+    }
+}
+
+} // namespace rjt
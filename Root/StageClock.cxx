@@ -0,0 +1,164 @@
+#include "RJTupler/StageClock.h"
+
+// std
+#include <iostream>
+#include <iomanip>
+
+// ROOT
+#include "TTree.h"
+#include "TTreePerfStats.h"
+
+using namespace std;
+
+namespace rjt {
+
+StageClock::FileTotals::FileTotals() :
+    entries(0),
+    disk_seconds(0),
+    unzip_seconds(0),
+    bytes_read(0)
+{
+    for(int is = 0; is < NStages; is++) ticks[is] = 0;
+}
+//////////////////////////////////////////////////////////////////////////////
+StageClock::StageClock() :
+    m_current(Build),
+    m_last(0),
+    m_perf(nullptr),
+    m_last_disk(0),
+    m_last_unzip(0),
+    m_last_bytes(0),
+    m_start_ticks(read_cycles()),
+    m_start_time(chrono::steady_clock::now())
+{
+    // entries seen before the first file change are charged to this one
+    m_files.push_back(FileTotals());
+    m_file = &m_files.back();
+}
+//////////////////////////////////////////////////////////////////////////////
+StageClock::~StageClock()
+{
+    delete m_perf;
+}
+//////////////////////////////////////////////////////////////////////////////
+const char* StageClock::stage_name(Stage stage)
+{
+    switch(stage) {
+        case Build : return "build";
+        case Cuts  : return "cuts";
+        case Vars  : return "vars";
+        case Fill  : return "fill";
+        default    : return "unknown";
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageClock::restart()
+{
+    m_start_ticks = read_cycles();
+    m_start_time = chrono::steady_clock::now();
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageClock::attach(TTree* tree)
+{
+    if(m_perf || !tree) return;
+    m_perf = new TTreePerfStats("rjt_stage_clock_io", tree);
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageClock::begin_file(const string& name)
+{
+    if(m_file->name == name) return;
+    if(m_file->entries == 0 && m_file->name == "") {
+        m_file->name = name;
+        return;
+    }
+    m_files.push_back(FileTotals());
+    m_file = &m_files.back();
+    m_file->name = name;
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageClock::end_entry()
+{
+    enter(Build);
+    m_file->entries++;
+    if(!m_perf) return;
+
+    double disk = m_perf->GetDiskTime();
+    double unzip = m_perf->GetUnzipTime();
+    int64_t bytes = m_perf->GetBytesRead();
+    m_file->disk_seconds += disk - m_last_disk;
+    m_file->unzip_seconds += unzip - m_last_unzip;
+    m_file->bytes_read += bytes - m_last_bytes;
+    m_last_disk = disk;
+    m_last_unzip = unzip;
+    m_last_bytes = bytes;
+}
+//////////////////////////////////////////////////////////////////////////////
+double StageClock::ns_per_tick() const
+{
+    uint64_t ticks = read_cycles() - m_start_ticks;
+    if(ticks == 0) return 1.0;
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - m_start_time).count();
+    return ns / ticks;
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageClock::print_totals(ostream& out, const string& label, const FileTotals& totals,
+        double ns, double wall_seconds) const
+{
+    // the basket reads and decompression happen inside GetEntry, i.e. in
+    // the build stage
+    double seconds[NStages];
+    for(int is = 0; is < NStages; is++) seconds[is] = totals.ticks[is] * ns * 1e-9;
+    double build = seconds[Build] - totals.disk_seconds - totals.unzip_seconds;
+    if(build < 0) build = 0;
+
+    double in_entries = totals.disk_seconds + totals.unzip_seconds + build
+            + seconds[Cuts] + seconds[Vars] + seconds[Fill];
+    double total = (wall_seconds > in_entries ? wall_seconds : in_entries);
+    auto column = [&](double s) {
+        out << "  " << setw(9) << setprecision(3) << s
+                << " (" << setw(5) << setprecision(1) << (total > 0 ? 100. * s / total : 0.) << "%)";
+    };
+
+    out << label << "    " << fixed << setw(9) << totals.entries;
+    column(totals.disk_seconds);
+    column(totals.unzip_seconds);
+    column(build);
+    column(seconds[Cuts]);
+    column(seconds[Vars]);
+    column(seconds[Fill]);
+    if(wall_seconds > 0) column(wall_seconds - in_entries > 0 ? wall_seconds - in_entries : 0.);
+    else out << "  " << setw(18) << "-";
+    out << "  " << setw(8) << setprecision(1) << totals.bytes_read / 1048576. << " MB"
+            << "  " << totals.name << endl;
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageClock::print_report(ostream& out, const string& label) const
+{
+    const double ns = ns_per_tick();
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - m_start_time).count();
+
+    FileTotals job;
+    job.name = "[job]";
+    for(const FileTotals& file : m_files) {
+        job.entries += file.entries;
+        for(int is = 0; is < NStages; is++) job.ticks[is] += file.ticks[is];
+        job.disk_seconds += file.disk_seconds;
+        job.unzip_seconds += file.unzip_seconds;
+        job.bytes_read += file.bytes_read;
+    }
+
+    out << label << "    Event-loop time per stage [s], share of the total"
+            << (m_perf ? "" : " (no I/O statistics, read and unzip are included in build)") << endl;
+    out << label << "    " << setw(9) << "entries";
+    const char* headers[] = { "read", "unzip", "build", "cuts", "vars", "fill", "other" };
+    for(const char* header : headers) out << "  " << setw(18) << header;
+    out << "  " << setw(11) << "input" << "  file" << endl;
+    if(m_files.size() > 1) {
+        for(const FileTotals& file : m_files) print_totals(out, label, file, ns, 0);
+    }
+    print_totals(out, label, job, ns, wall);
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+
+} // namespace rjt
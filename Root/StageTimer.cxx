@@ -0,0 +1,130 @@
+#include "RJTupler/StageTimer.h"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+namespace rjt {
+
+// escape a string for use as a JSON string value
+static string json_escape(const string& in)
+{
+    string out;
+    for(char c : in) {
+        if(c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if(c == '\n') out += "\\n";
+        else if(static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+    }
+    return out;
+}
+//////////////////////////////////////////////////////////////////////////////
+StageTimer::StageTimer() :
+    m_start_ticks(read_cycles()),
+    m_start_time(chrono::steady_clock::now())
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+size_t StageTimer::add_stage(const string& name, const string& kind)
+{
+    TimedStage stage;
+    stage.name = name;
+    stage.kind = kind;
+    m_stages.push_back(stage);
+    return m_stages.size() - 1;
+}
+//////////////////////////////////////////////////////////////////////////////
+double StageTimer::wall_seconds() const
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - m_start_time).count();
+}
+//////////////////////////////////////////////////////////////////////////////
+double StageTimer::ns_per_tick() const
+{
+    uint64_t ticks = read_cycles() - m_start_ticks;
+    if(ticks == 0) return 1.0;
+    return wall_seconds() * 1e9 / ticks;
+}
+//////////////////////////////////////////////////////////////////////////////
+uint64_t StageTimer::total_ticks() const
+{
+    uint64_t total = 0;
+    for(const TimedStage& stage : m_stages) total += stage.ticks;
+    return total;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<size_t> StageTimer::ranking() const
+{
+    vector<size_t> order;
+    for(size_t is = 0; is < m_stages.size(); is++) {
+        if(m_stages[is].calls > 0) order.push_back(is);
+    }
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return m_stages[a].ticks > m_stages[b].ticks;
+    });
+    return order;
+}
+//////////////////////////////////////////////////////////////////////////////
+void StageTimer::print_report(ostream& out, const string& label, size_t n_rows) const
+{
+    const double ns = ns_per_tick();
+    const double total = static_cast<double>(total_ticks());
+    vector<size_t> order = ranking();
+    if(n_rows == 0 || n_rows > order.size()) n_rows = order.size();
+
+    out << label << "    Stage timing: " << fixed << setprecision(3) << total * ns * 1e-9
+            << " s in " << order.size() << " timed stages, " << wall_seconds() << " s wall" << endl;
+    out << label << "    " << setw(5) << "rank" << "  " << setw(8) << "kind" << "  " << setw(12) << "calls"
+            << "  " << setw(12) << "total [ms]" << "  " << setw(10) << "ns/call" << "  " << setw(7) << "share"
+            << "  stage" << endl;
+    for(size_t ir = 0; ir < n_rows; ir++) {
+        const TimedStage& stage = m_stages[order[ir]];
+        double stage_ns = stage.ticks * ns;
+        out << label << "    " << setw(5) << (ir + 1) << "  " << setw(8) << stage.kind << "  " << setw(12) << stage.calls
+                << "  " << setw(12) << setprecision(3) << stage_ns * 1e-6
+                << "  " << setw(10) << setprecision(1) << stage_ns / stage.calls
+                << "  " << setw(6) << setprecision(2) << (total > 0 ? 100. * stage.ticks / total : 0.) << "%"
+                << "  " << stage.name << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool StageTimer::write_json(const string& filename, const string& label) const
+{
+    ofstream out(filename.c_str());
+    if(!out.good()) {
+        cout << "StageTimer    ERROR Unable to open timing output file " << filename << endl;
+        return false;
+    }
+    const double ns = ns_per_tick();
+    const double total = static_cast<double>(total_ticks());
+    vector<size_t> order = ranking();
+
+    out << "{\n";
+    out << "  \"job\": \"" << json_escape(label) << "\",\n";
+    out << "  \"wall_s\": " << setprecision(9) << wall_seconds() << ",\n";
+    out << "  \"timed_s\": " << total * ns * 1e-9 << ",\n";
+    out << "  \"ns_per_tick\": " << ns << ",\n";
+    out << "  \"stages\": [";
+    for(size_t ir = 0; ir < order.size(); ir++) {
+        const TimedStage& stage = m_stages[order[ir]];
+        double stage_ns = stage.ticks * ns;
+        out << (ir ? ",\n" : "\n");
+        out << "    {\"rank\": " << (ir + 1)
+                << ", \"name\": \"" << json_escape(stage.name) << "\""
+                << ", \"kind\": \"" << stage.kind << "\""
+                << ", \"calls\": " << stage.calls
+                << ", \"total_ns\": " << static_cast<uint64_t>(stage_ns)
+                << ", \"ns_per_call\": " << stage_ns / stage.calls
+                << ", \"share\": " << (total > 0 ? stage.ticks / total : 0.) << "}";
+    }
+    out << "\n  ]\n}\n";
+    return out.good();
+}
+
+} // namespace rjt
@@ -0,0 +1,1198 @@
+#include "RJTupler/StopObjects.h"
+
+// ROOT
+#include "TLorentzVector.h"
+
+// SusyNtuple
+#include "SusyNtuple/SusyNt.h"
+#include "SusyNtuple/JetSelector.h"
+
+// Superflow
+#include "Superflow/Superlink.h"
+#include "Superflow/Cut.h"
+
+using namespace std;
+using namespace sflow;
+
+namespace rjt {
+
+StopObjects::StopObjects() :
+    m_dilepton(nullptr),
+    m_dibjet(nullptr)
+{
+    // enough for (nearly) every event, so that the per-event copies reuse
+    // their storage instead of growing in the event loop
+    leptons.reserve(4);
+    electrons.reserve(4);
+    muons.reserve(4);
+    jets.reserve(16);
+    bjets.reserve(8);
+    sjets.reserve(16);
+}
+//////////////////////////////////////////////////////////////////////////////
+const TLorentzVector& StopObjects::dilepton()
+{
+    if(!m_dilepton) {
+        m_dilepton = arena.make<TLorentzVector>();
+        if(leptons.size() >= 2) {
+            TLorentzVector l0, l1;
+            l0.SetPtEtaPhiM(leptons.at(0)->Pt(), leptons.at(0)->Eta(), leptons.at(0)->Phi(), leptons.at(0)->M());
+            l1.SetPtEtaPhiM(leptons.at(1)->Pt(), leptons.at(1)->Eta(), leptons.at(1)->Phi(), leptons.at(1)->M());
+            *m_dilepton = l0 + l1;
+        }
+    }
+    return *m_dilepton;
+}
+//////////////////////////////////////////////////////////////////////////////
+const TLorentzVector& StopObjects::dibjet()
+{
+    if(!m_dibjet) {
+        m_dibjet = arena.make<TLorentzVector>();
+        if(bjets.size() >= 2) *m_dibjet = *bjets.at(0) + *bjets.at(1);
+    }
+    return *m_dibjet;
+}
+//////////////////////////////////////////////////////////////////////////////
+void StopObjects::end_event()
+{
+    m_dilepton = nullptr;
+    m_dibjet = nullptr;
+    arena.reset();
+}
+//////////////////////////////////////////////////////////////////////////////
+void StopObjects::add_lepton_variables(FlowBuilder& flow)
+{
+    FlowBuilder* cutflow = &flow;
+
+    *cutflow << rjt::InputScope("leptons");
+
+    *cutflow << rjt::Outputs("leptons") << [&](Superlink* sl, var_void*) {
+        leptons = *sl->leptons;
+        m_dilepton = nullptr;
+    };
+    *cutflow << rjt::Outputs("electrons") << [&](Superlink* sl, var_void*) { electrons = *sl->electrons; };
+    *cutflow << rjt::Outputs("muons") << [&](Superlink* sl, var_void*) { muons = *sl->muons; };
+
+   *cutflow << NewVar("number of leptons"); {
+       *cutflow << HFTname("nLeptons");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return leptons.size(); };
+       *cutflow << SaveVar();
+   }
+   *cutflow << rjt::Inputs("electrons");
+   *cutflow << NewVar("number of electrons"); {
+       *cutflow << HFTname("nElectrons");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return electrons.size(); };
+       *cutflow << SaveVar();
+   }
+   *cutflow << rjt::Inputs("muons");
+   *cutflow << NewVar("number of muons"); {
+       *cutflow << HFTname("nMuons");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return muons.size(); };
+       *cutflow << SaveVar();
+   }
+   *cutflow << NewVar("is an EE event"); {
+       *cutflow << HFTname("isEE");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int  {
+            if(leptons.size()<2) return 0;
+            int val = 0;
+            if(leptons.at(0)->isEle() && leptons.at(1)->isEle()) { val = 1; }
+            else { val = 0; }
+            return val;
+       };
+       *cutflow << SaveVar();
+   }
+
+   *cutflow << NewVar("is an MM event"); {
+       *cutflow << HFTname("isMM");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(leptons.size()<2) return 0;
+            int val = 0;
+            if(leptons.at(0)->isMu() && leptons.at(1)->isMu()) { val = 1; }
+            else { val = 0; }
+            return val;
+       };
+       *cutflow << SaveVar();
+   }
+   *cutflow << NewVar("is an EM event"); {
+       *cutflow << HFTname("isEM");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(leptons.size()<2) return 0;
+            int val = 0;
+            if(leptons.at(0)->isEle() && leptons.at(1)->isMu()) { val = 1; }
+            else { val = 0; }
+            return val;
+       };
+       *cutflow << SaveVar();
+   }
+   *cutflow << NewVar("is an ME event"); {
+       *cutflow << HFTname("isME");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(leptons.size()<2) return 0;
+            int val = 0;
+            if(leptons.at(0)->isMu() && leptons.at(1)->isEle()) { val = 1; }
+            else { val = 0; }
+            return val;
+       };
+       *cutflow << SaveVar();
+   }
+   *cutflow << NewVar("is a SF event"); {
+       *cutflow << HFTname("isSF");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(leptons.size()<2) return 0;
+             int val = 0;
+            if( (leptons.at(0)->isEle() && leptons.at(1)->isEle()) ||
+                (leptons.at(0)->isMu() && leptons.at(1)->isMu()) ) { val = 1; }
+            else { val = 0; }
+             return val;
+       };
+       *cutflow << SaveVar();
+   }
+   *cutflow << NewVar("is a DF event"); {
+       *cutflow << HFTname("isDF");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+           if(leptons.size()<2) return 0;
+            int val = 0;
+           if( (leptons.at(0)->isEle() && leptons.at(1)->isMu()) ||
+               (leptons.at(0)->isMu() && leptons.at(1)->isEle()) )  { val = 1; }
+           else { val = 0; }
+            return val;
+       };
+       *cutflow << SaveVar();
+   }
+   *cutflow << NewVar("lepton flavor [EE=0,MM=1,EM=2,ME=3]"); {
+       *cutflow << HFTname("l_flav");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+           if(leptons.size()<2) return -1;
+           bool e0 = leptons.at(0)->isEle();
+           bool e1 = leptons.at(1)->isEle();
+
+           if( e0 && e1 ) { return 0; }
+           else if( !e0 && !e1 ) { return 1; }
+           else if( e0 && !e1 ) { return 2; }
+           else if( !e0 && e1 ) { return 3; }
+           else { return -1; }
+       };
+       *cutflow << SaveVar();
+   }
+
+   *cutflow << NewVar("lead lepton flavor [E=0, M=1]"); {
+       *cutflow << HFTname("l0_flav");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+           bool e = leptons.at(0)->isEle();
+           bool m = leptons.at(0)->isMu();
+
+           if(e && !m) return 0;
+           if(!e && m) return 1;
+           else { return -1; }
+       };
+       *cutflow << SaveVar();
+   }
+
+   *cutflow << NewVar("sub lead lepton flavor [E=0, M=1]"); {
+       *cutflow << HFTname("l1_flav");
+       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+           if(leptons.size()<2) return -1;
+           bool e = leptons.at(1)->isEle();
+           bool m = leptons.at(1)->isMu();
+           if(e && !m) return 0;
+           if(!e && m) return 1;
+           else { return -1; }
+       };
+       *cutflow << SaveVar();
+   }
+
+    *cutflow << NewVar("lead lepton q"); {
+        *cutflow << HFTname("l0_q");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return leptons.at(0)->q; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lepton q"); {
+        *cutflow << HFTname("l1_q");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(leptons.size()<2) return 0;
+            return leptons.at(1)->q;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lepton d0"); {
+        *cutflow << HFTname("l0_d0");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            return leptons.at(0)->d0;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lepton d0"); {
+        *cutflow << HFTname("l1_d0");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -10;
+            return leptons.at(1)->d0;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lepton d0sig"); {
+        *cutflow << HFTname("l0_d0sig");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->d0sigBSCorr; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lepton d0sig"); {
+        *cutflow << HFTname("l1_d0sig");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -10;
+            return leptons.at(1)->d0sigBSCorr;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lepton z0sinTheta"); {
+        *cutflow << HFTname("l0_z0sinTheta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->z0SinTheta(); };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lepton z0sinTheta"); {
+        *cutflow << HFTname("l1_z0sinTheta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -10;
+            return leptons.at(1)->z0SinTheta();
+        };
+        *cutflow << SaveVar();
+    }
+
+    // electron stuff
+    *cutflow << NewVar("lead electron clusE"); {
+        *cutflow << HFTname("e0_clusE");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(0))->clusE;
+            }
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead electron clusE"); {
+        *cutflow << HFTname("e1_clusE");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            if(leptons.at(1)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(1))->clusE;
+            }
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead electron clusEtaBE"); {
+        *cutflow << HFTname("e0_clusEtaBE");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(0))->clusEtaBE;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub-lead electron clusEtaBE"); {
+        *cutflow << HFTname("e1_clusEtaBE");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(1))->clusEtaBE;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead electron clusPhiBE"); {
+        *cutflow << HFTname("e0_clusPhiBE");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(0))->clusPhiBE;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("sub-lead electron clusPhiBE"); {
+        *cutflow << HFTname("e1_clusPhiBE");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(1))->clusPhiBE;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead electron track Pt"); {
+        *cutflow << HFTname("e0_trackPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(0))->trackPt;
+            }
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub-lead electron track Pt"); {
+        *cutflow << HFTname("e1_trackPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            if(leptons.at(1)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(1))->trackPt;
+            }
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead electron track Eta"); {
+        *cutflow << HFTname("e0_trackEta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(0))->trackEta;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub-lead electron track Eta"); {
+        *cutflow << HFTname("e1_trackEta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isEle()) {
+                return static_cast<Susy::Electron*>(leptons.at(1))->trackEta;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    // muon stuff
+    *cutflow << NewVar("lead muon ID track Pt"); {
+        *cutflow << HFTname("mu0_idTrackPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackPt;
+            }
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead muon ID track Pt"); {
+        *cutflow << HFTname("mu1_idTrackPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackPt;
+            }
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon ID track Eta"); {
+        *cutflow << HFTname("mu0_idTrackEta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackEta;
+            }
+            return -5;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead muon ID track Eta"); {
+        *cutflow << HFTname("mu1_idTrackEta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackEta;
+            }
+            return -5;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon ID track Phi"); {
+        *cutflow << HFTname("mu0_idTrackPhi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackPhi;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("sublead muon ID track Phi"); {
+        *cutflow << HFTname("mu1_idTrackPhi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackPhi;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon ID q/p"); {
+        *cutflow << HFTname("mu0_idTrackQoverP");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackQoverP;
+            }
+            else return -5;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead muon ID q/p"); {
+        *cutflow << HFTname("mu1_idTrackQoverP");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackQoverP;
+            }
+            else return -5;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon MS track Pt"); {
+        *cutflow << HFTname("mu0_msTrackPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackPt;
+            }
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead muon MS track Pt"); {
+        *cutflow << HFTname("mu1_msTrackPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackPt;
+            }
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon MS track Eta"); {
+        *cutflow << HFTname("mu0_msTrackEta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackEta;
+            }
+            return -5;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead muon MS track Eta"); {
+        *cutflow << HFTname("mu1_msTrackEta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackEta;
+            }
+            return -5;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon MS track Phi"); {
+        *cutflow << HFTname("mu0_msTrackPhi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackPhi;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("sublead muon MS track Phi"); {
+        *cutflow << HFTname("mu1_msTrackPhi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackPhi;
+            }
+            else { return -5; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead muon MS q/p"); {
+        *cutflow << HFTname("mu0_msTrackQoverP");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.at(0)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackQoverP;
+            }
+            else return -5;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead muon MS q/p"); {
+        *cutflow << HFTname("mu1_msTrackQoverP");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            if(leptons.at(1)->isMu()) {
+                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackQoverP;
+            }
+            else return -5;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead lepton pt"); {
+        *cutflow << HFTname("l0_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            return leptons.at(0)->Pt();
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("sublead lepton pt"); {
+        *cutflow << HFTname("l1_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->Pt();
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep topoetcone20"); {
+        *cutflow << HFTname("l0_topoetcone20");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->topoetcone20; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep topoetcone20"); {
+        *cutflow << HFTname("l1_topoetcone20");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->topoetcone20;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep topoetcone30"); {
+        *cutflow << HFTname("l0_topoetcone30");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->topoetcone30; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep topoetcone30"); {
+        *cutflow << HFTname("l1_topoetcone30");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->topoetcone30;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep ptcone20"); {
+        *cutflow << HFTname("l0_ptcone20");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptcone20; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep ptcone20"); {
+        *cutflow << HFTname("l1_ptcone20");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->ptcone20;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep ptcone30"); {
+        *cutflow << HFTname("l0_ptcone30");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptcone30; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep ptcone30"); {
+        *cutflow << HFTname("l1_ptcone30");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->ptcone30;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep ptvarcone20"); {
+        *cutflow << HFTname("l0_ptvarcone20");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptvarcone20; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep ptvarcone20"); {
+        *cutflow << HFTname("l1_ptvarcone20");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->ptvarcone20;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep ptvarcone30"); {
+        *cutflow << HFTname("l0_ptvarcone30");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptvarcone30; };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep ptvarcone30"); {
+        *cutflow << HFTname("l1_ptvarcone30");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -1;
+            return leptons.at(1)->ptvarcone30;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep eta"); {
+        *cutflow << HFTname("l0_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            return leptons.at(0)->Eta();
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep eta"); {
+        *cutflow << HFTname("l1_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            return leptons.at(1)->Eta();
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead lep phi"); {
+        *cutflow << HFTname("l0_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            return leptons.at(0)->Phi();
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sublead lep phi"); {
+        *cutflow << HFTname("l1_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+           if(leptons.size()<2) return -5;
+           return leptons.at(1)->Phi();
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("mll leptons"); {
+        *cutflow << HFTname("mll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double mll = -10.0;
+            if(leptons.size() == 2) {
+                Lepton* l0 = leptons.at(0);
+                Lepton* l1 = leptons.at(1);
+                mll = (*l0 + *l1).M();
+            }
+            return mll;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("dilepton pT"); {
+        *cutflow << HFTname("pTll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double pTll = -10.0;
+            if(leptons.size() == 2) {
+                Lepton* l0 = leptons.at(0);
+                Lepton* l1 = leptons.at(1);
+                pTll = (*l0 + *l1).Pt();
+            }
+            return pTll;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("delta phi between to leptons"); {
+        *cutflow << HFTname("dphi_ll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double dphi = -10.0;
+            if(leptons.size() == 2) {
+                const Lepton& l0 = *leptons.at(0);
+                const Lepton& l1 = *leptons.at(1);
+                dphi = l0.DeltaPhi(l1);
+            }
+            return dphi;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("delta eta between two leptons"); {
+        *cutflow << HFTname("deta_ll");
+        *cutflow << [&](Superlink* /* sl */, var_float*) -> double {
+            double deta = -10.0;
+            if(leptons.size() == 2) {
+                const Lepton& l0 = *leptons.at(0);
+                const Lepton& l1 = *leptons.at(1);
+                deta = l0.Eta() - l1.Eta();
+            }
+            return deta;
+        };
+        *cutflow << SaveVar();
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void StopObjects::add_jet_variables(FlowBuilder& flow)
+{
+    FlowBuilder* cutflow = &flow;
+
+    *cutflow << rjt::InputScope("jets");
+
+
+    *cutflow << rjt::Outputs("jets") << [&](Superlink* sl, var_void*) { jets = *sl->jets; };
+    *cutflow << rjt::Outputs("bjets sjets") << [&](Superlink* sl, var_void*) {
+        bjets.clear();
+        sjets.clear();
+        m_dibjet = nullptr;
+        for(int i = 0; i < (int)jets.size(); i++) {
+            Jet* j = jets[i];
+            if(sl->tools->jetSelector().isBJet(j))  bjets.push_back(j);
+            else { sjets.push_back(j); }
+        }// i
+    };
+
+    // some of the jet variables also use the leptons
+    *cutflow << rjt::InputScope("leptons jets bjets sjets");
+
+    *cutflow << NewVar("lead jet jvt"); {
+        *cutflow << HFTname("j0_jvt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>0) return jets.at(0)->jvt;
+            else { return -10; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead sjet jvt"); {
+        *cutflow << HFTname("sj0_jvt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->jvt;
+            else { return -10; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead bjet jvt"); {
+        *cutflow << HFTname("bj0_jvt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>0) return bjets.at(0)->jvt;
+            else { return -10; }
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("jet nTracks"); {
+        *cutflow << HFTname("j0_nTracks");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(jets.size()>0) return jets.at(0)->nTracks;
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sjet nTracks"); {
+        *cutflow << HFTname("sj0_nTracks");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(sjets.size()>0) return sjets.at(0)->nTracks;
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("bjet nTracks"); {
+        *cutflow << HFTname("bj0_nTracks");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            if(bjets.size()>0) return bjets.at(0)->nTracks;
+            else { return -1; }
+        };
+        *cutflow << SaveVar();
+    }
+
+
+    *cutflow << NewVar("jet sumTrkPt"); {
+        *cutflow << HFTname("j0_sumTrkPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>0) return jets.at(0)->sumTrkPt;
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sjet sumTrkPt"); {
+        *cutflow << HFTname("sj0_sumTrkPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->sumTrkPt;
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("bjet sumTrkPt"); {
+        *cutflow << HFTname("bj0_sumTrkPt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>0) return bjets.at(0)->sumTrkPt;
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("jet mv2c10"); {
+        *cutflow << HFTname("j0_mv2c10");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>0) return jets.at(0)->mv2c10;
+            else return -10;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sjet mv2c10"); {
+        *cutflow << HFTname("sj0_mv2c10");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->mv2c10;
+            else return -10;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("bjet mv2c10"); {
+        *cutflow << HFTname("bj0_mv2c10");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>0) return bjets.at(0)->mv2c10;
+            else return -10;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("jet emfrac"); {
+        *cutflow << HFTname("j0_emfrac");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>0) return jets.at(0)->emfrac;
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sjet emfrac"); {
+        *cutflow << HFTname("sj0_emfrac");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->emfrac;
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("bjet emfrac"); {
+        *cutflow << HFTname("bj0_emfrac");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>0) return bjets.at(0)->emfrac;
+            else return -1;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("number of jets"); {
+        *cutflow << HFTname("nJets");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            return jets.size();
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("number of sjets"); {
+        *cutflow << HFTname("nSJets");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            return sjets.size();
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("number of bjets"); {
+        *cutflow << HFTname("nBJets");
+        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
+            return bjets.size();
+        };
+        *cutflow << SaveVar();
+    }
+
+
+    *cutflow << NewVar("lead jet pt"); {
+        *cutflow << HFTname("j0_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10;
+            if(jets.size()>0) val = jets.at(0)->Pt();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead jet pt"); {
+        *cutflow << HFTname("j1_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(jets.size()>1) val = jets.at(1)->Pt();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead jet pt"); {
+        *cutflow << HFTname("j2_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>2) return jets.at(2)->Pt();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead sjet pt"); {
+        *cutflow << HFTname("sj0_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->Pt();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead sjet pt"); {
+        *cutflow << HFTname("sj1_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>1) return sjets.at(1)->Pt();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead sjet pt"); {
+        *cutflow << HFTname("sj2_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>2) return sjets.at(2)->Pt();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead bjet pt"); {
+        *cutflow << HFTname("bj0_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(bjets.size()>0) val = bjets.at(0)->Pt();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead bjet pt"); {
+        *cutflow << HFTname("bj1_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(bjets.size()>1) val = bjets.at(1)->Pt();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead bjet pt"); {
+        *cutflow << HFTname("bj2_pt");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>2) return bjets.at(2)->Pt();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead jet eta"); {
+        *cutflow << HFTname("j0_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(jets.size()>0) val = jets.at(0)->Eta();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead jet eta"); {
+        *cutflow << HFTname("j1_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(jets.size()>1) val = jets.at(1)->Eta();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead jet eta"); {
+        *cutflow << HFTname("j2_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>2)  return jets.at(2)->Eta();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("lead sjet eta"); {
+        *cutflow << HFTname("sj0_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->Eta();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead sjet eta"); {
+        *cutflow << HFTname("sj1_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>1) return sjets.at(1)->Eta();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead sjet eta"); {
+        *cutflow << HFTname("sj2_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>2) return sjets.at(2)->Eta();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("sub lead bjet eta"); {
+        *cutflow << HFTname("bj1_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(bjets.size()>1) val = bjets.at(1)->Eta();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead bjet eta"); {
+        *cutflow << HFTname("bj2_eta");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>2) return bjets.at(2)->Eta();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead jet phi"); {
+        *cutflow << HFTname("j0_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(jets.size()>0) val = jets.at(0)->Phi();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead jet phi"); {
+        *cutflow << HFTname("j1_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(jets.size()>1) val = jets.at(1)->Phi();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead jet phi"); {
+        *cutflow << HFTname("j2_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(jets.size()>2) return jets.at(2)->Phi();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead sjet phi"); {
+        *cutflow << HFTname("sj0_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>0) return sjets.at(0)->Phi();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead sjet phi"); {
+        *cutflow << HFTname("sj1_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>1)  return sjets.at(1)->Phi();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead sjet phi"); {
+        *cutflow << HFTname("sj2_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(sjets.size()>2) return sjets.at(2)->Phi();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("lead bjet phi"); {
+        *cutflow << HFTname("bj0_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(bjets.size()>0) val = bjets.at(0)->Phi();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("sub lead bjet phi"); {
+        *cutflow << HFTname("bj1_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            float val = -10.;
+            if(bjets.size()>1) val = bjets.at(1)->Phi();
+            return val;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("third lead bjet phi"); {
+        *cutflow << HFTname("bj2_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(bjets.size()>2) return bjets.at(2)->Phi();
+            else return -10.;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("delta phi between dilepton system and leading jet"); {
+        *cutflow << HFTname("dphi_j0_ll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double out = -10.;
+            if(jets.size()>0 && leptons.size()>=2) {
+                const TLorentzVector& ll = dilepton();
+                out = jets.at(0)->DeltaPhi(ll);
+            }
+            return out;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("delta phi between leading lepton and leading sjet"); {
+        *cutflow << HFTname("dphi_j0_l0");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double out = -10.;
+            if(jets.size()>0) {
+                out = jets.at(0)->DeltaPhi(*leptons.at(0));
+            }
+            return out;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("delta phi between dilepton system and leading sjet"); {
+        *cutflow << HFTname("dphi_sj0_ll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double out = -10;
+            if(sjets.size()>0 && leptons.size()>=2) {
+                const TLorentzVector& ll = dilepton();
+                out = sjets.at(0)->DeltaPhi(ll);
+            }
+            return out;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("delta phi between leading lepton and leading sjet"); {
+        *cutflow << HFTname("dphi_sj0_l0");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double out = -10;
+            if(sjets.size()>0) {
+                out = sjets.at(0)->DeltaPhi(*leptons.at(0));
+            }
+            return out;
+        };
+        *cutflow << SaveVar();
+    }
+
+    *cutflow << NewVar("delta phi between dilepton system and leading bjet"); {
+        *cutflow << HFTname("dphi_bj0_ll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double out = -10.;
+            if(bjets.size()>0 && leptons.size()>=2) {
+                const TLorentzVector& ll = dilepton();
+                out = bjets.at(0)->DeltaPhi(ll);
+            }
+            return out;
+        };
+        *cutflow << SaveVar();
+    }
+    *cutflow << NewVar("delta phi between leading lepton and leading bjet"); {
+        *cutflow << HFTname("dphi_bj0_l0");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double out = -10.;
+            if(bjets.size()>0) {
+                out = bjets.at(0)->DeltaPhi(*leptons.at(0));
+            }
+            return out;
+        };
+        *cutflow << SaveVar();
+    }
+}
+
+} // namespace rjt
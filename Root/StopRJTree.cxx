@@ -0,0 +1,251 @@
+#include "RJTupler/StopRJTree.h"
+
+// std
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+using namespace RestFrames;
+
+namespace rjt {
+
+StopRJTree::StopRJTree() :
+    H_11_SS(0.),
+    H_21_SS(0.),
+    H_12_SS(0.),
+    H_22_SS(0.),
+    H_11_S1(0.),
+    H_11_SS_T(0.),
+    H_21_SS_T(0.),
+    H_22_SS_T(0.),
+    H_11_S1_T(0.),
+    shat(0.),
+    pTT_T(0.),
+    pTT_Z(0.),
+    RPT(0.),
+    RPT_H_11_SS(0.),
+    RPT_H_21_SS(0.),
+    RPT_H_22_SS(0.),
+    RPZ_H_11_SS(0.),
+    RPZ_H_21_SS(0.),
+    RPZ_H_22_SS(0.),
+    RPT_H_11_SS_T(0.),
+    RPT_H_21_SS_T(0.),
+    RPT_H_22_SS_T(0.),
+    RPZ(0.),
+    RPZ_H_11_SS_T(0.),
+    RPZ_H_21_SS_T(0.),
+    RPZ_H_22_SS_T(0.),
+    gamInvRp1(0.),
+    MDR(0.),
+    costheta_SS(0.),
+    dphi_v_SS(0.),
+    DPB_vSS(0.),
+    cosB_1(0.),
+    cosB_2(0.),
+    cosB_3(0.),
+    cosB_4(0.),
+    dphi_v1_i1_ss(0.),
+    dphi_s1_s2_ss(0.),
+    dphiS_I_ss(0.),
+    dphiS_I_s1(0.),
+    lab("lab", "lab"),
+    ss("ss", "ss"),
+    s1("s1", "s1"),
+    s2("s2", "s2"),
+    v1("v1", "v1"),
+    v2("v2", "v2"),
+    i1("i1", "i1"),
+    i2("i2", "i2"),
+    inv("inv", "invisible group jigsaws"),
+    vis("vis", "visible object jigsaws"),
+    MinMassJigsaw("MinMass", "Invisible system mass jigsaw"),
+    RapidityJigsaw("RapidityJigsaw", "Invisible system rapidity jigsaw"),
+    ContraBoostJigsaw("ContraBoostJigsaw", "ContraBoost Invariant Jigsaw"),
+    HemiJigsaw("hemi_jigsaw", "Minimize m_{v_{1,2}} jigsaw")
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+bool StopRJTree::initialize()
+{
+    // connect thte frames
+    lab.SetChildFrame(ss);
+    ss.AddChildFrame(s1);
+    ss.AddChildFrame(s2);
+    s1.AddChildFrame(i1);
+    s1.AddChildFrame(v1);
+    s2.AddChildFrame(i2);
+    s2.AddChildFrame(v2);
+
+    if(!lab.InitializeTree()) {
+        cout << "StopRJTree::initialize    RestFrames::InitializeTree ERROR Unable to initialize tree from lab frame" << endl;
+        return false;
+    }
+
+    inv.AddFrame(i1);
+    inv.AddFrame(i2);
+
+    vis.AddFrame(v1);
+    vis.SetNElementsForFrame(v1, 1, false);
+    vis.AddFrame(v2);
+    vis.SetNElementsForFrame(v2, 1, false);
+
+    inv.AddJigsaw(MinMassJigsaw);
+
+    inv.AddJigsaw(RapidityJigsaw);
+    RapidityJigsaw.AddVisibleFrames(lab.GetListVisibleFrames());
+
+    inv.AddJigsaw(ContraBoostJigsaw);
+    ContraBoostJigsaw.AddVisibleFrames((s1.GetListVisibleFrames()), 0);
+    ContraBoostJigsaw.AddVisibleFrames((s2.GetListVisibleFrames()), 1);
+    ContraBoostJigsaw.AddInvisibleFrame(i1, 0);
+    ContraBoostJigsaw.AddInvisibleFrame(i2, 1);
+
+    vis.AddJigsaw(HemiJigsaw);
+    HemiJigsaw.AddFrame(v1, 0);
+    HemiJigsaw.AddFrame(v2, 1);
+
+    if(!lab.InitializeAnalysis()) {
+        cout << "StopRJTree::initialize    RestFrames::InitializeAnalysis ERROR Unable to initialize analysis from lab frame" << endl;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+void StopRJTree::analyze(const TVector3& met, const TLorentzVector& l0, const TLorentzVector& l1)
+{
+
+    // clear the tree on each event
+    lab.ClearEvent();
+
+    // set the met
+    inv.SetLabFrameThreeVector(met);
+
+    // add leptons to the visible group
+    vis.AddLabFrameFourVector(l0);
+    vis.AddLabFrameFourVector(l1);
+
+    // analyze the event
+    lab.AnalyzeEvent();
+
+    //////////////////////////////
+    // HT variables -- SS frame
+    //////////////////////////////
+
+    // H_1_1^SS
+    TLorentzVector tlv_v1_ss = v1.GetFourVector(ss);
+    TLorentzVector tlv_v2_ss = v2.GetFourVector(ss);
+    TLorentzVector tlv_i1_ss = i1.GetFourVector(ss);
+    TLorentzVector tlv_i2_ss = i2.GetFourVector(ss);
+
+    TVector3 p_v1_ss = tlv_v1_ss.Vect();
+    TVector3 p_v2_ss = tlv_v2_ss.Vect();
+    TVector3 p_i1_ss = tlv_i1_ss.Vect();
+    TVector3 p_i2_ss = tlv_i2_ss.Vect();
+
+    TVector3 p_v_ss = p_v1_ss + p_v2_ss;
+    TVector3 p_i_ss = p_i1_ss + p_i2_ss;
+
+    H_11_SS = p_v_ss.Mag() + p_i_ss.Mag();
+
+    // H_2_1^SS
+    H_21_SS = p_v1_ss.Mag() + p_v2_ss.Mag() + p_i_ss.Mag();
+
+    // H_1_2^SS
+    H_12_SS = p_v_ss.Mag() + p_i1_ss.Mag() + p_i2_ss.Mag();
+
+    // H_2_2^SS
+    H_22_SS = p_v1_ss.Mag() + p_v2_ss.Mag() + p_i1_ss.Mag() + p_i2_ss.Mag();
+
+    //////////////////////////////
+    // HT variables -- S1 frame
+    //////////////////////////////
+    TLorentzVector tlv_v1_s1 = v1.GetFourVector(s1);
+    TLorentzVector tlv_i1_s1 = i1.GetFourVector(s1);
+
+    TVector3 p_v1_s1 = tlv_v1_s1.Vect();
+    TVector3 p_i1_s1 = tlv_i1_s1.Vect();
+
+    H_11_S1 = p_v1_s1.Mag() + p_i1_s1.Mag();
+
+    ///////////////////////////////
+    // transverse scale variables
+    ///////////////////////////////
+    TVector3 tp_v1_ss = tlv_v1_ss.Vect(); tp_v1_ss.SetZ(0.);
+    TVector3 tp_v2_ss = tlv_v2_ss.Vect(); tp_v2_ss.SetZ(0.);
+    TVector3 tp_i1_ss = tlv_i1_ss.Vect(); tp_i1_ss.SetZ(0.);
+    TVector3 tp_i2_ss = tlv_i2_ss.Vect(); tp_i2_ss.SetZ(0.);
+    TVector3 tp_v1_s1 = tlv_v1_s1.Vect(); tp_v1_s1.SetZ(0.);
+    TVector3 tp_i1_s1 = tlv_i1_s1.Vect(); tp_i1_s1.SetZ(0.);
+
+    H_11_SS_T = (tp_v1_ss + tp_v2_ss).Mag() + (tp_i1_ss + tp_i2_ss).Mag();
+    H_21_SS_T = tp_v1_ss.Mag() + tp_v2_ss.Mag() + (tp_i1_ss + tp_i2_ss).Mag();
+    H_22_SS_T = tp_v1_ss.Mag() + tp_v2_ss.Mag() + tp_i1_ss.Mag() + tp_i2_ss.Mag();
+    H_11_S1_T = tp_v1_s1.Mag() + tp_i1_s1.Mag();
+
+    /// system mass
+    shat = ss.GetMass();
+
+    //////////////////////
+    // RATIO OF CM pT
+    TVector3 vPTT = ss.GetFourVector(lab).Vect();
+    pTT_T = vPTT.Pt();
+    pTT_Z = vPTT.Pz();
+    RPT = vPTT.Pt() / (vPTT.Pt() + shat / 4.);
+    RPZ = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + shat / 4.);
+
+    RPT_H_11_SS = vPTT.Pt() / (vPTT.Pt() + H_11_SS/4.);
+    RPT_H_21_SS = vPTT.Pt() / (vPTT.Pt() + H_21_SS/4.);
+    RPT_H_22_SS = vPTT.Pt() / (vPTT.Pt() + H_22_SS/4.);
+    RPZ_H_11_SS = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_11_SS/4.);
+    RPZ_H_21_SS = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_21_SS/4.);
+    RPZ_H_22_SS = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_22_SS/4.);
+
+    RPT_H_11_SS_T = vPTT.Pt() / (vPTT.Pt() + H_11_SS_T/4.);
+    RPT_H_21_SS_T = vPTT.Pt() / (vPTT.Pt() + H_21_SS_T/4.);
+    RPT_H_22_SS_T = vPTT.Pt() / (vPTT.Pt() + H_22_SS_T/4.);
+    RPZ_H_11_SS_T = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_11_SS_T/4.);
+    RPZ_H_21_SS_T = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_21_SS_T/4.);
+    RPZ_H_22_SS_T = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_22_SS_T/4.);
+
+    //////////////////////
+    // shapes
+    gamInvRp1 = ss.GetVisibleShape();
+
+    //////////////////////
+    // MDR
+    MDR = 2.0 * v1.GetEnergy(s1);
+
+    /////////////////////
+    // ANGLES
+    costheta_SS = ss.GetCosDecayAngle();
+    dphi_v_SS = ss.GetDeltaPhiVisible();
+
+    // costhetaB emulatur
+    TVector3 v_s = s1.GetFourVector(ss).Vect().Unit();
+    TVector3 v_v = v1.GetFourVector(s1).Vect().Unit();
+    cosB_1 = v_s.Dot(v_v);
+
+    cosB_2 = v1.GetCosDecayAngle(s1);
+
+    cosB_3 = v1.GetCosDecayAngle(ss);
+
+    TVector3 v_v2 = v1.GetFourVector(ss).Vect().Unit();
+    cosB_4 = v_s.Dot(v_v2);
+
+    // angle between invisible
+    dphi_v1_i1_ss = -1.;//v1.GetFourVector(ss).DeltaPhi(i1.GetFourVector(ss));
+    dphi_s1_s2_ss = -1.;//s1.GetFourVector(ss).DeltaPhi(s2.GetFourVector(ss));
+
+
+    dphiS_I_ss = -1.;//s1.GetFourVector(ss).DeltaPhi(i1.GetFourVector(ss));
+    dphiS_I_s1 = -1.;//s1.GetFourVector(ss).DeltaPhi(i1.GetFourVector(s1));
+
+
+
+    ////////////////////
+    // BOOST ANGLES
+    DPB_vSS = ss.GetDeltaPhiBoostVisible();
+}
+
+} // namespace rjt
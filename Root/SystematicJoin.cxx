@@ -0,0 +1,71 @@
+#include "RJTupler/SystematicJoin.h"
+
+// std
+#include <iostream>
+
+// ROOT
+#include "TROOT.h"
+#include "TTree.h"
+#include "TTreeFormula.h"
+#include "TFriendElement.h"
+
+using namespace std;
+
+namespace rjt {
+
+bool join_nominal(TTree* syst_tree, TTree* nominal_tree, const string& alias,
+        const string& major_key, const string& minor_key, Long64_t* n_unmatched)
+{
+    if(!syst_tree || !nominal_tree) {
+        cout << "join_nominal    ERROR Null tree given" << endl;
+        return false;
+    }
+    for(const string& key : { major_key, minor_key }) {
+        if(!syst_tree->GetBranch(key.c_str()) || !nominal_tree->GetBranch(key.c_str())) {
+            cout << "join_nominal    ERROR Event key branch '" << key << "' missing from "
+                    << (syst_tree->GetBranch(key.c_str()) ? nominal_tree->GetName() : syst_tree->GetName()) << endl;
+            return false;
+        }
+    }
+    if(nominal_tree->BuildIndex(major_key.c_str(), minor_key.c_str()) <= 0) {
+        cout << "join_nominal    ERROR Unable to index " << nominal_tree->GetName()
+                << " on (" << major_key << ", " << minor_key << ")" << endl;
+        return false;
+    }
+
+    // flag the systematic entries without a nominal entry, in a tree kept
+    // in memory (owned by gROOT) and attached as a friend as well
+    string flag = alias + "Matched";
+    bool matched = true;
+    TTree* match_tree = new TTree((alias + "_match").c_str(), ("nominal match of " + string(syst_tree->GetName())).c_str());
+    match_tree->SetDirectory(gROOT);
+    match_tree->Branch(flag.c_str(), &matched);
+    TTreeFormula major(major_key.c_str(), major_key.c_str(), syst_tree);
+    TTreeFormula minor(minor_key.c_str(), minor_key.c_str(), syst_tree);
+    Long64_t n_missing = 0;
+    Long64_t n_entries = syst_tree->GetEntries();
+    for(Long64_t entry = 0; entry < n_entries; entry++) {
+        syst_tree->LoadTree(entry);
+        Long64_t major_value = static_cast<Long64_t>(major.EvalInstance64());
+        Long64_t minor_value = static_cast<Long64_t>(minor.EvalInstance64());
+        matched = (nominal_tree->GetEntryNumberWithIndex(major_value, minor_value) >= 0);
+        if(!matched) n_missing++;
+        match_tree->Fill();
+    }
+    if(n_unmatched) *n_unmatched = n_missing;
+    if(n_missing > 0) {
+        cout << "join_nominal    WARNING " << n_missing << " of " << n_entries << " entries of "
+                << syst_tree->GetName() << " have no entry in " << nominal_tree->GetName()
+                << ", select " << flag << " when reading through '" << alias << "'" << endl;
+    }
+
+    TFriendElement* fe = syst_tree->AddFriend(nominal_tree, alias.c_str());
+    TFriendElement* fe_match = (fe ? syst_tree->AddFriend(match_tree) : nullptr);
+    if(!fe || !fe_match) {
+        cout << "join_nominal    ERROR Unable to add " << (fe ? match_tree : nominal_tree)->GetName() << " as friend" << endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace rjt
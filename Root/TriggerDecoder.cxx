@@ -0,0 +1,61 @@
+#include "RJTupler/TriggerDecoder.h"
+
+// std
+#include <iostream>
+
+using namespace std;
+
+namespace rjt {
+
+// number of trigger bits probed when resolving the chains
+static const unsigned int n_probe_bits = 1024;
+
+TriggerDecoder::TriggerDecoder() :
+    m_resolved(false)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+void TriggerDecoder::add(const string& name, bool* flag)
+{
+    Chain chain;
+    chain.name = name;
+    chain.flag = flag;
+    chain.bit = -1;
+    m_chains.push_back(chain);
+    m_resolved = false;
+}
+//////////////////////////////////////////////////////////////////////////////
+void TriggerDecoder::resolve(const function<bool(const TBits&, const string&)>& pass)
+{
+    // The bit of a chain is read off one binary digit at a time: probe k
+    // sets every bit whose index has digit k set, and the chain passes it
+    // iff its own bit index has digit k set.
+    TBits all(n_probe_bits);
+    for(unsigned int ib = 0; ib < n_probe_bits; ib++) all.SetBitNumber(ib);
+
+    vector<TBits> probes;
+    for(unsigned int digit = 1; digit < n_probe_bits; digit <<= 1) {
+        TBits probe(n_probe_bits);
+        for(unsigned int ib = 0; ib < n_probe_bits; ib++) {
+            if(ib & digit) probe.SetBitNumber(ib);
+        }
+        probes.push_back(probe);
+    }
+
+    for(Chain& chain : m_chains) {
+        chain.bit = -1;
+        if(!pass(all, chain.name)) {
+            cout << "TriggerDecoder    WARNING Trigger " << chain.name
+                    << " is not in the trigger map, it is stored as failed" << endl;
+            continue;
+        }
+        int bit = 0;
+        for(size_t ip = 0; ip < probes.size(); ip++) {
+            if(pass(probes[ip], chain.name)) bit |= (1 << ip);
+        }
+        chain.bit = bit;
+    }
+    m_resolved = true;
+}
+
+} // namespace rjt
@@ -0,0 +1,490 @@
+#include "RJTupler/TuplerOptions.h"
+#include "RJTupler/CpuPlacement.h"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+namespace rjt {
+
+// read the integer value following argv[i], advancing i
+static bool read_int(int argc, char* argv[], int& i, int& value)
+{
+    if(i + 1 >= argc) {
+        cout << "read_tupler_options    ERROR Missing value for option " << argv[i] << endl;
+        return false;
+    }
+    char* end = nullptr;
+    long v = strtol(argv[i+1], &end, 10);
+    if(end == argv[i+1] || *end != '\0') {
+        cout << "read_tupler_options    ERROR Invalid integer '" << argv[i+1] << "' for option " << argv[i] << endl;
+        return false;
+    }
+    value = static_cast<int>(v);
+    i++;
+    return true;
+}
+// read the floating point value following argv[i], advancing i
+static bool read_double(int argc, char* argv[], int& i, double& value)
+{
+    if(i + 1 >= argc) {
+        cout << "read_tupler_options    ERROR Missing value for option " << argv[i] << endl;
+        return false;
+    }
+    char* end = nullptr;
+    double v = strtod(argv[i+1], &end);
+    if(end == argv[i+1] || *end != '\0') {
+        cout << "read_tupler_options    ERROR Invalid number '" << argv[i+1] << "' for option " << argv[i] << endl;
+        return false;
+    }
+    value = v;
+    i++;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+// read the (64-bit) integer value following argv[i], advancing i
+static bool read_long(int argc, char* argv[], int& i, long long& value)
+{
+    if(i + 1 >= argc) {
+        cout << "read_tupler_options    ERROR Missing value for option " << argv[i] << endl;
+        return false;
+    }
+    char* end = nullptr;
+    long long v = strtoll(argv[i+1], &end, 10);
+    if(end == argv[i+1] || *end != '\0') {
+        cout << "read_tupler_options    ERROR Invalid integer '" << argv[i+1] << "' for option " << argv[i] << endl;
+        return false;
+    }
+    value = v;
+    i++;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+// read the string value following argv[i], advancing i
+static bool read_string(int argc, char* argv[], int& i, string& value)
+{
+    if(i + 1 >= argc) {
+        cout << "read_tupler_options    ERROR Missing value for option " << argv[i] << endl;
+        return false;
+    }
+    value = argv[++i];
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+// strip leading and trailing whitespace
+static string trim(const string& s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if(first == string::npos) return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+//////////////////////////////////////////////////////////////////////////////
+// split on the commas outside of braces, so that regular expression
+// quantifiers like {2,4} stay in one item (escaped braces don't count)
+static vector<string> split_patterns(const string& spec)
+{
+    vector<string> items;
+    string item;
+    int depth = 0;
+    for(size_t i = 0; i < spec.size(); i++) {
+        char c = spec[i];
+        if(c == '\\' && i + 1 < spec.size()) {
+            item += c;
+            item += spec[++i];
+            continue;
+        }
+        if(c == '{') depth++;
+        else if(c == '}' && depth > 0) depth--;
+        else if(c == ',' && depth == 0) {
+            items.push_back(item);
+            item.clear();
+            continue;
+        }
+        item += c;
+    }
+    items.push_back(item);
+    return items;
+}
+//////////////////////////////////////////////////////////////////////////////
+TuplerOptions::TuplerOptions() :
+    weight_array(false),
+    weight_syst_array(false),
+    legacy_trigger_rng(false),
+    shape_syst(false),
+    syst_workers(0),
+    workers(0),
+    num_shards(0),
+    shard_index(-1),
+    first_entry(-1),
+    last_entry(-1),
+    ordered_merge(false),
+    static_split(false),
+    merge_outputs(false),
+    queue_unit(100000),
+    queue_timeout(900),
+    checkpoint_entries(0),
+    resume(false),
+    sample_jobs(1),
+    syst_diff(false),
+    timing(false),
+    progress_interval(0),
+    stage_clock(false),
+    perf_counters(false),
+    alloc_audit(false),
+    counter_warmup(100),
+    io_pipeline(false),
+    io_threads(2),
+    read_ahead_mb(64)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+void print_tupler_usage(const string& ana_name)
+{
+    cout << ana_name << "    RJTupler options:" << endl;
+    cout << ana_name << "      --weight-array         : store the event-weight variants also as one (float) array branch [default: false]" << endl;
+    cout << ana_name << "      --weight-syst-array    : store all weight systematics in the nominal tree, one branch 'syst_<name>_UP/DN'" << endl;
+    cout << ana_name << "                               each [default: false]" << endl;
+    cout << ana_name << "      --legacy-trigger-rng   : draw the trig_2017dilrand random numbers from one stream over the job instead" << endl;
+    cout << ana_name << "                               of per event, as in earlier productions (serial runs only) [default: false]" << endl;
+    cout << ana_name << "      --shape-syst           : register the shape systematics, one tree each (needs a systematics run mode) [default: false]" << endl;
+    cout << ana_name << "      --syst-workers <n>     : split the shape systematics across n forked workers, each writing only the" << endl;
+    cout << ana_name << "                               trees of its systematics ('sysgroup<k>'), plus one worker writing the" << endl;
+    cout << ana_name << "                               nominal tree ('nominal') [default: 0]" << endl;
+    cout << ana_name << "      --workers <n>          : split the entries across n forked workers, in cluster ranges taken from a" << endl;
+    cout << ana_name << "                               shared work-stealing queue, one output file per worker [default: 0]" << endl;
+    cout << ana_name << "      --cpu-list <list>      : pin the --workers/--syst-workers to these cpus (e.g. '0-7,16-23'), worker i to" << endl;
+    cout << ana_name << "                               the i-th, with its memory on that cpu's NUMA node [default: not pinned]" << endl;
+    cout << ana_name << "      --num-shards <n>       : split the input into n shards of about equal size, cut at cluster boundaries [default: 0]" << endl;
+    cout << ana_name << "      --shard-index <i>      : process only shard i (0..n-1), the output name ends in 'shard<i>of<n>' and" << endl;
+    cout << ana_name << "                               the outputs of all shards, merged in shard order, equal a full run" << endl;
+    cout << ana_name << "      --first-entry <e>      : process only the entries from e on (output name ends in 'entries<e>to<l>') [default: 0]" << endl;
+    cout << ana_name << "      --last-entry <l>       : process only the entries before l [default: all]" << endl;
+    cout << ana_name << "      --ordered-merge        : with --workers, merge the worker outputs into one file with the entries in" << endl;
+    cout << ana_name << "                               input order, the same content as a serial run [default: false]" << endl;
+    cout << ana_name << "      --static-split         : with --workers, give each worker one contiguous block of the entries, without" << endl;
+    cout << ana_name << "                               work stealing [default: false]" << endl;
+    cout << ana_name << "      --merge                : with --workers, merge the worker outputs (and cutflows) into one file, in worker" << endl;
+    cout << ana_name << "                               order, with --static-split the same as a serial run [default: false]" << endl;
+    cout << ana_name << "      --queue-dir <dir>      : take work units from the work queue in <dir> (created if missing), shared with" << endl;
+    cout << ana_name << "                               other ntupler processes running on the same -i, one output file per unit" << endl;
+    cout << ana_name << "                               [default: none]" << endl;
+    cout << ana_name << "      --queue-unit <n>       : entries per work unit when creating the queue, cut at cluster boundaries [default: 100000]" << endl;
+    cout << ana_name << "      --queue-timeout <s>    : seconds without a heartbeat after which a claimed unit is re-issued [default: 900]" << endl;
+    cout << ana_name << "      --checkpoint <n>       : write the output in segments of about n entries and record the completed ones" << endl;
+    cout << ana_name << "                               in a checkpoint file, the segments are merged at the end [default: 0, off]" << endl;
+    cout << ana_name << "      --checkpoint-file <f>  : the checkpoint file [default: <analysis>_<suffix>.checkpoint]" << endl;
+    cout << ana_name << "      --resume               : continue from the checkpoint of an interrupted run (starts over if there is none)" << endl;
+    cout << ana_name << "      --sample-list <file>   : process every sample listed in <file> (one input per line, instead of -i), with" << endl;
+    cout << ana_name << "                               the tools initialized once, one output and cutflow per sample, the output" << endl;
+    cout << ana_name << "                               name of the i-th sample (from 0) ending in 'sample<i>' [default: none]" << endl;
+    cout << ana_name << "      --sample-jobs <n>      : process up to n samples of the --sample-list in parallel [default: 1]" << endl;
+    cout << ana_name << "      --serve <socket>       : once initialized (with -i as the template input) serve jobs sent with" << endl;
+    cout << ana_name << "                               ntupler_submit over the Unix-domain socket, until shut down [default: none]" << endl;
+    cout << ana_name << "      --syst-diff            : systematic trees store only object-dependent variables and the event key [default: false]" << endl;
+    cout << ana_name << "      --vars <list>          : compute and store only the variables whose HFTname matches one of the comma" << endl;
+    cout << ana_name << "                               separated regular expressions (commas inside {m,n} don't separate), '@<file>'" << endl;
+    cout << ana_name << "                               reads them from a profile [default: all]" << endl;
+    cout << ana_name << "      --timing               : time every cut, variable and producer, print a ranked report at the end [default: false]" << endl;
+    cout << ana_name << "      --timing-json <file>   : as --timing, also write the report as JSON to <file> [default: none]" << endl;
+    cout << ana_name << "      --progress <s>         : report rate, ETA, memory and output size every <s> seconds [default: 0, off]" << endl;
+    cout << ana_name << "      --progress-file <file> : also append each report as a JSON line to <file> (every 60 s unless --progress) [default: none]" << endl;
+    cout << ana_name << "      --stage-clock          : report the event-loop time split into read, unzip, object building, cuts," << endl;
+    cout << ana_name << "                               variables and output filling, per input file and for the job [default: false]" << endl;
+    cout << ana_name << "      --perf-counters        : count cycles, instructions, cache and branch misses per stage of the" << endl;
+    cout << ana_name << "                               event loop (trigger decoding, RestFrames, ...) with perf_event_open [default: false]" << endl;
+    cout << ana_name << "      --alloc-audit          : count heap allocations (and bytes) per event and stage of the event loop [default: false]" << endl;
+    cout << ana_name << "      --counter-warmup <n>   : entries processed before --perf-counters/--alloc-audit start counting [default: 100]" << endl;
+    cout << ana_name << "      --io-pipeline          : read ahead and unzip the input, and compress the output, on helper threads [default: false]" << endl;
+    cout << ana_name << "      --io-threads <n>       : helper threads of the I/O pipeline (implies --io-pipeline) [default: 2]" << endl;
+    cout << ana_name << "      --read-ahead <MB>      : size of the input read-ahead cache (implies --io-pipeline) [default: 64]" << endl;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool read_var_patterns(const string& spec, vector<string>& patterns)
+{
+    for(string item : split_patterns(spec)) {
+        item = trim(item);
+        if(item.empty()) continue;
+        if(item[0] != '@') {
+            patterns.push_back(item);
+            continue;
+        }
+        string profile = item.substr(1);
+        ifstream in(profile.c_str());
+        if(!in.good()) {
+            cout << "read_var_patterns    ERROR Unable to open variable profile '" << profile << "'" << endl;
+            return false;
+        }
+        string line;
+        while(getline(in, line)) {
+            size_t comment = line.find('#');
+            if(comment != string::npos) line = line.substr(0, comment);
+            line = trim(line);
+            if(!line.empty()) patterns.push_back(line);
+        }
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool read_tupler_options(int& argc, char* argv[], TuplerOptions& options, const string& ana_name)
+{
+    int n_kept = 1;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "--weight-array") {
+            options.weight_array = true;
+        }
+        else if(arg == "--weight-syst-array") {
+            options.weight_syst_array = true;
+        }
+        else if(arg == "--legacy-trigger-rng") {
+            options.legacy_trigger_rng = true;
+        }
+        else if(arg == "--shape-syst") {
+            options.shape_syst = true;
+        }
+        else if(arg == "--syst-workers") {
+            if(!read_int(argc, argv, i, options.syst_workers)) return false;
+        }
+        else if(arg == "--workers") {
+            if(!read_int(argc, argv, i, options.workers)) return false;
+        }
+        else if(arg == "--cpu-list") {
+            if(!read_string(argc, argv, i, options.cpu_list)) return false;
+            if(!parse_cpu_list(options.cpu_list, options.cpus)) {
+                cout << "read_tupler_options    ERROR Invalid --cpu-list '" << options.cpu_list << "'" << endl;
+                return false;
+            }
+        }
+        else if(arg == "--num-shards") {
+            if(!read_int(argc, argv, i, options.num_shards)) return false;
+        }
+        else if(arg == "--shard-index") {
+            if(!read_int(argc, argv, i, options.shard_index)) return false;
+        }
+        else if(arg == "--first-entry") {
+            if(!read_long(argc, argv, i, options.first_entry)) return false;
+        }
+        else if(arg == "--last-entry") {
+            if(!read_long(argc, argv, i, options.last_entry)) return false;
+        }
+        else if(arg == "--ordered-merge") {
+            options.ordered_merge = true;
+        }
+        else if(arg == "--static-split") {
+            options.static_split = true;
+        }
+        else if(arg == "--merge") {
+            options.merge_outputs = true;
+        }
+        else if(arg == "--queue-dir") {
+            if(!read_string(argc, argv, i, options.queue_dir)) return false;
+        }
+        else if(arg == "--queue-unit") {
+            if(!read_long(argc, argv, i, options.queue_unit)) return false;
+            if(options.queue_unit <= 0) {
+                cout << "read_tupler_options    ERROR Invalid --queue-unit " << options.queue_unit << endl;
+                return false;
+            }
+        }
+        else if(arg == "--queue-timeout") {
+            if(!read_double(argc, argv, i, options.queue_timeout)) return false;
+            if(options.queue_timeout <= 0) {
+                cout << "read_tupler_options    ERROR Invalid --queue-timeout " << options.queue_timeout << endl;
+                return false;
+            }
+        }
+        else if(arg == "--checkpoint") {
+            if(!read_long(argc, argv, i, options.checkpoint_entries)) return false;
+            if(options.checkpoint_entries <= 0) {
+                cout << "read_tupler_options    ERROR Invalid --checkpoint " << options.checkpoint_entries << endl;
+                return false;
+            }
+        }
+        else if(arg == "--checkpoint-file") {
+            if(!read_string(argc, argv, i, options.checkpoint_file)) return false;
+        }
+        else if(arg == "--resume") {
+            options.resume = true;
+        }
+        else if(arg == "--sample-list") {
+            if(!read_string(argc, argv, i, options.sample_list)) return false;
+        }
+        else if(arg == "--sample-jobs") {
+            if(!read_int(argc, argv, i, options.sample_jobs)) return false;
+            if(options.sample_jobs < 1) {
+                cout << "read_tupler_options    ERROR Invalid --sample-jobs " << options.sample_jobs << endl;
+                return false;
+            }
+        }
+        else if(arg == "--serve") {
+            if(!read_string(argc, argv, i, options.serve_socket)) return false;
+        }
+        else if(arg == "--syst-diff") {
+            options.syst_diff = true;
+        }
+        else if(arg == "--vars") {
+            string spec;
+            if(!read_string(argc, argv, i, spec)) return false;
+            if(!read_var_patterns(spec, options.var_patterns)) return false;
+            if(options.var_patterns.empty()) {
+                cout << "read_tupler_options    ERROR No variable patterns given with --vars" << endl;
+                return false;
+            }
+        }
+        else if(arg == "--timing") {
+            options.timing = true;
+        }
+        else if(arg == "--timing-json") {
+            if(!read_string(argc, argv, i, options.timing_json)) return false;
+            options.timing = true;
+        }
+        else if(arg == "--progress") {
+            if(!read_double(argc, argv, i, options.progress_interval)) return false;
+        }
+        else if(arg == "--progress-file") {
+            if(!read_string(argc, argv, i, options.progress_file)) return false;
+            if(options.progress_interval <= 0) options.progress_interval = 60;
+        }
+        else if(arg == "--stage-clock") {
+            options.stage_clock = true;
+        }
+        else if(arg == "--perf-counters") {
+            options.perf_counters = true;
+        }
+        else if(arg == "--alloc-audit") {
+            options.alloc_audit = true;
+        }
+        else if(arg == "--counter-warmup") {
+            if(!read_int(argc, argv, i, options.counter_warmup)) return false;
+            if(options.counter_warmup < 0) {
+                cout << "read_tupler_options    ERROR Invalid --counter-warmup " << options.counter_warmup << endl;
+                return false;
+            }
+        }
+        else if(arg == "--io-pipeline") {
+            options.io_pipeline = true;
+        }
+        else if(arg == "--io-threads") {
+            if(!read_int(argc, argv, i, options.io_threads)) return false;
+            if(options.io_threads < 0) {
+                cout << "read_tupler_options    ERROR Invalid --io-threads " << options.io_threads << endl;
+                return false;
+            }
+            options.io_pipeline = true;
+        }
+        else if(arg == "--read-ahead") {
+            if(!read_int(argc, argv, i, options.read_ahead_mb)) return false;
+            if(options.read_ahead_mb <= 0) {
+                cout << "read_tupler_options    ERROR Invalid --read-ahead " << options.read_ahead_mb << endl;
+                return false;
+            }
+            options.io_pipeline = true;
+        }
+        else {
+            if(arg == "-h" || arg == "--help") {
+                print_tupler_usage(ana_name);
+            }
+            // not ours, leave it for Superflow
+            argv[n_kept++] = argv[i];
+        }
+    }
+    argv[n_kept] = nullptr;
+    argc = n_kept;
+
+    bool by_shard = (options.num_shards > 0 || options.shard_index >= 0);
+    bool by_entry = (options.first_entry >= 0 || options.last_entry >= 0);
+    if(by_shard && by_entry) {
+        cout << "read_tupler_options    ERROR --num-shards/--shard-index can't be combined with --first-entry/--last-entry" << endl;
+        return false;
+    }
+    if(by_shard && (options.shard_index < 0 || options.shard_index >= options.num_shards)) {
+        cout << "read_tupler_options    ERROR --shard-index must be in [0, " << options.num_shards
+                << ") with --num-shards " << options.num_shards << endl;
+        return false;
+    }
+    if(by_entry && options.last_entry >= 0 && options.last_entry <= std::max(options.first_entry, 0LL)) {
+        cout << "read_tupler_options    ERROR Empty entry range [" << std::max(options.first_entry, 0LL)
+                << ", " << options.last_entry << ")" << endl;
+        return false;
+    }
+    if(options.queue_dir != "" && (by_shard || by_entry || options.workers > 1 || options.syst_workers > 1)) {
+        cout << "read_tupler_options    ERROR --queue-dir can't be combined with --workers, --syst-workers or sharding" << endl;
+        return false;
+    }
+    bool checkpointed = (options.checkpoint_entries > 0 || options.resume);
+    if(checkpointed && (options.queue_dir != "" || options.workers > 1 || options.syst_workers > 1)) {
+        cout << "read_tupler_options    ERROR --checkpoint/--resume can't be combined with --queue-dir, --workers or --syst-workers" << endl;
+        return false;
+    }
+    if(options.sample_list != "" && (by_shard || by_entry || checkpointed || options.queue_dir != ""
+                || options.workers > 1 || options.syst_workers > 1)) {
+        cout << "read_tupler_options    ERROR --sample-list can't be combined with --workers, --syst-workers,"
+                << " --queue-dir, --checkpoint or sharding" << endl;
+        return false;
+    }
+    if(options.legacy_trigger_rng && (by_shard || by_entry || checkpointed || options.queue_dir != "" || options.workers > 1)) {
+        cout << "read_tupler_options    ERROR --legacy-trigger-rng draws from one stream over the whole input, it can't be"
+                << " combined with --workers, --queue-dir, --checkpoint or sharding" << endl;
+        return false;
+    }
+    if(!options.cpus.empty() && options.workers <= 1 && options.syst_workers <= 1) {
+        cout << "read_tupler_options    ERROR --cpu-list needs --workers or --syst-workers" << endl;
+        return false;
+    }
+    if(options.serve_socket != "" && (options.sample_list != "" || by_shard || by_entry || checkpointed
+                || options.queue_dir != "" || options.workers > 1 || options.syst_workers > 1)) {
+        cout << "read_tupler_options    ERROR --serve can't be combined with --sample-list, --workers, --syst-workers,"
+                << " --queue-dir, --checkpoint or sharding" << endl;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool read_sample_list(const string& filename, vector<string>& samples)
+{
+    ifstream in(filename.c_str());
+    if(!in.good()) {
+        cout << "read_sample_list    ERROR Unable to open sample list '" << filename << "'" << endl;
+        return false;
+    }
+    string line;
+    while(getline(in, line)) {
+        size_t comment = line.find('#');
+        if(comment != string::npos) line = line.substr(0, comment);
+        line = trim(line);
+        if(!line.empty()) samples.push_back(line);
+    }
+    if(samples.empty()) {
+        cout << "read_sample_list    ERROR No samples in '" << filename << "'" << endl;
+        return false;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool is_sharded(const TuplerOptions& options)
+{
+    return options.num_shards > 0 || options.first_entry >= 0 || options.last_entry >= 0;
+}
+//////////////////////////////////////////////////////////////////////////////
+string shard_tag(const TuplerOptions& options)
+{
+    stringstream tag;
+    if(options.num_shards > 0) {
+        tag << "shard" << options.shard_index << "of" << options.num_shards;
+    }
+    else {
+        tag << "entries" << std::max(options.first_entry, 0LL) << "to";
+        if(options.last_entry >= 0) tag << options.last_entry;
+        else { tag << "end"; }
+    }
+    return tag.str();
+}
+
+} // namespace rjt
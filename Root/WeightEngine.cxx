@@ -0,0 +1,48 @@
+#include "RJTupler/WeightEngine.h"
+
+// std
+#include <iostream>
+#include <cstdlib>
+
+namespace rjt {
+
+WeightEngine::WeightEngine()
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+size_t WeightEngine::add(const std::string& name, unsigned factors)
+{
+    if(index(name) >= 0) {
+        std::cout << "WeightEngine::add    ERROR Weight variant '" << name
+                << "' declared more than once" << std::endl;
+        exit(1);
+    }
+    m_specs.push_back(WeightSpec(name, factors));
+    m_values.push_back(0.0);
+    return m_specs.size() - 1;
+}
+//////////////////////////////////////////////////////////////////////////////
+int WeightEngine::index(const std::string& name) const
+{
+    for(size_t i = 0; i < m_specs.size(); i++) {
+        if(m_specs[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+//////////////////////////////////////////////////////////////////////////////
+void WeightEngine::compute(const WeightFactors& f)
+{
+    // the factors are applied in a fixed order (base, pileup, btag, jvt) so
+    // that each variant is bitwise identical to the explicit product
+    m_factors = f;
+    for(size_t i = 0; i < m_specs.size(); i++) {
+        const unsigned mask = m_specs[i].factors;
+        double w = (mask & wf::Multi) ? f.product_multi : f.product;
+        if(mask & wf::Pileup) w *= f.pileup;
+        if(mask & wf::Btag) w *= f.btag;
+        if(mask & wf::Jvt) w *= f.jvt;
+        m_values[i] = w;
+    }
+}
+
+} // namespace rjt
@@ -0,0 +1,49 @@
+#include "RJTupler/WeightVariations.h"
+
+// std
+#include <iostream>
+#include <cstdlib>
+
+namespace rjt {
+
+WeightVariations::WeightVariations()
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+void WeightVariations::add(const std::string& name, size_t base, RatioFunction up, RatioFunction down)
+{
+    for(size_t i = 0; i < m_names.size(); i++) {
+        if(m_names[i] == name) {
+            std::cout << "WeightVariations::add    ERROR Weight systematic '" << name
+                    << "' declared more than once" << std::endl;
+            exit(1);
+        }
+    }
+    m_names.push_back(name);
+    m_base.push_back(base);
+    m_up.push_back(up);
+    m_down.push_back(down);
+    m_values.resize(2 * m_names.size(), 0.0);
+}
+//////////////////////////////////////////////////////////////////////////////
+std::vector<std::string> WeightVariations::entry_names() const
+{
+    std::vector<std::string> out;
+    out.reserve(2 * m_names.size());
+    for(size_t i = 0; i < m_names.size(); i++) {
+        out.push_back(m_names[i] + "_UP");
+        out.push_back(m_names[i] + "_DN");
+    }
+    return out;
+}
+//////////////////////////////////////////////////////////////////////////////
+void WeightVariations::compute(sflow::Superlink* sl, const std::vector<double>& base_weights)
+{
+    for(size_t i = 0; i < m_names.size(); i++) {
+        const double base_weight = base_weights[m_base[i]];
+        m_values[2*i]     = base_weight * m_up[i](sl);
+        m_values[2*i + 1] = base_weight * m_down[i](sl);
+    }
+}
+
+} // namespace rjt
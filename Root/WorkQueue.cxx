@@ -0,0 +1,281 @@
+#include "RJTupler/WorkQueue.h"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+
+// posix
+#include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <utime.h>
+
+// ROOT
+#include "TChain.h"
+#include "TTree.h"
+#include "TFile.h"
+
+using namespace std;
+
+namespace rjt {
+
+static const char* states[] = { "todo", "claimed", "done", "failed" };
+
+// unit files are key/value lines
+static bool write_unit(const string& filename, const WorkUnit& unit)
+{
+    ofstream out(filename.c_str());
+    out << "file " << unit.file << "\n";
+    out << "offset " << unit.offset << "\n";
+    out << "first " << unit.first << "\n";
+    out << "last " << unit.last << "\n";
+    out << "attempts " << unit.attempts << "\n";
+    out.close();
+    return !out.fail();
+}
+static bool read_unit(const string& filename, WorkUnit& unit)
+{
+    ifstream in(filename.c_str());
+    if(!in.good()) return false;
+    string key;
+    while(in >> key) {
+        if(key == "file") { in >> ws; getline(in, unit.file); }
+        else if(key == "offset") in >> unit.offset;
+        else if(key == "first") in >> unit.first;
+        else if(key == "last") in >> unit.last;
+        else if(key == "attempts") in >> unit.attempts;
+        else { string rest; getline(in, rest); }
+    }
+    return unit.file != "" && unit.last > unit.first;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<WorkUnit> make_work_units(TChain* chain, Long64_t n_entries, Long64_t unit_entries)
+{
+    vector<WorkUnit> units;
+    Long64_t total = chain->GetEntries();
+    if(n_entries < 0 || n_entries > total) n_entries = total;
+    if(unit_entries < 1) unit_entries = 1;
+
+    Long64_t entry = 0;
+    while(entry < n_entries) {
+        Long64_t local = chain->LoadTree(entry);
+        if(local < 0) break;
+        TTree* tree = chain->GetTree();
+        Long64_t offset = entry - local;
+        Long64_t tree_entries = std::min(tree->GetEntries(), n_entries - offset);
+        string file = chain->GetCurrentFile()->GetName();
+
+        // whole clusters, up to about unit_entries per unit
+        TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+        Long64_t start = clusters();
+        Long64_t unit_first = start;
+        while(start < tree_entries) {
+            Long64_t end = std::min(clusters.GetNextEntry(), tree_entries);
+            if(end - unit_first >= unit_entries || end >= tree_entries) {
+                WorkUnit unit;
+                unit.file = file;
+                unit.offset = offset;
+                unit.first = unit_first;
+                unit.last = end;
+                units.push_back(unit);
+                unit_first = end;
+            }
+            start = clusters();
+        }
+        entry = offset + std::max<Long64_t>(tree->GetEntries(), 1);
+    }
+    for(size_t iu = 0; iu < units.size(); iu++) {
+        stringstream id;
+        id << "unit" << setw(6) << setfill('0') << iu;
+        units[iu].id = id.str();
+    }
+    return units;
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<EntryRange> unit_ranges(TChain* chain, const WorkUnit& unit, const string& label)
+{
+    vector<EntryRange> ranges;
+    Long64_t local = chain->LoadTree(unit.offset + unit.first);
+    if(local != unit.first || !chain->GetCurrentFile() || unit.file != chain->GetCurrentFile()->GetName()) {
+        cout << label << "    ERROR Entry " << unit.offset + unit.first << " of the input is not entry "
+                << unit.first << " of " << unit.file << ", the queue was made from another input" << endl;
+        return ranges;
+    }
+    TTree::TClusterIterator clusters = chain->GetTree()->GetClusterIterator(unit.first);
+    Long64_t start = clusters();
+    while(start < unit.last) {
+        Long64_t end = std::min(clusters.GetNextEntry(), unit.last);
+        ranges.push_back(EntryRange(unit.offset + start, unit.offset + end));
+        start = clusters();
+    }
+    return ranges;
+}
+//////////////////////////////////////////////////////////////////////////////
+WorkQueue::WorkQueue(const string& dir, double timeout_seconds, const string& label) :
+    m_dir(dir),
+    m_timeout(timeout_seconds),
+    m_label(label)
+{
+    char host[256];
+    if(gethostname(host, sizeof(host)) != 0) strcpy(host, "unknown");
+    host[sizeof(host) - 1] = '\0';
+    m_host = host;
+    stringstream owner;
+    owner << m_host << "@" << getpid();
+    m_owner = owner.str();
+}
+//////////////////////////////////////////////////////////////////////////////
+string WorkQueue::path(const string& state, const string& name) const
+{
+    return m_dir + "/" + state + (name == "" ? "" : "/" + name);
+}
+//////////////////////////////////////////////////////////////////////////////
+vector<string> WorkQueue::list(const string& state) const
+{
+    vector<string> names;
+    DIR* dir = opendir(path(state).c_str());
+    if(!dir) return names;
+    while(struct dirent* entry = readdir(dir)) {
+        string name = entry->d_name;
+        if(name == "." || name == "..") continue;
+        names.push_back(name);
+    }
+    closedir(dir);
+    sort(names.begin(), names.end());
+    return names;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkQueue::exists() const
+{
+    struct stat info;
+    return stat(path("todo").c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkQueue::create(const vector<WorkUnit>& units)
+{
+    // built privately, then renamed into place in one step
+    string staging = m_dir + ".staging." + m_owner;
+    bool ok = (mkdir(staging.c_str(), 0775) == 0);
+    for(const char* state : states) {
+        ok = ok && (mkdir((staging + "/" + state).c_str(), 0775) == 0);
+    }
+    for(const WorkUnit& unit : units) {
+        ok = ok && write_unit(staging + "/todo/" + unit.id, unit);
+    }
+    if(ok && rename(staging.c_str(), m_dir.c_str()) == 0) {
+        cout << m_label << "    Created work queue " << m_dir << " with " << units.size() << " units" << endl;
+        return true;
+    }
+    int error = errno;
+
+    // clean up, then see whether another process got there first
+    for(const WorkUnit& unit : units) remove((staging + "/todo/" + unit.id).c_str());
+    for(const char* state : states) rmdir((staging + "/" + state).c_str());
+    rmdir(staging.c_str());
+    if(exists()) return true;
+    cout << m_label << "    ERROR Unable to create work queue " << m_dir << ": " << strerror(error) << endl;
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkQueue::take(const string& name, WorkUnit& unit)
+{
+    string claim = path("claimed", name + "@" + m_owner);
+    if(rename(path("todo", name).c_str(), claim.c_str()) != 0) return false;
+    // the claim's age counts from now
+    utime(claim.c_str(), nullptr);
+    unit = WorkUnit();
+    if(!read_unit(claim, unit)) {
+        cout << m_label << "    ERROR Unreadable work unit " << name << ", parking it in failed/" << endl;
+        rename(claim.c_str(), path("failed", name).c_str());
+        return false;
+    }
+    unit.id = name;
+    unit.claim = claim;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+int WorkQueue::reissue_stale(int& n_live)
+{
+    int n_reissued = 0;
+    n_live = 0;
+    time_t now = time(nullptr);
+    for(const string& claim : list("claimed")) {
+        // <unit>@<host>@<pid>
+        size_t at_host = claim.find('@');
+        size_t at_pid = claim.rfind('@');
+        if(at_host == string::npos || at_pid == at_host) continue;
+        string name = claim.substr(0, at_host);
+        string host = claim.substr(at_host + 1, at_pid - at_host - 1);
+        int pid = atoi(claim.substr(at_pid + 1).c_str());
+
+        bool dead = (host == m_host && pid > 0 && kill(pid, 0) != 0 && errno == ESRCH);
+        struct stat info;
+        if(stat(path("claimed", claim).c_str(), &info) != 0) continue; // completed meanwhile
+        bool stalled = (difftime(now, info.st_mtime) > m_timeout);
+        if(!dead && !stalled) {
+            n_live++;
+            continue;
+        }
+        if(rename(path("claimed", claim).c_str(), path("todo", name).c_str()) == 0) {
+            cout << m_label << "    Re-issuing " << name << " held by " << host << ":" << pid
+                    << (dead ? " (process gone)" : " (no heartbeat)") << endl;
+            n_reissued++;
+        }
+    }
+    return n_reissued;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkQueue::claim(WorkUnit& unit)
+{
+    // poll while other workers still hold units, in case they fail
+    unsigned int poll = static_cast<unsigned int>(std::max(1.0, std::min(m_timeout / 4, 30.0)));
+    while(true) {
+        for(const string& name : list("todo")) {
+            if(take(name, unit)) return true;
+        }
+        int n_live = 0;
+        if(reissue_stale(n_live) > 0) continue;
+        if(n_live == 0) return false;
+        sleep(poll);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void WorkQueue::heartbeat(const WorkUnit& unit) const
+{
+    if(unit.claim != "") utime(unit.claim.c_str(), nullptr);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkQueue::complete(const WorkUnit& unit)
+{
+    return rename(unit.claim.c_str(), path("done", unit.id).c_str()) == 0;
+}
+//////////////////////////////////////////////////////////////////////////////
+void WorkQueue::release(WorkUnit& unit, int max_attempts)
+{
+    unit.attempts++;
+    // the claim file is rewritten in place, it is still ours
+    if(!write_unit(unit.claim, unit)) return;
+    string state = (unit.attempts >= max_attempts ? "failed" : "todo");
+    if(rename(unit.claim.c_str(), path(state, unit.id).c_str()) == 0 && state == "failed") {
+        cout << m_label << "    ERROR Work unit " << unit.id << " failed " << unit.attempts
+                << " times, parked in " << path("failed") << endl;
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void WorkQueue::print_status(ostream& out) const
+{
+    out << m_label << "    Work queue " << m_dir << ":";
+    for(const char* state : states) out << " " << list(state).size() << " " << state;
+    out << endl;
+}
+
+} // namespace rjt
@@ -0,0 +1,142 @@
+#include "RJTupler/WorkStealingQueue.h"
+
+// std
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <cstring>
+#include <cerrno>
+
+// posix
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace rjt {
+
+static uint64_t pack_run(uint64_t head, uint64_t tail) { return (tail << 32) | head; }
+static uint64_t run_head(uint64_t run) { return run & 0xffffffffu; }
+static uint64_t run_tail(uint64_t run) { return run >> 32; }
+
+WorkStealingQueue::WorkStealingQueue(const vector<EntryRange>& ranges, int n_workers, bool stealing) :
+    m_n_workers(n_workers > 0 ? n_workers : 1),
+    m_stealing(stealing),
+    m_n_ranges(ranges.size()),
+    m_bytes(0),
+    m_shared(nullptr),
+    m_slots(nullptr),
+    m_ranges(nullptr)
+{
+    if(m_n_ranges >= 0xffffffffu) {
+        cout << "WorkStealingQueue    ERROR Too many entry ranges (" << m_n_ranges << ")" << endl;
+        return;
+    }
+
+    // anonymous shared memory is inherited by the forked workers
+    m_bytes = m_n_workers * sizeof(Slot) + m_n_ranges * sizeof(EntryRange);
+    void* memory = mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED) {
+        cout << "WorkStealingQueue    ERROR Unable to map " << m_bytes << " bytes of shared memory: "
+                << strerror(errno) << endl;
+        return;
+    }
+    m_shared = memory;
+    m_slots = static_cast<Slot*>(memory);
+    m_ranges = reinterpret_cast<EntryRange*>(m_slots + m_n_workers);
+    for(size_t ir = 0; ir < m_n_ranges; ir++) new (m_ranges + ir) EntryRange(ranges[ir]);
+
+    // deal out contiguous runs of about equal numbers of entries
+    vector<size_t> firsts = split_ranges(ranges, m_n_workers);
+    for(int iw = 0; iw < m_n_workers; iw++) {
+        Slot* slot = new (m_slots + iw) Slot();
+        slot->run.store(pack_run(firsts[iw], firsts[iw + 1]));
+        slot->n_ranges.store(0);
+        slot->n_stolen.store(0);
+        slot->n_entries.store(0);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+WorkStealingQueue::~WorkStealingQueue()
+{
+    if(m_shared) munmap(m_shared, m_bytes);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkStealingQueue::take_front(int worker, EntryRange& range)
+{
+    std::atomic<uint64_t>& run = m_slots[worker].run;
+    uint64_t current = run.load();
+    while(run_head(current) < run_tail(current)) {
+        uint64_t head = run_head(current);
+        if(run.compare_exchange_weak(current, pack_run(head + 1, run_tail(current)))) {
+            range = m_ranges[head];
+            return true;
+        }
+    }
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkStealingQueue::steal_back(int victim, EntryRange& range)
+{
+    std::atomic<uint64_t>& run = m_slots[victim].run;
+    uint64_t current = run.load();
+    while(run_head(current) < run_tail(current)) {
+        uint64_t tail = run_tail(current) - 1;
+        if(run.compare_exchange_weak(current, pack_run(run_head(current), tail))) {
+            range = m_ranges[tail];
+            return true;
+        }
+    }
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////
+void WorkStealingQueue::count(int worker, const EntryRange& range, bool stolen)
+{
+    Slot& slot = m_slots[worker];
+    slot.n_ranges.fetch_add(1, std::memory_order_relaxed);
+    slot.n_entries.fetch_add(range.size(), std::memory_order_relaxed);
+    if(stolen) slot.n_stolen.fetch_add(1, std::memory_order_relaxed);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool WorkStealingQueue::next(int worker, EntryRange& range)
+{
+    if(!m_shared || worker < 0 || worker >= m_n_workers) return false;
+    if(take_front(worker, range)) {
+        count(worker, range, false);
+        return true;
+    }
+    if(!m_stealing) return false;
+    while(true) {
+        // the victim is the worker with the most ranges left
+        int victim = -1;
+        uint64_t most = 0;
+        for(int iw = 0; iw < m_n_workers; iw++) {
+            if(iw == worker) continue;
+            uint64_t run = m_slots[iw].run.load();
+            uint64_t left = run_tail(run) - run_head(run);
+            if(left > most) {
+                most = left;
+                victim = iw;
+            }
+        }
+        if(victim < 0) return false;
+        if(steal_back(victim, range)) {
+            count(worker, range, true);
+            return true;
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+void WorkStealingQueue::print_report(ostream& out, const string& label) const
+{
+    if(!m_shared) return;
+    out << label << "    Entry ranges per worker (" << m_n_ranges << " cluster ranges):" << endl;
+    out << label << "      " << setw(8) << "worker" << setw(10) << "ranges" << setw(10) << "stolen"
+            << setw(14) << "entries" << endl;
+    for(int iw = 0; iw < m_n_workers; iw++) {
+        const Slot& slot = m_slots[iw];
+        out << label << "      " << setw(8) << iw << setw(10) << slot.n_ranges.load()
+                << setw(10) << slot.n_stolen.load() << setw(14) << slot.n_entries.load() << endl;
+    }
+}
+
+} // namespace rjt
@@ -0,0 +1,114 @@
+#include "RJTupler/WorkerPool.h"
+
+// std
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+// posix
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+namespace rjt {
+
+// anything still buffered would otherwise be printed by every worker
+static void flush_output()
+{
+    cout.flush();
+    cerr.flush();
+    fflush(stdout);
+    fflush(stderr);
+}
+// fork a child running body(index), returns its pid (-1 if the fork failed)
+static pid_t spawn(int index, const function<int(int)>& body, const string& label)
+{
+    pid_t pid = fork();
+    if(pid < 0) {
+        cout << label << "    ERROR Unable to fork worker " << index << ": " << strerror(errno) << endl;
+        return -1;
+    }
+    if(pid == 0) {
+        int status = body(index);
+        flush_output();
+        _exit(status);
+    }
+    return pid;
+}
+// report a worker that did not exit cleanly, returns false for those
+static bool exited_ok(pid_t pid, int status, const string& label)
+{
+    if(WIFEXITED(status) && WEXITSTATUS(status) == 0) return true;
+    if(WIFSIGNALED(status)) {
+        cout << label << "    ERROR Worker process " << pid << " killed by signal " << WTERMSIG(status) << endl;
+    }
+    else {
+        cout << label << "    ERROR Worker process " << pid << " exited with status " << WEXITSTATUS(status) << endl;
+    }
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////
+int run_forked(int n_workers, const function<int(int)>& body, const string& label)
+{
+    flush_output();
+
+    int n_failed = 0;
+    vector<pid_t> pids;
+    for(int iw = 0; iw < n_workers; iw++) {
+        pid_t pid = spawn(iw, body, label);
+        if(pid < 0) {
+            n_failed++;
+            continue;
+        }
+        pids.push_back(pid);
+    }
+
+    for(size_t ip = 0; ip < pids.size(); ip++) {
+        int status = 0;
+        while(waitpid(pids[ip], &status, 0) < 0) {
+            if(errno != EINTR) break;
+        }
+        if(!exited_ok(pids[ip], status, label)) n_failed++;
+    }
+    return n_failed;
+}
+//////////////////////////////////////////////////////////////////////////////
+int run_forked_pool(int n_tasks, int n_parallel, const function<int(int)>& body, const string& label)
+{
+    if(n_parallel < 1) n_parallel = 1;
+
+    int n_failed = 0;
+    int next_task = 0;
+    vector<pid_t> running;
+    while(next_task < n_tasks || !running.empty()) {
+        while(next_task < n_tasks && (int)running.size() < n_parallel) {
+            flush_output();
+            pid_t pid = spawn(next_task++, body, label);
+            if(pid < 0) n_failed++;
+            else { running.push_back(pid); }
+        }
+        if(running.empty()) continue;
+
+        // wait for whichever of ours finishes first
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if(pid < 0) {
+            if(errno == EINTR) continue;
+            cout << label << "    ERROR Lost track of " << running.size() << " worker(s): " << strerror(errno) << endl;
+            n_failed += running.size();
+            break;
+        }
+        vector<pid_t>::iterator it = find(running.begin(), running.end(), pid);
+        if(it == running.end()) continue;
+        running.erase(it);
+        if(!exited_ok(pid, status, label)) n_failed++;
+    }
+    return n_failed;
+}
+
+} // namespace rjt
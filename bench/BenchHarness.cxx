@@ -0,0 +1,122 @@
+#include "BenchHarness.h"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <regex>
+#include <cstdlib>
+
+using namespace std;
+
+namespace rjt {
+namespace bench {
+
+struct Registered {
+    string name;
+    BenchFunction function;
+};
+
+static vector<Registered>& registry()
+{
+    static vector<Registered> benchmarks;
+    return benchmarks;
+}
+//////////////////////////////////////////////////////////////////////////////
+int register_benchmark(const string& name, BenchFunction function)
+{
+    registry().push_back(Registered{name, function});
+    return static_cast<int>(registry().size()) - 1;
+}
+//////////////////////////////////////////////////////////////////////////////
+struct Result {
+    string name;
+    uint64_t iterations;
+    double ns_per_iteration;
+    double items_per_second;
+};
+//////////////////////////////////////////////////////////////////////////////
+static Result run_one(const Registered& bench, double min_time)
+{
+    // grow the iteration count until a run is long enough to trust, aiming
+    // the next run at 1.4x the minimum time from the last one's speed
+    uint64_t n = 1;
+    while(true) {
+        State state(n);
+        bench.function(state);
+        double seconds = state.seconds();
+        if(seconds >= min_time || n >= (uint64_t(1) << 40)) {
+            Result result;
+            result.name = bench.name;
+            result.iterations = state.iterations();
+            result.ns_per_iteration = (state.iterations() ? 1e9 * seconds / state.iterations() : 0.);
+            result.items_per_second = (seconds > 0 ? state.items() / seconds : 0.);
+            return result;
+        }
+        double scale = (seconds > 0 ? 1.4 * min_time / seconds : 100.);
+        if(scale > 100.) scale = 100.;
+        uint64_t next = static_cast<uint64_t>(n * scale);
+        n = (next > n ? next : n + 1);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////
+int run_benchmarks(int argc, char* argv[])
+{
+    string filter = ".*";
+    string json_file = "";
+    double min_time = 0.5;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "--filter" && i + 1 < argc)        filter = argv[++i];
+        else if(arg == "--json" && i + 1 < argc)     json_file = argv[++i];
+        else if(arg == "--min-time" && i + 1 < argc) min_time = atof(argv[++i]);
+        else {
+            cout << argv[0] << "    Options:" << endl;
+            cout << "    --filter <regex>   run only the benchmarks whose name matches" << endl;
+            cout << "    --min-time <s>     minimum time per benchmark [default: 0.5]" << endl;
+            cout << "    --json <file>      also write the results as JSON" << endl;
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+
+    regex pattern;
+    try {
+        pattern = regex(filter);
+    }
+    catch(const regex_error& e) {
+        cout << argv[0] << "    ERROR Invalid --filter '" << filter << "': " << e.what() << endl;
+        return 1;
+    }
+
+    vector<Result> results;
+    cout << left << setw(40) << "benchmark" << right << setw(14) << "ns/iter"
+         << setw(14) << "iterations" << setw(16) << "items/s" << endl;
+    for(const auto& bench : registry()) {
+        if(!regex_search(bench.name, pattern)) continue;
+        Result result = run_one(bench, min_time);
+        results.push_back(result);
+        cout << left << setw(40) << result.name << right << fixed << setprecision(1)
+             << setw(14) << result.ns_per_iteration << setw(14) << result.iterations
+             << setw(16) << setprecision(0) << result.items_per_second << endl;
+    }
+
+    if(json_file != "") {
+        ofstream out(json_file);
+        if(!out) {
+            cout << argv[0] << "    ERROR Unable to open JSON output " << json_file << endl;
+            return 1;
+        }
+        out << "{\"benchmarks\": [" << endl;
+        for(size_t i = 0; i < results.size(); i++) {
+            out << "  {\"name\": \"" << results[i].name << "\", \"iterations\": " << results[i].iterations
+                << ", \"ns_per_iteration\": " << results[i].ns_per_iteration
+                << ", \"items_per_second\": " << results[i].items_per_second << "}"
+                << (i + 1 < results.size() ? "," : "") << endl;
+        }
+        out << "]}" << endl;
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace rjt
@@ -0,0 +1,109 @@
+#ifndef RJTupler_BenchHarness_h
+#define RJTupler_BenchHarness_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// BenchHarness
+//
+// A small microbenchmark harness in the style of Google Benchmark, kept
+// in-tree so that the benchmarks build wherever the ntupler builds:
+//
+//      static void BM_something(rjt::bench::State& state)
+//      {
+//          // setup, not timed
+//          while(state.keep_running()) {
+//              rjt::bench::do_not_optimize(compute());
+//          }
+//      }
+//      RJT_BENCHMARK(BM_something);
+//
+// The iteration count of each benchmark is grown until a run takes at
+// least --min-time seconds, and the time per iteration of that run is
+// reported. run_benchmarks() reads --filter <regex>, --min-time <s> and
+// --json <file> from the command line.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+namespace rjt {
+namespace bench {
+
+    class State {
+
+        public :
+            explicit State(uint64_t max_iterations) :
+                m_max(max_iterations),
+                m_done(0),
+                m_items(0),
+                m_started(false)
+            {
+            }
+
+            // true while iterations remain, the clock runs from the first call
+            bool keep_running()
+            {
+                if(!m_started) {
+                    m_started = true;
+                    m_start = std::chrono::steady_clock::now();
+                }
+                if(m_done < m_max) { m_done++; return true; }
+                m_stop = std::chrono::steady_clock::now();
+                return false;
+            }
+
+            // number of items (events, objects, ...) processed in total, used
+            // for the items/s column
+            void set_items_processed(uint64_t items) { m_items = items; }
+
+            uint64_t iterations() const { return m_done; }
+            uint64_t items() const { return m_items; }
+            double seconds() const
+            {
+                return std::chrono::duration<double>(m_stop - m_start).count();
+            }
+
+        private :
+            uint64_t m_max;
+            uint64_t m_done;
+            uint64_t m_items;
+            bool m_started;
+            std::chrono::steady_clock::time_point m_start;
+            std::chrono::steady_clock::time_point m_stop;
+    };
+
+    typedef void (*BenchFunction)(State&);
+
+    // register a benchmark, returns its index (used by RJT_BENCHMARK)
+    int register_benchmark(const std::string& name, BenchFunction function);
+
+    // run the registered benchmarks matching the command line filter,
+    // returns the process exit code
+    int run_benchmarks(int argc, char* argv[]);
+
+    // keep the compiler from discarding a computed value
+    template <class T>
+    inline void do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline void clobber_memory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+} // namespace bench
+} // namespace rjt
+
+#define RJT_BENCHMARK_CONCAT_(a, b) a##b
+#define RJT_BENCHMARK_CONCAT(a, b) RJT_BENCHMARK_CONCAT_(a, b)
+#define RJT_BENCHMARK(function) \
+    static int RJT_BENCHMARK_CONCAT(rjt_benchmark_, __LINE__) = \
+        rjt::bench::register_benchmark(#function, function)
+
+#endif
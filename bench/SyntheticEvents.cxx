@@ -0,0 +1,256 @@
+#include "SyntheticEvents.h"
+
+// std
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// ROOT
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1F.h"
+
+// SusyNtuple
+#include "SusyNtuple/SusyNtObject.h"
+#include "SusyNtuple/SusyNtSys.h"
+
+using namespace std;
+
+namespace rjt {
+namespace bench {
+
+SyntheticConfig::SyntheticConfig() :
+    min_leptons(2),
+    max_leptons(2),
+    electron_fraction(0.5),
+    mean_jets(3.0),
+    bjet_fraction(0.25),
+    met_scale(60.),
+    trigger_fraction(0.3),
+    seed(12345)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+const vector<string>& trigger_names()
+{
+    static const vector<string> names = {
+        "HLT_mu8noL1", "HLT_mu10noL1", "HLT_mu12noL1", "HLT_mu10", "HLT_mu14", "HLT_mu18",
+        "HLT_mu20", "HLT_mu24", "HLT_mu26", "HLT_mu28", "HLT_mu20_iloose_L1MU15",
+        "HLT_mu20_ivarloose_L1MU15", "HLT_mu22", "HLT_mu24_ivarmedium", "HLT_mu24_imedium",
+        "HLT_mu24_ivarloose", "HLT_mu24_ivarloose_L1MU15", "HLT_mu26_ivarmedium",
+        "HLT_mu26_imedium", "HLT_mu28_ivarmedium", "HLT_mu40", "HLT_mu50", "HLT_mu60",
+        "HLT_mu60_0eta105_msonly", "HLT_mu18_mu8noL1", "HLT_mu20_mu8noL1", "HLT_mu22_mu8noL1",
+        "HLT_mu24_mu8noL1", "HLT_mu24_mu10noL1", "HLT_mu24_mu12noL1", "HLT_mu26_mu8noL1",
+        "HLT_mu26_mu10noL1", "HLT_mu28_mu8noL1", "HLT_e24_lhmedium_L1EM20VH",
+        "HLT_e24_lhmedium_L1EM20VHI", "HLT_e24_lhtight_nod0_ivarloose",
+        "HLT_e26_lhtight_nod0_ivarloose", "HLT_e28_lhtight_nod0_noringer_ivarloose",
+        "HLT_e28_lhtight_nod0_ivarloose", "HLT_e32_lhtight_nod0_ivarloose", "HLT_e60_lhmedium",
+        "HLT_e60_lhmedium_nod0", "HLT_e60_lhmedium_nod0_L1EM24VHI",
+        "HLT_e80_lhmedium_nod0_L1EM24VHI", "HLT_e120_lhloose", "HLT_e140_lhloose_nod0",
+        "HLT_e140_lhloose_nod0_L1EM24VHI", "HLT_e300_etcut", "HLT_e300_etcut_L1EM24VHI",
+        "HLT_2e12_lhloose_L12EM10VH", "HLT_2e15_lhvloose_nod0_L12EM13VH", "HLT_2e17_lhvloose_nod0",
+        "HLT_2e17_lhvloose_nod0_L12EM15VHI", "HLT_2e19_lhvloose_nod0", "HLT_2e24_lhvloose_nod0",
+        "HLT_e7_lhmedium_nod0_mu24", "HLT_e7_lhmedium_mu24", "HLT_e17_lhloose_mu14",
+        "HLT_e17_lhloose_nod0_mu14", "HLT_e24_lhmedium_nod0_L1EM20VHI_mu8noL1",
+        "HLT_e24_lhmedium_L1EM20VHI_mu8noL1", "HLT_e26_lhmedium_nod0_L1EM22VHI_mu8noL1",
+        "HLT_e26_lhmedium_nod0_mu8noL1", "HLT_e28_lhmedium_nod0_mu8noL1"
+    };
+    return names;
+}
+//////////////////////////////////////////////////////////////////////////////
+SyntheticEvents::SyntheticEvents(const SyntheticConfig& config) :
+    run(300000),
+    event_number(0),
+    m_config(config),
+    m_rng(config.seed)
+{
+}
+//////////////////////////////////////////////////////////////////////////////
+double SyntheticEvents::uniform(double lo, double hi)
+{
+    return uniform_real_distribution<double>(lo, hi)(m_rng);
+}
+//////////////////////////////////////////////////////////////////////////////
+double SyntheticEvents::exponential(double scale)
+{
+    return exponential_distribution<double>(1.0 / scale)(m_rng);
+}
+//////////////////////////////////////////////////////////////////////////////
+void SyntheticEvents::set_kinematics(Susy::Particle& p, double pt_scale, double pt_min,
+        double eta_max, double m)
+{
+    p.pt = pt_min + exponential(pt_scale);
+    p.eta = uniform(-eta_max, eta_max);
+    p.phi = uniform(-M_PI, M_PI);
+    p.m = m;
+    p.resetTLV();
+}
+//////////////////////////////////////////////////////////////////////////////
+void SyntheticEvents::set_isolation(Susy::Lepton& l)
+{
+    // every lepton passes the identification and isolation working points,
+    // so that the object selection keeps the multiplicities generated
+    l.isoGradientLoose = l.isoGradient = l.isoLooseTrackOnly = l.isoLoose = true;
+    l.isoFixedCutTightTrackOnly = true;
+    l.ptcone20 = exponential(1.);
+    l.ptcone30 = exponential(1.5);
+    l.ptvarcone20 = exponential(1.);
+    l.ptvarcone30 = exponential(1.5);
+    l.topoetcone20 = exponential(1.);
+    l.topoetcone30 = exponential(1.5);
+}
+//////////////////////////////////////////////////////////////////////////////
+void SyntheticEvents::next()
+{
+    event_number++;
+
+    electrons.clear();
+    muons.clear();
+    jets.clear();
+
+    int n_leptons = uniform_int_distribution<int>(m_config.min_leptons, m_config.max_leptons)(m_rng);
+    for(int il = 0; il < n_leptons; il++) {
+        int q = (uniform(0., 1.) < 0.5 ? 1 : -1);
+        if(uniform(0., 1.) < m_config.electron_fraction) {
+            Susy::Electron e;
+            set_kinematics(e, 40., 10., 2.47, 0.000511);
+            e.q = q;
+            e.clusEta = e.eta;
+            e.looseLLH = e.looseLLHBLayer = e.mediumLLH = e.tightLLH = true;
+            set_isolation(e);
+            e.d0 = uniform(-0.05, 0.05);
+            e.d0sigBSCorr = uniform(-4., 4.);
+            e.z0SinTheta = uniform(-0.4, 0.4);
+            electrons.push_back(e);
+        }
+        else {
+            Susy::Muon mu;
+            set_kinematics(mu, 40., 10., 2.4, 0.10566);
+            mu.q = q;
+            mu.loose = mu.medium = mu.tight = true;
+            set_isolation(mu);
+            mu.d0 = uniform(-0.05, 0.05);
+            mu.d0sigBSCorr = uniform(-3., 3.);
+            mu.z0SinTheta = uniform(-0.4, 0.4);
+            muons.push_back(mu);
+        }
+    }
+
+    int n_jets = poisson_distribution<int>(m_config.mean_jets)(m_rng);
+    for(int ij = 0; ij < n_jets; ij++) {
+        Susy::Jet j;
+        set_kinematics(j, 50., 20., 2.8, uniform(2., 15.));
+        bool btag = (fabs(j.eta) < 2.5 && uniform(0., 1.) < m_config.bjet_fraction);
+        j.mv2c10 = (btag ? uniform(0.83, 1.) : uniform(-1., 0.5));
+        j.jvt = uniform(0.6, 1.);
+        j.nTracks = poisson_distribution<int>(8.)(m_rng);
+        j.sumTrkPt = exponential(0.5 * j.pt);
+        j.emfrac = uniform(0.05, 0.95);
+        jets.push_back(j);
+    }
+
+    met.Et = exponential(m_config.met_scale);
+    met.phi = uniform(-M_PI, M_PI);
+    met.sumet = met.Et + exponential(300.);
+    met.sys = NtSys::NOM;
+
+    trig_bits.ResetAllBits();
+    const size_t n_triggers = trigger_names().size();
+    for(size_t it = 0; it < n_triggers; it++) {
+        if(uniform(0., 1.) < m_config.trigger_fraction) trig_bits.SetBitNumber(it);
+    }
+
+    // pointer views, filled only once the object vectors stop growing
+    auto by_pt = [](const Susy::Particle* a, const Susy::Particle* b) { return a->Pt() > b->Pt(); };
+    electron_ptrs.clear();
+    muon_ptrs.clear();
+    lepton_ptrs.clear();
+    jet_ptrs.clear();
+    for(auto& e : electrons) { electron_ptrs.push_back(&e); lepton_ptrs.push_back(&e); }
+    for(auto& mu : muons)    { muon_ptrs.push_back(&mu); lepton_ptrs.push_back(&mu); }
+    for(auto& j : jets)      { jet_ptrs.push_back(&j); }
+    sort(electron_ptrs.begin(), electron_ptrs.end(), by_pt);
+    sort(muon_ptrs.begin(), muon_ptrs.end(), by_pt);
+    sort(lepton_ptrs.begin(), lepton_ptrs.end(), by_pt);
+    sort(jet_ptrs.begin(), jet_ptrs.end(), by_pt);
+}
+//////////////////////////////////////////////////////////////////////////////
+bool write_susynt_file(const string& output, long long n_events, const SyntheticConfig& config,
+        int mc_channel)
+{
+    TFile* file = TFile::Open(output.c_str(), "RECREATE");
+    if(!file || file->IsZombie()) {
+        cout << "write_susynt_file    ERROR Unable to open output file " << output << endl;
+        return false;
+    }
+    TTree* tree = new TTree("susyNt", "susyNt");
+    tree->SetAutoSave(10000000);
+
+    Susy::SusyNtObject nt;
+    nt.SetActive();
+    nt.WriteTo(tree);
+
+    const bool is_mc = (mc_channel > 0);
+    const size_t n_flags = sizeof(nt.evt()->cutFlags) / sizeof(nt.evt()->cutFlags[0]);
+
+    SyntheticEvents events(config);
+    for(long long ievent = 0; ievent < n_events; ievent++) {
+        events.next();
+        nt.clear();
+
+        Susy::Event* evt = nt.evt();
+        evt->run = (is_mc ? 300000 : events.run);
+        evt->eventNumber = events.event_number;
+        evt->lb = static_cast<unsigned int>(1 + ievent / 1000);
+        evt->treatAsYear = 2017;
+        evt->isMC = is_mc;
+        evt->mcChannel = (is_mc ? mc_channel : 0);
+        evt->w = 1.;
+        evt->wPileup = evt->wPileup_up = evt->wPileup_dn = 1.;
+        evt->wPileup_period = 1;
+        evt->avgMu = evt->avgMuDataSF = 38.;
+        evt->actualMu = evt->actualMuDataSF = 37. + (ievent % 7);
+        evt->beamPosX = evt->beamPosY = 0.;
+        evt->beamPosZ = -5.;
+        evt->beamPosSigmaX = evt->beamPosSigmaY = 0.01;
+        evt->beamPosSigmaZ = 35.;
+        evt->pvX = evt->pvY = 0.;
+        evt->pvZ = -5. + 35. * ((ievent % 101) / 50. - 1.);
+        evt->nVtx = 20 + (ievent % 15);
+        evt->nTracksAtPV = 30 + (ievent % 40);
+        evt->trigBits = events.trig_bits;
+        for(size_t iflag = 0; iflag < n_flags; iflag++) evt->cutFlags[iflag] = ~0u;
+
+        for(const auto& e : events.electrons) nt.ele()->push_back(e);
+        for(const auto& mu : events.muons) nt.muo()->push_back(mu);
+        for(const auto& j : events.jets) nt.jet()->push_back(j);
+        nt.met()->push_back(events.met);
+
+        tree->Fill();
+    }
+
+    // trigger name -> bit map read by the SusyNtuple TriggerTools
+    const auto& triggers = trigger_names();
+    TH1F* trig = new TH1F("trig", "trig", triggers.size(), 0, triggers.size());
+    for(size_t it = 0; it < triggers.size(); it++) {
+        trig->GetXaxis()->SetBinLabel(it + 1, triggers[it].c_str());
+    }
+
+    // counters as written by the SusyNtMaker (all events pass)
+    TH1F* raw = new TH1F("rawCutFlow", "rawCutFlow", 1, 0, 1);
+    TH1F* gen = new TH1F("genCutFlow", "genCutFlow", 1, 0, 1);
+    raw->SetBinContent(1, n_events);
+    gen->SetBinContent(1, n_events);
+
+    file->cd();
+    tree->Write();
+    trig->Write();
+    raw->Write();
+    gen->Write();
+    file->Close();
+    delete file;
+    return true;
+}
+
+} // namespace bench
+} // namespace rjt
@@ -0,0 +1,104 @@
+#ifndef RJTupler_SyntheticEvents_h
+#define RJTupler_SyntheticEvents_h
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// SyntheticEvents
+//
+// Random susyNt-like events for the benchmarks: pT ordered electrons and
+// muons, jets (a fraction of them b-tagged), missing transverse momentum
+// and trigger bits, drawn from simple distributions with a fixed seed so
+// that every run sees the same events. They are not physics, only inputs
+// with realistic multiplicities and value ranges for the code paths the
+// ntupler runs.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <string>
+#include <vector>
+#include <random>
+
+// ROOT
+#include "TBits.h"
+
+// SusyNtuple
+#include "SusyNtuple/SusyNt.h"
+#include "SusyNtuple/SusyDefs.h"
+
+namespace rjt {
+namespace bench {
+
+    struct SyntheticConfig {
+        SyntheticConfig();
+
+        // number of leptons per event, uniform in [min_leptons, max_leptons]
+        int min_leptons;
+        int max_leptons;
+
+        // chance a lepton is an electron (otherwise it is a muon)
+        double electron_fraction;
+
+        // mean of the Poisson number of jets per event, and the chance a
+        // jet is b-tagged
+        double mean_jets;
+        double bjet_fraction;
+
+        // scale of the exponential missing transverse momentum [GeV]
+        double met_scale;
+
+        // chance each trigger bit is set
+        double trigger_fraction;
+
+        unsigned int seed;
+    };
+
+    // the HLT chains the stop 2L ntupler decodes, in trigger-histogram order
+    const std::vector<std::string>& trigger_names();
+
+    // write n_events synthetic events as a susyNt tree, with the "trig",
+    // "rawCutFlow" and "genCutFlow" histograms, to output (MC events with
+    // the given channel number if mc_channel > 0, data otherwise)
+    bool write_susynt_file(const std::string& output, long long n_events,
+            const SyntheticConfig& config, int mc_channel = -1);
+
+    class SyntheticEvents {
+
+        public :
+            explicit SyntheticEvents(const SyntheticConfig& config);
+
+            // draw the next event
+            void next();
+
+            const SyntheticConfig& config() const { return m_config; }
+
+            unsigned int run;
+            unsigned long long event_number;
+            TBits trig_bits;
+
+            std::vector<Susy::Electron> electrons;
+            std::vector<Susy::Muon> muons;
+            std::vector<Susy::Jet> jets;
+            Susy::Met met;
+
+            // pointers into the objects above, as the Superlink holds them
+            // (leptons pT ordered)
+            ElectronVector electron_ptrs;
+            MuonVector muon_ptrs;
+            LeptonVector lepton_ptrs;
+            JetVector jet_ptrs;
+
+        private :
+            SyntheticConfig m_config;
+            std::mt19937_64 m_rng;
+
+            double uniform(double lo, double hi);
+            double exponential(double scale);
+            void set_isolation(Susy::Lepton& l);
+            void set_kinematics(Susy::Particle& p, double pt_scale, double pt_min, double eta_max, double m);
+    };
+
+} // namespace bench
+} // namespace rjt
+
+#endif
@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// generate_susynt
+//
+// Write synthetic susyNt-like events (see SyntheticEvents.h) to a local
+// ROOT file that the ntuplers and benchmarks can run over without grid
+// access:
+//
+//      generate_susynt -o synthetic.susyNt.root -n 100000 --mean-jets 4
+//
+// Every event passes the event-cleaning flags. The file carries the "trig"
+// histogram that maps trigger names onto the trigger bits, filled with the
+// chains the stop 2L ntupler decodes.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+// bench
+#include "SyntheticEvents.h"
+
+using namespace std;
+
+const string analysis_name = "generate_susynt";
+
+//////////////////////////////////////////////////////////////////////////////
+void print_usage()
+{
+    cout << "------------------------------------------------------" << endl;
+    cout << " " << analysis_name << endl;
+    cout << endl;
+    cout << " Options:" << endl;
+    cout << "   -o|--output <file>         output file [default: synthetic.susyNt.root]" << endl;
+    cout << "   -n|--events <n>            number of events [default: 10000]" << endl;
+    cout << "   --leptons <min> <max>      leptons per event [default: 2 2]" << endl;
+    cout << "   --electron-fraction <f>    chance a lepton is an electron [default: 0.5]" << endl;
+    cout << "   --mean-jets <n>            mean number of jets [default: 3]" << endl;
+    cout << "   --bjet-fraction <f>        chance a jet is b-tagged [default: 0.25]" << endl;
+    cout << "   --met-scale <GeV>          exponential MET scale [default: 60]" << endl;
+    cout << "   --trigger-fraction <f>     chance each trigger bit is set [default: 0.3]" << endl;
+    cout << "   --mc <dsid>                write MC events with this channel number [default: data]" << endl;
+    cout << "   --seed <n>                 random seed [default: 12345]" << endl;
+    cout << "   -h|--help                  print this help message" << endl;
+    cout << "------------------------------------------------------" << endl;
+}
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    string output = "synthetic.susyNt.root";
+    long long n_events = 10000;
+    int mc_channel = -1;
+    rjt::bench::SyntheticConfig config;
+
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if((arg == "-o" || arg == "--output") && has_value)      output = argv[++i];
+        else if((arg == "-n" || arg == "--events") && has_value) n_events = atoll(argv[++i]);
+        else if(arg == "--leptons" && i + 2 < argc) {
+            config.min_leptons = atoi(argv[++i]);
+            config.max_leptons = atoi(argv[++i]);
+        }
+        else if(arg == "--electron-fraction" && has_value) config.electron_fraction = atof(argv[++i]);
+        else if(arg == "--mean-jets" && has_value)         config.mean_jets = atof(argv[++i]);
+        else if(arg == "--bjet-fraction" && has_value)     config.bjet_fraction = atof(argv[++i]);
+        else if(arg == "--met-scale" && has_value)         config.met_scale = atof(argv[++i]);
+        else if(arg == "--trigger-fraction" && has_value)  config.trigger_fraction = atof(argv[++i]);
+        else if(arg == "--mc" && has_value)                mc_channel = atoi(argv[++i]);
+        else if(arg == "--seed" && has_value)              config.seed = atoi(argv[++i]);
+        else if(arg == "-h" || arg == "--help") { print_usage(); return 0; }
+        else {
+            cout << analysis_name << "    ERROR Unknown or incomplete option '" << arg << "'" << endl;
+            print_usage();
+            return 1;
+        }
+    }
+    if(config.min_leptons < 0 || config.max_leptons < config.min_leptons || n_events <= 0) {
+        cout << analysis_name << "    ERROR Invalid lepton multiplicities or number of events" << endl;
+        return 1;
+    }
+
+    if(!rjt::bench::write_susynt_file(output, n_events, config, mc_channel)) return 1;
+
+    cout << analysis_name << "    Wrote " << n_events << " events to " << output << endl;
+    return 0;
+}
@@ -0,0 +1,379 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// microbench
+//
+// Microbenchmarks of the pieces of the stop 2L ntupler that run per event,
+// over synthetic events (see SyntheticEvents.h):
+//
+//      microbench [--filter <regex>] [--min-time <s>] [--json <file>]
+//
+// Each iteration processes one event, cycling through a fixed pool of
+// events so that the timing does not include generating them.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+
+// ROOT
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1F.h"
+#include "TF1.h"
+#include "TVector3.h"
+#include "TLorentzVector.h"
+
+// SusyNtuple
+#include "SusyNtuple/SusyNtTools.h"
+#include "SusyNtuple/KinematicTools.h"
+#include "SusyNtuple/TriggerTools.h"
+#include "SusyNtuple/AnalysisType.h"
+
+// Superflow
+#include "Superflow/Superlink.h"
+
+// RJTupler
+#include "RJTupler/FlowBuilder.h"
+#include "RJTupler/StopObjects.h"
+#include "RJTupler/StopRJTree.h"
+#include "RJTupler/FormulaKernels.h"
+#include "RJTupler/TriggerDecoder.h"
+#include "RJTupler/AllocationCounter.h"
+
+// bench
+#include "BenchHarness.h"
+#include "SyntheticEvents.h"
+
+using namespace std;
+using namespace rjt::bench;
+
+const string analysis_name = "microbench";
+
+////////////////////////////////////////////////////////////////////////////////
+// shared inputs
+////////////////////////////////////////////////////////////////////////////////
+
+const size_t pool_size = 512;
+
+// a pool of synthetic events, each owned by its own generator so that the
+// object pointers stay valid
+static const vector<unique_ptr<SyntheticEvents>>& event_pool()
+{
+    static vector<unique_ptr<SyntheticEvents>> pool;
+    if(pool.empty()) {
+        for(size_t i = 0; i < pool_size; i++) {
+            SyntheticConfig config;
+            config.seed = 12345 + i;
+            pool.emplace_back(new SyntheticEvents(config));
+            pool.back()->next();
+        }
+    }
+    return pool;
+}
+
+// file holding the trigger name -> bit histogram, removed at exit
+static string trigger_file;
+
+static Susy::SusyNtTools& tools()
+{
+    static Susy::SusyNtTools* nt_tools = nullptr;
+    if(!nt_tools) {
+        nt_tools = new Susy::SusyNtTools();
+        nt_tools->setAnaType(AnalysisType::Ana_Stop2L);
+        nt_tools->initTriggerTool(trigger_file);
+    }
+    return *nt_tools;
+}
+
+// Superlinks pointing at the pool events
+static vector<sflow::Superlink>& link_pool()
+{
+    static vector<sflow::Superlink> links;
+    if(links.empty()) {
+        for(const auto& ev : event_pool()) {
+            sflow::Superlink sl;
+            sl.leptons = &ev->lepton_ptrs;
+            sl.electrons = &ev->electron_ptrs;
+            sl.muons = &ev->muon_ptrs;
+            sl.jets = &ev->jet_ptrs;
+            sl.met = &ev->met;
+            sl.tools = &tools();
+            links.push_back(sl);
+        }
+    }
+    return links;
+}
+
+static bool write_trigger_file()
+{
+    char name[] = "/tmp/rjt_microbench_trig_XXXXXX";
+    int fd = mkstemp(name);
+    if(fd < 0) return false;
+    close(fd);
+    trigger_file = string(name) + ".root";
+    rename(name, trigger_file.c_str());
+
+    TFile* file = TFile::Open(trigger_file.c_str(), "RECREATE");
+    if(!file || file->IsZombie()) return false;
+    const auto& triggers = trigger_names();
+    TH1F trig("trig", "trig", triggers.size(), 0, triggers.size());
+    for(size_t it = 0; it < triggers.size(); it++) {
+        trig.GetXaxis()->SetBinLabel(it + 1, triggers[it].c_str());
+    }
+    trig.Write();
+    file->Close();
+    delete file;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// trigger decoding: all of the chains the ntupler stores, by name
+////////////////////////////////////////////////////////////////////////////////
+static void BM_trigger_decoding(State& state)
+{
+    const auto& pool = event_pool();
+    const auto& triggers = trigger_names();
+    Susy::TriggerTools& trig_tool = tools().triggerTool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        const TBits& bits = pool[i++ % pool_size]->trig_bits;
+        int n_pass = 0;
+        for(const auto& name : triggers) n_pass += trig_tool.passTrigger(bits, name);
+        do_not_optimize(n_pass);
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_trigger_decoding);
+
+// the same chains through the bit table the ntupler uses
+static void BM_trigger_decoder(State& state)
+{
+    const auto& pool = event_pool();
+    const auto& triggers = trigger_names();
+    Susy::TriggerTools& trig_tool = tools().triggerTool();
+    unique_ptr<bool[]> flags(new bool[triggers.size()]);
+    rjt::TriggerDecoder decoder;
+    for(size_t it = 0; it < triggers.size(); it++) decoder.add(triggers[it], &flags[it]);
+    decoder.resolve([&](const TBits& bits, const string& name) { return trig_tool.passTrigger(bits, name); });
+    size_t i = 0;
+    while(state.keep_running()) {
+        decoder.decode(pool[i++ % pool_size]->trig_bits);
+        do_not_optimize(flags[0]);
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_trigger_decoder);
+
+////////////////////////////////////////////////////////////////////////////////
+// variable blocks: every recorded node evaluated once per event
+////////////////////////////////////////////////////////////////////////////////
+static void BM_lepton_variables(State& state)
+{
+    rjt::FlowBuilder flow;
+    rjt::StopObjects objects;
+    objects.add_lepton_variables(flow);
+    auto& links = link_pool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        sflow::Superlink* sl = &links[i++ % pool_size];
+        for(const auto& node : flow.nodes()) node.evaluate(sl);
+        objects.end_event();
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_lepton_variables);
+
+static void BM_jet_variables(State& state)
+{
+    rjt::FlowBuilder flow;
+    rjt::StopObjects objects;
+    objects.add_jet_variables(flow);
+    auto& links = link_pool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        sflow::Superlink* sl = &links[i++ % pool_size];
+        // the lepton-jet variables read the leptons copied by the lepton block
+        objects.leptons = *sl->leptons;
+        for(const auto& node : flow.nodes()) node.evaluate(sl);
+        objects.end_event();
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_jet_variables);
+
+// Once every pool event has been seen, evaluating the lepton and jet blocks
+// must not touch the heap. Returns the number of allocations made in the
+// second pass over the pool.
+static uint64_t steady_state_allocations()
+{
+    rjt::FlowBuilder flow;
+    rjt::StopObjects objects;
+    objects.add_lepton_variables(flow);
+    objects.add_jet_variables(flow);
+    auto& links = link_pool();
+    for(auto& sl : links) {
+        for(const auto& node : flow.nodes()) node.evaluate(&sl);
+        objects.end_event();
+    }
+    rjt::alloc::Counts before = rjt::alloc::thread_counts();
+    rjt::alloc::set_counting(true);
+    for(auto& sl : links) {
+        for(const auto& node : flow.nodes()) node.evaluate(&sl);
+        objects.end_event();
+    }
+    rjt::alloc::set_counting(false);
+    return rjt::alloc::thread_counts().allocations - before.allocations;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// kinematic tools
+////////////////////////////////////////////////////////////////////////////////
+static void BM_getMT2(State& state)
+{
+    const auto& pool = event_pool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        const SyntheticEvents& ev = *pool[i++ % pool_size];
+        do_not_optimize(kin::getMT2(ev.lepton_ptrs, ev.met));
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_getMT2);
+
+static void BM_superRazor(State& state)
+{
+    const auto& pool = event_pool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        const SyntheticEvents& ev = *pool[i++ % pool_size];
+        TVector3 dummyvec;
+        double shatr, dpb, dummy, gamma, mdr;
+        kin::superRazor(ev.lepton_ptrs, ev.met, dummyvec, dummyvec,
+            dummyvec, dummyvec, shatr, dpb, dummy,
+            gamma, dummy, mdr, dummy);
+        do_not_optimize(gamma);
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_superRazor);
+
+////////////////////////////////////////////////////////////////////////////////
+// RestFrames tree
+////////////////////////////////////////////////////////////////////////////////
+static void BM_restframes(State& state)
+{
+    static rjt::StopRJTree rj;
+    static bool initialized = rj.initialize();
+    if(!initialized) {
+        cout << analysis_name << "    ERROR Unable to initialize the RestFrames tree" << endl;
+        exit(1);
+    }
+    const auto& pool = event_pool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        const SyntheticEvents& ev = *pool[i++ % pool_size];
+        TVector3 met(ev.met.lv().Px(), ev.met.lv().Py(), ev.met.lv().Pz());
+        rj.analyze(met, *ev.lepton_ptrs.at(0), *ev.lepton_ptrs.at(1));
+        do_not_optimize(rj.shat);
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_restframes);
+
+////////////////////////////////////////////////////////////////////////////////
+// output filling: a tree with as many float columns as the ntupler stores
+////////////////////////////////////////////////////////////////////////////////
+static void BM_output_fill(State& state)
+{
+    const size_t n_columns = 300;
+    string name = trigger_file + ".fill.root";
+    TFile* file = TFile::Open(name.c_str(), "RECREATE");
+    TTree* tree = new TTree("superNt", "superNt");
+    vector<float> values(n_columns, 0.);
+    for(size_t ic = 0; ic < n_columns; ic++) {
+        string column = "var" + to_string(ic);
+        tree->Branch(column.c_str(), &values[ic], (column + "/F").c_str());
+    }
+    const auto& pool = event_pool();
+    size_t i = 0;
+    while(state.keep_running()) {
+        const SyntheticEvents& ev = *pool[i++ % pool_size];
+        for(size_t ic = 0; ic < n_columns; ic++) values[ic] = ev.met.Et + ic;
+        tree->Fill();
+    }
+    state.set_items_processed(state.iterations());
+    file->Write();
+    file->Close();
+    delete file;
+    remove(name.c_str());
+}
+RJT_BENCHMARK(BM_output_fill);
+
+////////////////////////////////////////////////////////////////////////////////
+// pileup density: compiled kernel against the TF1 it replaced
+////////////////////////////////////////////////////////////////////////////////
+static void BM_gausn_kernel(State& state)
+{
+    double x = 0.;
+    while(state.keep_running()) {
+        x += 1e-3;
+        do_not_optimize(rjt::kernels::pileup_density(37., -5., 35., x));
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_gausn_kernel);
+
+static void BM_gausn_tf1(State& state)
+{
+    TF1 f("bench_gausn", "gausn", -250, 250);
+    f.SetParameters(37., -5., 35.);
+    double x = 0.;
+    while(state.keep_running()) {
+        x += 1e-3;
+        do_not_optimize(f.Eval(x));
+    }
+    state.set_items_processed(state.iterations());
+}
+RJT_BENCHMARK(BM_gausn_tf1);
+
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    if(!write_trigger_file()) {
+        cout << analysis_name << "    ERROR Unable to write the trigger histogram file" << endl;
+        return 1;
+    }
+
+    // the benchmarks only mean something if the kernel still agrees with ROOT
+    TF1 f("check_gausn", "gausn", -250, 250);
+    f.SetParameters(37., -5., 35.);
+    for(double x = -100.; x <= 100.; x += 12.5) {
+        double expected = f.Eval(x);
+        double value = rjt::kernels::pileup_density(37., -5., 35., x);
+        if(fabs(value - expected) > 1e-12 * fabs(expected)) {
+            cout << analysis_name << "    ERROR gausn kernel differs from TF1 at x = " << x
+                 << " (" << value << " vs " << expected << ")" << endl;
+            return 1;
+        }
+    }
+
+    // nor if the variable blocks started allocating per event
+    uint64_t n_alloc = steady_state_allocations();
+    if(n_alloc > 0) {
+        cout << analysis_name << "    ERROR Lepton and jet variables made " << n_alloc
+             << " heap allocations over " << pool_size << " warmed-up events" << endl;
+        remove(trigger_file.c_str());
+        return 1;
+    }
+
+    int status = run_benchmarks(argc, argv);
+    remove(trigger_file.c_str());
+    return status;
+}
@@ -0,0 +1,408 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// throughput_bench
+//
+// End-to-end throughput regression check. It generates the fixed synthetic
+// sample described by a baseline file and runs the full ntupler_rj_stop2l
+// over it, in a scratch directory, a few times. It records
+//
+//      events/s     input events over the wall time of the ntupler process
+//                   (best of the repeats)
+//      peak RSS     maximum resident set size of the ntupler process
+//      output size  ROOT files the ntupler wrote
+//
+// and compares them with the baseline:
+//
+//      throughput_bench [--baseline data/bench/throughput_baseline.txt]
+//
+// The exit status is 0 when events/s is within the baseline threshold,
+// 2 when it regressed beyond it, 3 when the baseline has no recorded
+// events/s (the check is reported as SKIP, it did not pass) and 1 on
+// errors. Changes in peak RSS and output size are reported but do not
+// fail the check.
+//
+// With --compare the same sample is also run with extra ntupler options
+// and the events/s of both configurations are shown side by side, e.g.
+// the effect of pinning the workers:
+//
+//      throughput_bench --args "--workers 8" --compare "--cpu-list 0-7"
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+// posix
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+// bench
+#include "SyntheticEvents.h"
+
+using namespace std;
+
+const string analysis_name = "throughput_bench";
+
+struct Measurement {
+    Measurement() : events_per_second(0), peak_rss_mb(0), output_mb(0) {}
+    double events_per_second;
+    double peak_rss_mb;
+    double output_mb;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+void print_usage()
+{
+    cout << "------------------------------------------------------" << endl;
+    cout << " " << analysis_name << endl;
+    cout << endl;
+    cout << " Options:" << endl;
+    cout << "   --baseline <file>      baseline file [default: data/bench/throughput_baseline.txt]" << endl;
+    cout << "   --ntupler <exe>        ntupler to run [default: ntupler_rj_stop2l]" << endl;
+    cout << "   --repeat <n>           number of runs, the fastest counts [default: 3]" << endl;
+    cout << "   --threshold <f>        allowed fractional loss in events/s [default: from baseline]" << endl;
+    cout << "   --workdir <dir>        scratch directory [default: new directory in /tmp, removed]" << endl;
+    cout << "   --args <options>       extra ntupler options, added to the baseline's ntupler_args" << endl;
+    cout << "   --compare <options>    also run with these options added, and compare events/s" << endl;
+    cout << "   --json <file>          also write the measurement as JSON" << endl;
+    cout << "   --update-baseline      record the measurement in the baseline file" << endl;
+    cout << "   -h|--help              print this help message" << endl;
+    cout << "------------------------------------------------------" << endl;
+}
+//////////////////////////////////////////////////////////////////////////////
+// baseline lines as '<key> <value>', comments and blank lines kept as is
+struct BaselineLine {
+    string text;
+    string key;
+    string value;
+};
+
+bool read_baseline(const string& name, vector<BaselineLine>& lines, map<string, string>& values)
+{
+    ifstream in(name);
+    if(!in) {
+        cout << analysis_name << "    ERROR Unable to open baseline file " << name << endl;
+        return false;
+    }
+    string text;
+    while(getline(in, text)) {
+        BaselineLine line;
+        line.text = text;
+        size_t start = text.find_first_not_of(" \t");
+        if(start != string::npos && text[start] != '#') {
+            istringstream fields(text);
+            fields >> line.key;
+            getline(fields, line.value);
+            size_t vstart = line.value.find_first_not_of(" \t");
+            line.value = (vstart == string::npos ? "" : line.value.substr(vstart));
+            values[line.key] = line.value;
+        }
+        lines.push_back(line);
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+bool write_baseline(const string& name, vector<BaselineLine> lines, const Measurement& m)
+{
+    map<string, string> measured;
+    ostringstream eps, rss, out;
+    eps << fixed << setprecision(1) << m.events_per_second;
+    rss << fixed << setprecision(1) << m.peak_rss_mb;
+    out << fixed << setprecision(3) << m.output_mb;
+    measured["events_per_second"] = eps.str();
+    measured["peak_rss_mb"] = rss.str();
+    measured["output_mb"] = out.str();
+
+    // replace the measured keys in place, also when they are only present
+    // commented out, and append any that are missing
+    for(auto& line : lines) {
+        string key = line.key;
+        if(key == "") {
+            istringstream fields(line.text);
+            string hash;
+            fields >> hash >> key;
+            string rest;
+            if(hash != "#" || (fields >> rest)) key = "";
+        }
+        auto it = measured.find(key);
+        if(it == measured.end()) continue;
+        line.text = it->first + " " + it->second;
+        measured.erase(it);
+    }
+    for(const auto& item : measured) {
+        BaselineLine line;
+        line.text = item.first + " " + item.second;
+        lines.push_back(line);
+    }
+
+    ofstream outf(name);
+    if(!outf) {
+        cout << analysis_name << "    ERROR Unable to write baseline file " << name << endl;
+        return false;
+    }
+    for(const auto& line : lines) {
+        if(line.text == "# measured (not yet recorded on the reference machine)") {
+            outf << "# measured" << endl;
+            continue;
+        }
+        outf << line.text << endl;
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+// total size in bytes of the ROOT files directly inside dir
+double root_file_bytes(const string& dir)
+{
+    double bytes = 0;
+    DIR* d = opendir(dir.c_str());
+    if(!d) return 0;
+    while(struct dirent* entry = readdir(d)) {
+        string name = entry->d_name;
+        if(name.size() < 5 || name.compare(name.size() - 5, 5, ".root") != 0) continue;
+        struct stat st;
+        if(stat((dir + "/" + name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) bytes += st.st_size;
+    }
+    closedir(d);
+    return bytes;
+}
+//////////////////////////////////////////////////////////////////////////////
+// run the ntupler in run_dir with its output in run_dir/ntupler.log
+bool run_ntupler(const vector<string>& args, const string& run_dir, long long n_events,
+        Measurement& m)
+{
+    if(mkdir(run_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        cout << analysis_name << "    ERROR Unable to create " << run_dir << ": " << strerror(errno) << endl;
+        return false;
+    }
+    cout.flush();
+
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if(pid < 0) {
+        cout << analysis_name << "    ERROR Unable to fork: " << strerror(errno) << endl;
+        return false;
+    }
+    if(pid == 0) {
+        if(chdir(run_dir.c_str()) != 0) _exit(127);
+        int fd = open("ntupler.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        vector<char*> argv;
+        for(const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    while(wait4(pid, &status, 0, &usage) < 0) {
+        if(errno != EINTR) {
+            cout << analysis_name << "    ERROR Lost the ntupler process: " << strerror(errno) << endl;
+            return false;
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        cout << analysis_name << "    ERROR " << args[0] << " failed (see " << run_dir << "/ntupler.log)" << endl;
+        return false;
+    }
+    m.events_per_second = (seconds > 0 ? n_events / seconds : 0);
+    m.peak_rss_mb = usage.ru_maxrss / 1024.; // kB on Linux
+    m.output_mb = root_file_bytes(run_dir) / (1024. * 1024.);
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////
+void print_row(const string& label, double measured, double baseline, int precision)
+{
+    cout << analysis_name << "    " << left << setw(20) << label << right << fixed
+         << setprecision(precision) << setw(12) << measured;
+    if(baseline > 0) {
+        cout << setw(12) << baseline << setw(10) << showpos << setprecision(1)
+             << 100. * (measured / baseline - 1.) << "%" << noshowpos;
+    }
+    cout << endl;
+}
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    string baseline_file = "data/bench/throughput_baseline.txt";
+    string ntupler = "ntupler_rj_stop2l";
+    string workdir = "";
+    string json_file = "";
+    string extra_args = "";
+    string compare_args = "";
+    int repeat = 3;
+    double threshold = -1;
+    bool update = false;
+
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--baseline" && has_value)       baseline_file = argv[++i];
+        else if(arg == "--ntupler" && has_value)   ntupler = argv[++i];
+        else if(arg == "--repeat" && has_value)    repeat = atoi(argv[++i]);
+        else if(arg == "--threshold" && has_value) threshold = atof(argv[++i]);
+        else if(arg == "--workdir" && has_value)   workdir = argv[++i];
+        else if(arg == "--json" && has_value)      json_file = argv[++i];
+        else if(arg == "--args" && has_value)      extra_args = argv[++i];
+        else if(arg == "--compare" && has_value)   compare_args = argv[++i];
+        else if(arg == "--update-baseline")        update = true;
+        else if(arg == "-h" || arg == "--help") { print_usage(); return 0; }
+        else {
+            cout << analysis_name << "    ERROR Unknown or incomplete option '" << arg << "'" << endl;
+            print_usage();
+            return 1;
+        }
+    }
+    if(repeat < 1) repeat = 1;
+
+    vector<BaselineLine> lines;
+    map<string, string> baseline;
+    if(!read_baseline(baseline_file, lines, baseline)) return 1;
+
+    auto number = [&](const string& key, double def) -> double {
+        auto it = baseline.find(key);
+        return (it == baseline.end() || it->second == "") ? def : atof(it->second.c_str());
+    };
+
+    rjt::bench::SyntheticConfig config;
+    long long n_events = static_cast<long long>(number("events", 20000));
+    config.seed = static_cast<unsigned int>(number("seed", config.seed));
+    if(baseline.count("leptons")) {
+        istringstream leptons(baseline["leptons"]);
+        leptons >> config.min_leptons >> config.max_leptons;
+    }
+    config.electron_fraction = number("electron_fraction", config.electron_fraction);
+    config.mean_jets = number("mean_jets", config.mean_jets);
+    config.bjet_fraction = number("bjet_fraction", config.bjet_fraction);
+    config.met_scale = number("met_scale", config.met_scale);
+    config.trigger_fraction = number("trigger_fraction", config.trigger_fraction);
+    int mc_channel = static_cast<int>(number("mc_channel", -1));
+    if(threshold < 0) threshold = number("threshold", 0.10);
+
+    bool remove_workdir = false;
+    if(workdir == "") {
+        char name[] = "/tmp/rjt_throughput_XXXXXX";
+        if(!mkdtemp(name)) {
+            cout << analysis_name << "    ERROR Unable to create a scratch directory: " << strerror(errno) << endl;
+            return 1;
+        }
+        workdir = name;
+        remove_workdir = true;
+    }
+    else if(mkdir(workdir.c_str(), 0755) != 0 && errno != EEXIST) {
+        cout << analysis_name << "    ERROR Unable to create " << workdir << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    string input = workdir + "/synthetic.susyNt.root";
+    cout << analysis_name << "    Generating " << n_events << " synthetic events in " << input << endl;
+    if(!rjt::bench::write_susynt_file(input, n_events, config, mc_channel)) return 1;
+
+    vector<string> args = { ntupler, "-i", input };
+    istringstream extra(baseline["ntupler_args"] + " " + extra_args);
+    string arg;
+    while(extra >> arg) args.push_back(arg);
+
+    // the best of the repeats, run in <workdir>/<tag><i>
+    auto measure = [&](const vector<string>& run_args, const string& tag, Measurement& best) -> bool {
+        for(int ir = 0; ir < repeat; ir++) {
+            Measurement m;
+            ostringstream run_dir;
+            run_dir << workdir << "/" << tag << ir;
+            if(!run_ntupler(run_args, run_dir.str(), n_events, m)) return false;
+            cout << analysis_name << "    Run " << tag << ir << ": " << fixed << setprecision(1)
+                 << m.events_per_second << " events/s" << endl;
+            if(m.events_per_second > best.events_per_second) best.events_per_second = m.events_per_second;
+            if(m.peak_rss_mb > best.peak_rss_mb) best.peak_rss_mb = m.peak_rss_mb;
+            best.output_mb = m.output_mb;
+        }
+        return true;
+    };
+
+    Measurement best;
+    bool ok = measure(args, "run", best);
+
+    Measurement compared;
+    if(ok && compare_args != "") {
+        vector<string> compare = args;
+        istringstream more(compare_args);
+        while(more >> arg) compare.push_back(arg);
+        ok = measure(compare, "compare", compared);
+    }
+
+    if(remove_workdir && ok) {
+        string command = "rm -rf '" + workdir + "'";
+        if(system(command.c_str()) != 0) {
+            cout << analysis_name << "    WARNING Unable to remove " << workdir << endl;
+        }
+    }
+    if(!ok) return 1;
+
+    double base_eps = number("events_per_second", 0);
+    cout << analysis_name << "    " << left << setw(20) << "" << right << setw(12) << "measured"
+         << setw(12) << "baseline" << setw(11) << "change" << endl;
+    print_row("events/s", best.events_per_second, base_eps, 1);
+    print_row("peak RSS [MB]", best.peak_rss_mb, number("peak_rss_mb", 0), 1);
+    print_row("output [MB]", best.output_mb, number("output_mb", 0), 2);
+    if(compare_args != "") {
+        cout << analysis_name << "    With " << compare_args << ":" << endl;
+        print_row("events/s", compared.events_per_second, best.events_per_second, 1);
+        print_row("peak RSS [MB]", compared.peak_rss_mb, best.peak_rss_mb, 1);
+    }
+
+    if(json_file != "") {
+        ofstream out(json_file);
+        out << "{\"events\": " << n_events
+            << ", \"events_per_second\": " << best.events_per_second
+            << ", \"peak_rss_mb\": " << best.peak_rss_mb
+            << ", \"output_mb\": " << best.output_mb
+            << ", \"baseline_events_per_second\": " << base_eps
+            << ", \"threshold\": " << threshold;
+        if(compare_args != "") {
+            out << ", \"compare_args\": \"" << compare_args << "\""
+                << ", \"compare_events_per_second\": " << compared.events_per_second;
+        }
+        out << "}" << endl;
+    }
+
+    if(update) {
+        if(!write_baseline(baseline_file, lines, best)) return 1;
+        cout << analysis_name << "    Recorded the measurement in " << baseline_file << endl;
+        return 0;
+    }
+
+    if(base_eps <= 0) {
+        cout << analysis_name << "    SKIP No baseline recorded in " << baseline_file
+             << ", nothing was checked (run with --update-baseline on the reference machine)" << endl;
+        return 3;
+    }
+    if(best.events_per_second < (1. - threshold) * base_eps) {
+        cout << analysis_name << "    ERROR Throughput regressed by more than "
+             << setprecision(0) << 100. * threshold << "% of the baseline" << endl;
+        return 2;
+    }
+    cout << analysis_name << "    Throughput within " << setprecision(0) << 100. * threshold
+         << "% of the baseline" << endl;
+    return 0;
+}
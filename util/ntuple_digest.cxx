@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// ntuple_digest
+//
+// Prints a digest of the content of every tree in a ROOT file: the branch
+// names and, entry by entry, every value of every branch. Two files with
+// the same digests hold the same entries in the same order, even though
+// the files themselves differ (creation times, UUIDs, basket layout).
+//
+//      ntuple_digest <file> [<reference file>]
+//
+// With a reference file the digests of both are compared, and the exit
+// status is 1 if any tree differs.
+//
+//      ntuple_digest --check-ordered-merge
+//
+// checks rjt::ordered_merge (--ordered-merge, --checkpoint): it writes a
+// small tree as a serial run would, and the same entries split over three
+// "worker" files holding several interleaved runs of entry ranges, some of
+// them taken out of order as work stealing does, merges the worker files
+// and compares the digest of the result with the serial one.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <unistd.h>
+
+// ROOT
+#include "TFile.h"
+#include "TKey.h"
+#include "TTree.h"
+#include "TClass.h"
+#include "TTreeFormula.h"
+
+// RJTupler
+#include "RJTupler/OrderedMerge.h"
+
+using namespace std;
+
+const string analysis_name = "ntuple_digest";
+
+// 64-bit FNV-1a
+struct Digest {
+    Digest() : value(14695981039346656037ull) {}
+    void add(const void* data, size_t n)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(size_t i = 0; i < n; i++) {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+    }
+    void add(const string& s) { add(s.data(), s.size() + 1); }
+    void add(double x) { add(&x, sizeof(x)); }
+    void add(int64_t x) { add(&x, sizeof(x)); }
+    uint64_t value;
+};
+
+struct TreeDigest {
+    int64_t entries;
+    uint64_t digest;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+static TreeDigest digest_tree(TTree* tree)
+{
+    Digest digest;
+    vector<TTreeFormula*> formulas;
+    TObjArray* branches = tree->GetListOfBranches();
+    for(int ib = 0; ib < branches->GetEntriesFast(); ib++) {
+        string name = branches->At(ib)->GetName();
+        digest.add(name);
+        formulas.push_back(new TTreeFormula(name.c_str(), name.c_str(), tree));
+    }
+
+    Long64_t n_entries = tree->GetEntries();
+    for(Long64_t entry = 0; entry < n_entries; entry++) {
+        tree->LoadTree(entry);
+        for(TTreeFormula* formula : formulas) {
+            int n_data = formula->GetNdata();
+            digest.add(static_cast<int64_t>(n_data));
+            for(int i = 0; i < n_data; i++) digest.add(formula->EvalInstance(i));
+        }
+    }
+    for(TTreeFormula* formula : formulas) delete formula;
+
+    TreeDigest result;
+    result.entries = n_entries;
+    result.digest = digest.value;
+    return result;
+}
+////////////////////////////////////////////////////////////////////////////////
+static bool digest_file(const string& filename, map<string, TreeDigest>& digests)
+{
+    TFile* file = TFile::Open(filename.c_str(), "READ");
+    if(!file || file->IsZombie()) {
+        cout << analysis_name << "    ERROR Unable to open " << filename << endl;
+        delete file;
+        return false;
+    }
+    set<string> done;
+    TIter next_key(file->GetListOfKeys());
+    while(TKey* key = static_cast<TKey*>(next_key())) {
+        string name = key->GetName();
+        if(!done.insert(name).second) continue;
+        TClass* cls = TClass::GetClass(key->GetClassName());
+        if(!cls || !cls->InheritsFrom(TTree::Class())) continue;
+        TTree* tree = static_cast<TTree*>(key->ReadObj());
+        digests[name] = digest_tree(tree);
+        cout << analysis_name << "    " << filename << " : " << name << "  " << digests[name].entries
+                << " entries  " << hex << setw(16) << setfill('0') << digests[name].digest
+                << dec << setfill(' ') << endl;
+    }
+    file->Close();
+    delete file;
+    return true;
+}
+////////////////////////////////////////////////////////////////////////////////
+static int compare_digests(const map<string, TreeDigest>& digests, const map<string, TreeDigest>& reference)
+{
+    int n_different = 0;
+    for(const auto& tree : digests) {
+        auto ref = reference.find(tree.first);
+        if(ref == reference.end()) {
+            cout << analysis_name << "    Tree " << tree.first << " is not in the reference" << endl;
+            n_different++;
+        }
+        else if(ref->second.entries != tree.second.entries || ref->second.digest != tree.second.digest) {
+            cout << analysis_name << "    Tree " << tree.first << " differs from the reference" << endl;
+            n_different++;
+        }
+    }
+    for(const auto& tree : reference) {
+        if(digests.count(tree.first)) continue;
+        cout << analysis_name << "    Tree " << tree.first << " is only in the reference" << endl;
+        n_different++;
+    }
+    return n_different;
+}
+////////////////////////////////////////////////////////////////////////////////
+// a check tree holding the entry ranges in the order given, with the global
+// entry number as key branch if with_key is set
+static bool write_check_file(const string& name, const vector<pair<Long64_t, Long64_t>>& ranges, bool with_key)
+{
+    TFile* file = TFile::Open(name.c_str(), "RECREATE");
+    if(!file || file->IsZombie()) {
+        cout << analysis_name << "    ERROR Unable to create " << name << endl;
+        delete file;
+        return false;
+    }
+    double x = 0, key = 0;
+    int n = 0;
+    TTree* tree = new TTree("superNt", "superNt");
+    tree->Branch("x", &x);
+    tree->Branch("n", &n);
+    if(with_key) tree->Branch("globalEntry", &key);
+    for(const auto& range : ranges) {
+        for(Long64_t entry = range.first; entry < range.second; entry++) {
+            x = std::sin(0.1 * entry) * entry;
+            n = static_cast<int>(entry % 7);
+            key = entry;
+            tree->Fill();
+        }
+    }
+    tree->Write();
+    file->Close();
+    delete file;
+    return true;
+}
+////////////////////////////////////////////////////////////////////////////////
+static int check_ordered_merge()
+{
+    char dir_template[] = "/tmp/rjt_ordered_merge_XXXXXX";
+    if(!mkdtemp(dir_template)) {
+        cout << analysis_name << "    ERROR Unable to create a scratch directory" << endl;
+        return 1;
+    }
+    string dir = dir_template;
+
+    // 20 ranges of 50 entries dealt over 3 workers; worker 1 takes its
+    // ranges last to first, as a worker stealing from the back would
+    const Long64_t n_ranges = 20, range_size = 50;
+    const int n_workers = 3;
+    vector<vector<pair<Long64_t, Long64_t>>> worker_ranges(n_workers);
+    for(Long64_t ir = 0; ir < n_ranges; ir++) {
+        worker_ranges[(ir * 7) % n_workers].push_back(make_pair(ir * range_size, (ir + 1) * range_size));
+    }
+    std::reverse(worker_ranges[1].begin(), worker_ranges[1].end());
+
+    bool ok = write_check_file(dir + "/serial.root", { make_pair(0LL, n_ranges * range_size) }, false);
+    vector<string> worker_files;
+    for(int iw = 0; ok && iw < n_workers; iw++) {
+        stringstream name;
+        name << dir << "/worker" << iw << ".root";
+        worker_files.push_back(name.str());
+        ok = write_check_file(name.str(), worker_ranges[iw], true);
+    }
+    string merged = dir + "/merged.root";
+    if(ok) ok = rjt::ordered_merge(worker_files, merged, "globalEntry", analysis_name);
+
+    int n_different = 1;
+    map<string, TreeDigest> digests, reference;
+    if(ok && digest_file(merged, digests) && digest_file(dir + "/serial.root", reference)) {
+        n_different = compare_digests(digests, reference);
+    }
+
+    for(const string& file : worker_files) remove(file.c_str());
+    remove(merged.c_str());
+    remove((dir + "/serial.root").c_str());
+    rmdir(dir.c_str());
+
+    cout << analysis_name << "    " << (n_different ? "ERROR Ordered merge differs from the serial run"
+            : "Ordered merge holds the entries of the serial run") << endl;
+    return (n_different ? 1 : 0);
+}
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    if(argc < 2 || argc > 3 || string(argv[1]) == "-h" || string(argv[1]) == "--help") {
+        cout << analysis_name << "    Usage: " << analysis_name << " <file> [<reference file>]" << endl;
+        cout << analysis_name << "           " << analysis_name << " --check-ordered-merge" << endl;
+        return (argc == 2 ? 0 : 1);
+    }
+    if(argc == 2 && string(argv[1]) == "--check-ordered-merge") return check_ordered_merge();
+
+    map<string, TreeDigest> digests;
+    if(!digest_file(argv[1], digests)) return 1;
+    if(argc == 2) return 0;
+
+    map<string, TreeDigest> reference;
+    if(!digest_file(argv[2], reference)) return 1;
+
+    int n_different = compare_digests(digests, reference);
+    cout << analysis_name << "    " << (n_different ? "Files differ" : "Files hold the same entries") << endl;
+    return (n_different ? 1 : 0);
+}
@@ -2,15 +2,24 @@
 #include <cstdlib>
 #include <cmath>
 #include <iostream>
+#include <sstream>
+#include <fstream>
 #include <string>
+#include <algorithm>
 #include <math.h>
 #include <random>
+#include <ctime>
+#include <climits>
+
+// posix
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 // ROOT
 #include "TChain.h"
 #include "TVectorD.h"
 #include "TRandom.h"
-#include "TF1.h"
 
 // SusyNtuple
 #include "SusyNtuple/ChainHelper.h"
@@ -28,53 +37,259 @@
 // RestFrames
 #include "RestFrames/RestFrames.hh"
 
+// RJTupler
+#include "RJTupler/FormulaKernels.h"
+#include "RJTupler/WeightEngine.h"
+#include "RJTupler/WeightVariations.h"
+#include "RJTupler/TuplerOptions.h"
+#include "RJTupler/WorkerPool.h"
+#include "RJTupler/FlowBuilder.h"
+#include "RJTupler/StageTimer.h"
+#include "RJTupler/ProgressReporter.h"
+#include "RJTupler/StageClock.h"
+#include "RJTupler/ClockedSuperflow.h"
+#include "RJTupler/PerfCounters.h"
+#include "RJTupler/TriggerDecoder.h"
+#include "RJTupler/IOPipeline.h"
+#include "RJTupler/EventLoop.h"
+#include "RJTupler/WorkStealingQueue.h"
+#include "RJTupler/OrderedMerge.h"
+#include "RJTupler/MemoryReport.h"
+#include "RJTupler/CpuPlacement.h"
+#include "RJTupler/WorkQueue.h"
+#include "RJTupler/Checkpoint.h"
+#include "RJTupler/JobServer.h"
+#include "RJTupler/StopObjects.h"
+#include "RJTupler/StopRJTree.h"
+
 using namespace std;
 using namespace sflow;
 using namespace RestFrames;
 
 const string analysis_name = "ntupler_rj_stop2l";
 
+// shape (event) systematics, each one written to its own tree
+struct ShapeSystematic {
+    NtSys::SusyNtSys sys;
+    const char* tree_name;
+    const char* description;
+};
+const ShapeSystematic shape_systematics[] = {
+    // egamma
+    { NtSys::EG_RESOLUTION_ALL_UP, "EG_RESOLUTION_ALL_UP", "shift in e-gamma resolution (UP)" },
+    { NtSys::EG_RESOLUTION_ALL_DN, "EG_RESOLUTION_ALL_DN", "shift in e-gamma resolution (DOWN)" },
+    { NtSys::EG_SCALE_ALL_UP, "EG_SCALE_ALL_UP", "shift in e-gamma scale (UP)" },
+    { NtSys::EG_SCALE_ALL_DN, "EG_SCALE_ALL_DN", "shift in e-gamma scale (DOWN)" },
+    // muon
+    { NtSys::MUON_ID_UP, "MUON_ID_UP", "muon ID (UP)" },
+    { NtSys::MUON_ID_DN, "MUON_ID_DN", "muon ID (DOWN)" },
+    { NtSys::MUON_MS_UP, "MUON_MS_UP", "muon MS (UP)" },
+    { NtSys::MUON_MS_DN, "MUON_MS_DN", "muon MS (DOWN)" },
+    { NtSys::MUON_SCALE_UP, "MUON_SCALE_UP", "muon scale shift (UP)" },
+    { NtSys::MUON_SCALE_DN, "MUON_SCALE_DN", "muon scale shift (DN)" },
+    // jet
+    { NtSys::JER, "JER", "JER" },
+    { NtSys::JET_GroupedNP_1_UP, "JET_GroupedNP_1_UP", "JES NP set 1 (up)" },
+    { NtSys::JET_GroupedNP_1_DN, "JET_GroupedNP_1_DN", "JES NP set 1 (down)" },
+    { NtSys::JET_GroupedNP_2_UP, "JET_GroupedNP_2_UP", "JES NP set 2 (up)" },
+    { NtSys::JET_GroupedNP_2_DN, "JET_GroupedNP_2_DN", "JES NP set 2 (down)" },
+    { NtSys::JET_GroupedNP_3_UP, "JET_GroupedNP_3_UP", "JES NP set 3 (up)" },
+    { NtSys::JET_GroupedNP_3_DN, "JET_GroupedNP_3_DN", "JES NP set 3 (down)" },
+    // met
+    { NtSys::MET_SoftTrk_ResoPara, "MET_SoftTrk_ResoPara", "MET TST Soft-Term resolution (parallel)" },
+    { NtSys::MET_SoftTrk_ResoPerp, "MET_SoftTrk_ResoPerp", "MET TST Soft-Term resolution (perpendicular)" },
+    { NtSys::MET_SoftTrk_ScaleUp, "MET_SoftTrk_ScaleUp", "MET TST Soft-Term shift in scale (UP)" },
+    { NtSys::MET_SoftTrk_ScaleDown, "MET_SoftTrk_ScaleDown", "MET TST Soft-Term shift in scale (DOWN)" }
+};
+
+// splitmix64 finalizer
+static unsigned long long mix64(unsigned long long x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+// seed of the per-event random draws: a mix of the sample (mc channel),
+// run and event numbers, so that a draw depends only on the event and not
+// on how many events the process (worker, shard, segment) processed before
+// it. MC run numbers are shared by all the samples of a campaign, the mc
+// channel keeps the draws of different samples independent.
+static unsigned int event_seed(unsigned int mc_channel, unsigned int run, unsigned long long event)
+{
+    unsigned long long x = mix64(mc_channel) ^ ((static_cast<unsigned long long>(run) << 32) ^ event);
+    x = mix64(x);
+    return static_cast<unsigned int>(x ^ (x >> 32));
+}
+
+// Forked children write their output under a suffix of their own (made
+// unique with the child's pid where the plain suffix may be shared),
+// identify the file by that suffix and report its absolute path to the
+// parent through a small report file.
+
+// the .root file in the working directory whose name ends in the given
+// (unique) output suffix, as an absolute path, "" unless there is exactly one
+static string find_output_file(const string& suffix)
+{
+    vector<string> found;
+    string ending = suffix + ".root";
+    DIR* dir = opendir(".");
+    if(!dir) return "";
+    while(struct dirent* entry = readdir(dir)) {
+        string name = entry->d_name;
+        if(name.size() < ending.size() || name.compare(name.size() - ending.size(), ending.size(), ending) != 0) continue;
+        found.push_back(name);
+    }
+    closedir(dir);
+    char cwd[PATH_MAX];
+    if(found.size() != 1 || !getcwd(cwd, sizeof(cwd))) return "";
+    return string(cwd) + "/" + found[0];
+}
+// in the child: rename the output written under unique_suffix to end in
+// suffix instead, returns its absolute path ("" if not found)
+static string finish_output_file(const string& unique_suffix, const string& suffix)
+{
+    string output = find_output_file(unique_suffix);
+    if(output == "") return "";
+    string final_output = output.substr(0, output.size() - unique_suffix.size() - 5) + suffix + ".root";
+    if(rename(output.c_str(), final_output.c_str()) != 0) return "";
+    return final_output;
+}
+// the report file through which the child named 'tag' of this process
+// passes back the path of its output, named by the parent before forking
+// (an absolute path, so that it does not depend on the child's working
+// directory)
+static string output_report_file(const string& tag)
+{
+    char cwd[PATH_MAX];
+    stringstream name;
+    name << (getcwd(cwd, sizeof(cwd)) ? cwd : ".") << "/." << analysis_name << "_" << getpid() << "_" << tag << ".output";
+    return name.str();
+}
+static bool report_output_file(const string& report, const string& output)
+{
+    if(output == "") return false;
+    ofstream out(report.c_str());
+    out << output << endl;
+    return out.good();
+}
+// in the parent: the path reported by the child ("" if none), the report
+// file is removed
+static string read_output_report(const string& report)
+{
+    string output;
+    ifstream in(report.c_str());
+    if(in.good()) getline(in, output);
+    in.close();
+    remove(report.c_str());
+    return output;
+}
+
 int main(int argc, char* argv[])
 {
     /////////////////////////////////////////////////////////////////////
     // Read in the command-line options (input file, num events, etc...)
     /////////////////////////////////////////////////////////////////////
+    rjt::TuplerOptions rj_options;
+    if(!rjt::read_tupler_options(argc, argv, rj_options, analysis_name)) {
+        exit(1);
+    }
+    // With --sample-list the inputs are read from a file, and the first one
+    // stands in for -i while everything is initialized
+    vector<string> samples;
+    vector<char*> sample_argv;
+    if(rj_options.sample_list != "") {
+        if(!rjt::read_sample_list(rj_options.sample_list, samples)) exit(1);
+        for(int i = 1; i < argc; i++) {
+            if(string(argv[i]) == "-i" || string(argv[i]) == "--input") {
+                cout << analysis_name << "    ERROR Give the inputs either with -i or with --sample-list" << endl;
+                exit(1);
+            }
+        }
+        sample_argv.assign(argv, argv + argc);
+        sample_argv.push_back(const_cast<char*>("-i"));
+        sample_argv.push_back(&samples[0][0]);
+        sample_argv.push_back(nullptr);
+        argc += 2;
+        argv = sample_argv.data();
+    }
     SFOptions options(argc, argv);
     options.ana_name = analysis_name;
     if(!read_options(options)) {
         exit(1);
     }
 
+    // the input must be prefetched from the moment its files are opened
+    if(rj_options.io_pipeline) rjt::enable_read_ahead();
+
     TChain* chain = new TChain("susyNt");
     chain->SetDirectory(0);
 
     bool verbose = true;
     ChainHelper::addInput(chain, options.input, verbose);
     Long64_t tot_num_events = chain->GetEntries();
+    Long64_t n_events_requested = options.n_events_to_process;
     options.n_events_to_process = (options.n_events_to_process < 0 ? tot_num_events : options.n_events_to_process);
 
+    // With --num-shards/--shard-index or --first-entry/--last-entry only part
+    // of the input is processed, in ranges cut at the cluster boundaries of
+    // the input trees, and the output name says which part it holds.
+    bool sharded = rjt::is_sharded(rj_options);
+    vector<rjt::EntryRange> job_ranges;
+    Long64_t n_job_entries = options.n_events_to_process;
+    if(sharded) {
+        vector<rjt::EntryRange> ranges = rjt::cluster_ranges(chain, options.n_events_to_process);
+        if(rj_options.num_shards > 0) job_ranges = rjt::shard_ranges(ranges, rj_options.shard_index, rj_options.num_shards);
+        else { job_ranges = rjt::clip_ranges(ranges, rj_options.first_entry, rj_options.last_entry); }
+        n_job_entries = 0;
+        for(const rjt::EntryRange& range : job_ranges) n_job_entries += range.size();
+        string tag = rjt::shard_tag(rj_options);
+        options.suffix_name = (options.suffix_name == "" ? tag : options.suffix_name + "_" + tag);
+        cout << analysis_name << "    Part " << tag << " : " << n_job_entries << " entries";
+        if(!job_ranges.empty()) cout << " in [" << job_ranges.front().first << ", " << job_ranges.back().last << ")";
+        cout << endl;
+    }
+
     ////////////////////////////////////////////////////
     // Construct and configure the Superflow object
     ////////////////////////////////////////////////////
-    Superflow* cutflow = new Superflow();
-    cutflow->setAnaName(options.ana_name);
-    cutflow->setAnaType(AnalysisType::Ana_Stop2L);
+    // with --stage-clock the entries are bracketed by a StageClock, and with
+    // --perf-counters or --alloc-audit they start the "input" counter stage
+    rjt::StageClock* clock = (rj_options.stage_clock ? new rjt::StageClock() : nullptr);
+    rjt::PerfCounters* counters = nullptr;
+    if(rj_options.perf_counters || rj_options.alloc_audit) {
+        counters = new rjt::PerfCounters(rj_options.counter_warmup);
+    }
+    Superflow* superflow = ((clock || counters) ? new rjt::ClockedSuperflow(clock, counters) : new Superflow());
+    superflow->setAnaName(options.ana_name);
+    superflow->setAnaType(AnalysisType::Ana_Stop2L);
 
     float lumi_to_set_in_pb = 1000.;
-    cutflow->setLumi(lumi_to_set_in_pb); // 1/fb
-    cutflow->setSampleName(options.input);
-    cutflow->setRunMode(options.run_mode);
-    cutflow->setCountWeights(true);
-    cutflow->setChain(chain);
-    cutflow->setDebug(options.dbg);
+    superflow->setLumi(lumi_to_set_in_pb); // 1/fb
+    superflow->setSampleName(options.input);
+    superflow->setRunMode(options.run_mode);
+    superflow->setCountWeights(true);
+    superflow->setChain(chain);
+    superflow->setDebug(options.dbg);
     if(options.suffix_name != "") {
-        cutflow->setFileSuffix(options.suffix_name);
+        superflow->setFileSuffix(options.suffix_name);
     }
     if(options.sumw_file_name != "") {
         cout << options.ana_name << "    Reading sumw for sample from file: " << options.sumw_file_name << endl;
-        cutflow->setUseSumwFile(options.sumw_file_name);
+        superflow->setUseSumwFile(options.sumw_file_name);
     }
-    cutflow->nttools().initTriggerTool(ChainHelper::firstFile(options.input, options.dbg));
+    superflow->nttools().initTriggerTool(ChainHelper::firstFile(options.input, options.dbg));
+
+    // the cuts and variables are recorded on a FlowBuilder, which hands
+    // them to the Superflow object(s) once the output layout is known
+    rjt::FlowBuilder* cutflow = new rjt::FlowBuilder();
+    // what the nodes may read from the Superlink, anything else they read
+    // has to be provided by another node
+    cutflow->set_external_inputs("event leptons jets met weights");
+
+    // optional progress reports (--progress), created by the process that
+    // runs the event loop
+    rjt::ProgressReporter* progress = nullptr;
 
     // print some useful
     cout << analysis_name << "    Total Entries    : " << chain->GetEntries() << endl;
@@ -94,7 +309,14 @@ int main(int argc, char* argv[])
     ////////////////////////////////////////////////////
     ////////////////////////////////////////////////////
 
-    *cutflow << CutName("read in ") << [](Superlink* /* sl */) -> bool { return true; };
+    // with --perf-counters the hardware counters are charged to the stages
+    // named with CounterStage
+    *cutflow << rjt::CounterStage("cuts");
+    *cutflow << CutName("read in ") << [&](Superlink* sl) -> bool {
+        if(progress) progress->event_read(sl->nt->evt()->run, sl->nt->evt()->eventNumber);
+        if(clock) clock->enter(rjt::StageClock::Cuts);
+        return true;
+    };
 
     ////////////////////////////////////////////////////
     // Cleaning cuts
@@ -159,6 +381,12 @@ int main(int argc, char* argv[])
         return pass;
     };
 
+    // variables are only evaluated for events passing all of the cuts
+    *cutflow << [&](Superlink* sl, var_void*) {
+        if(progress) progress->event_selected(sl->nt->evt()->run, sl->nt->evt()->eventNumber);
+        if(clock) clock->enter(rjt::StageClock::Vars);
+    };
+
     ///////////////////////////////////////////////////
     // ntuple architecture
     ///////////////////////////////////////////////////
@@ -227,72 +455,86 @@ int main(int argc, char* argv[])
     bool p_e26_lhmedium_nod0_L1EM22VHI_mu8noL1;
     bool p_e26_lhmedium_nod0_mu8noL1;
     bool p_e28_lhmedium_nod0_mu8noL1;
+    // event-level information, not changed by any object systematic
+    // the trigger bits are looked up by the trigger tool once, on the first
+    // event, and then decoded with a bit test per chain
+    rjt::TriggerDecoder triggers;
+    triggers.add("HLT_mu8noL1", &p_mu8noL1);
+    triggers.add("HLT_mu10noL1", &p_mu10noL1);
+    triggers.add("HLT_mu12noL1", &p_mu12noL1);
+    triggers.add("HLT_mu10", &p_mu10);
+    triggers.add("HLT_mu14", &p_mu14);
+    triggers.add("HLT_mu18", &p_mu18);
+    triggers.add("HLT_mu20", &p_mu20);
+    triggers.add("HLT_mu24", &p_mu24);
+    triggers.add("HLT_mu26", &p_mu26);
+    triggers.add("HLT_mu28", &p_mu28);
+    triggers.add("HLT_mu20_iloose_L1MU15", &p_mu20_iloose_L1MU15);
+    triggers.add("HLT_mu20_ivarloose_L1MU15", &p_mu20_ivarloose_L1MU15);
+    triggers.add("HLT_mu22", &p_mu22);
+    triggers.add("HLT_mu24_ivarmedium", &p_mu24_ivarmedium);
+    triggers.add("HLT_mu24_imedium", &p_mu24_imedium);
+    triggers.add("HLT_mu24_ivarloose", &p_mu24_ivarloose);
+    triggers.add("HLT_mu24_ivarloose_L1MU15", &p_mu24_ivarloose_L1MU15);
+    triggers.add("HLT_mu26_ivarmedium", &p_mu26_ivarmedium);
+    triggers.add("HLT_mu26_imedium", &p_mu26_imedium);
+    triggers.add("HLT_mu28_ivarmedium", &p_mu28_ivarmedium);
+    triggers.add("HLT_mu40", &p_mu40);
+    triggers.add("HLT_mu50", &p_mu50);
+    triggers.add("HLT_mu60", &p_mu60);
+    triggers.add("HLT_mu60_0eta105_msonly", &p_mu60_0eta105_msonly);
+    triggers.add("HLT_mu18_mu8noL1", &p_mu18_mu8noL1);
+    triggers.add("HLT_mu20_mu8noL1", &p_mu20_mu8noL1);
+    triggers.add("HLT_mu22_mu8noL1", &p_mu22_mu8noL1);
+    triggers.add("HLT_mu24_mu8noL1", &p_mu24_mu8noL1);
+    triggers.add("HLT_mu24_mu10noL1", &p_mu24_mu10noL1);
+    triggers.add("HLT_mu24_mu12noL1", &p_mu24_mu12noL1);
+    triggers.add("HLT_mu26_mu8noL1", &p_mu26_mu8noL1);
+    triggers.add("HLT_mu26_mu10noL1", &p_mu26_mu10noL1);
+    triggers.add("HLT_mu28_mu8noL1", &p_mu28_mu8noL1);
+    triggers.add("HLT_e24_lhmedium_L1EM20VH", &p_e24_lhmedium_L1EM20VH);
+    triggers.add("HLT_e24_lhmedium_L1EM20VHI", &p_e24_lhmedium_L1EM20VHI);
+    triggers.add("HLT_e24_lhtight_nod0_ivarloose", &p_e24_lhtight_nod0_ivarloose);
+    triggers.add("HLT_e26_lhtight_nod0_ivarloose", &p_e26_lhtight_nod0_ivarloose);
+    triggers.add("HLT_e28_lhtight_nod0_noringer_ivarloose", &p_e28_lhtight_nod0_noringer_ivarloose);
+    triggers.add("HLT_e28_lhtight_nod0_ivarloose", &p_e28_lhtight_nod0_ivarloose);
+    triggers.add("HLT_e32_lhtight_nod0_ivarloose", &p_e32_lhtight_nod0_ivarloose);
+    triggers.add("HLT_e60_lhmedium", &p_e60_lhmedium);
+    triggers.add("HLT_e60_lhmedium_nod0", &p_e60_lhmedium_nod0);
+    triggers.add("HLT_e60_lhmedium_nod0_L1EM24VHI", &p_e60_lhmedium_nod0_L1EM24VHI);
+    triggers.add("HLT_e80_lhmedium_nod0_L1EM24VHI", &p_e80_lhmedium_nod0_L1EM24VHI);
+    triggers.add("HLT_e120_lhloose", &p_e120_lhloose);
+    triggers.add("HLT_e140_lhloose_nod0", &p_e140_lhloose_nod0);
+    triggers.add("HLT_e140_lhloose_nod0_L1EM24VHI", &p_e140_lhloose_nod0_L1EM24VHI);
+    triggers.add("HLT_e300_etcut", &p_e300_etcut);
+    triggers.add("HLT_e300_etcut_L1EM24VHI", &p_e300_etcut_L1EM24VHI);
+    triggers.add("HLT_2e12_lhloose_L12EM10VH", &p_2e12_lhloose_L12EM10VH);
+    triggers.add("HLT_2e15_lhvloose_nod0_L12EM13VH", &p_2e15_lhvloose_nod0_L12EM13VH);
+    triggers.add("HLT_2e17_lhvloose_nod0", &p_2e17_lhvloose_nod0);
+    triggers.add("HLT_2e17_lhvloose_nod0_L12EM15VHI", &p_2e17_lhvloose_nod0_L12EM15VHI);
+    triggers.add("HLT_2e19_lhvloose_nod0", &p_2e19_lhvloose_nod0);
+    triggers.add("HLT_2e24_lhvloose_nod0", &p_2e24_lhvloose_nod0);
+    triggers.add("HLT_e7_lhmedium_nod0_mu24", &p_e7_lhmedium_nod0_mu24);
+    triggers.add("HLT_e7_lhmedium_mu24", &p_e7_lhmedium_mu24);
+    triggers.add("HLT_e17_lhloose_mu14", &p_e17_lhloose_mu14);
+    triggers.add("HLT_e17_lhloose_nod0_mu14", &p_e17_lhloose_nod0_mu14);
+    triggers.add("HLT_e24_lhmedium_nod0_L1EM20VHI_mu8noL1", &p_e24_lhmedium_nod0_L1EM20VHI_mu8noL1);
+    triggers.add("HLT_e24_lhmedium_L1EM20VHI_mu8noL1", &p_e24_lhmedium_L1EM20VHI_mu8noL1);
+    triggers.add("HLT_e26_lhmedium_nod0_L1EM22VHI_mu8noL1", &p_e26_lhmedium_nod0_L1EM22VHI_mu8noL1);
+    triggers.add("HLT_e26_lhmedium_nod0_mu8noL1", &p_e26_lhmedium_nod0_mu8noL1);
+    triggers.add("HLT_e28_lhmedium_nod0_mu8noL1", &p_e28_lhmedium_nod0_mu8noL1);
+    *cutflow << rjt::CounterStage("trigger decode");
+    *cutflow << rjt::InputScope("event");
+    *cutflow << rjt::Outputs("triggers");
     *cutflow << [&](Superlink* sl, var_void*) {
-    	p_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu8noL1");
-    	p_mu10noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu10noL1");
-    	p_mu12noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu12noL1");
-    	p_mu10 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu10");
-    	p_mu14 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu14");
-    	p_mu18 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu18");
-    	p_mu20 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu20");
-    	p_mu24 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24");
-    	p_mu26 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu26");
-    	p_mu28 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu28");
-    	p_mu20_iloose_L1MU15 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu20_iloose_L1MU15");
-    	p_mu20_ivarloose_L1MU15 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu20_ivarloose_L1MU15");
-    	p_mu22 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu22");
-    	p_mu24_ivarmedium = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_ivarmedium");
-    	p_mu24_imedium = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_imedium");
-    	p_mu24_ivarloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_ivarloose");
-    	p_mu24_ivarloose_L1MU15 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_ivarloose_L1MU15");
-    	p_mu26_ivarmedium = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu26_ivarmedium");
-    	p_mu26_imedium = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu26_imedium");
-    	p_mu28_ivarmedium = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu28_ivarmedium");
-    	p_mu40 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu40");
-    	p_mu50 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu50");
-    	p_mu60 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu60");
-    	p_mu60_0eta105_msonly = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu60_0eta105_msonly");
-    	p_mu18_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu18_mu8noL1");
-    	p_mu20_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu20_mu8noL1");
-    	p_mu22_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu22_mu8noL1");
-    	p_mu24_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_mu8noL1");
-    	p_mu24_mu10noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_mu10noL1");
-    	p_mu24_mu12noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu24_mu12noL1");
-    	p_mu26_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu26_mu8noL1");
-    	p_mu26_mu10noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu26_mu10noL1");
-    	p_mu28_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_mu28_mu8noL1");
-    	p_e24_lhmedium_L1EM20VH = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e24_lhmedium_L1EM20VH");
-    	p_e24_lhmedium_L1EM20VHI = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e24_lhmedium_L1EM20VHI");
-    	p_e24_lhtight_nod0_ivarloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e24_lhtight_nod0_ivarloose");
-    	p_e26_lhtight_nod0_ivarloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e26_lhtight_nod0_ivarloose");
-    	p_e28_lhtight_nod0_noringer_ivarloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e28_lhtight_nod0_noringer_ivarloose");
-    	p_e28_lhtight_nod0_ivarloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e28_lhtight_nod0_ivarloose");
-    	p_e32_lhtight_nod0_ivarloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e32_lhtight_nod0_ivarloose");
-    	p_e60_lhmedium = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e60_lhmedium");
-    	p_e60_lhmedium_nod0 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e60_lhmedium_nod0");
-    	p_e60_lhmedium_nod0_L1EM24VHI = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e60_lhmedium_nod0_L1EM24VHI");
-    	p_e80_lhmedium_nod0_L1EM24VHI = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e80_lhmedium_nod0_L1EM24VHI");
-    	p_e120_lhloose = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e120_lhloose");
-    	p_e140_lhloose_nod0 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e140_lhloose_nod0");
-    	p_e140_lhloose_nod0_L1EM24VHI = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e140_lhloose_nod0_L1EM24VHI");
-    	p_e300_etcut = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e300_etcut");
-    	p_e300_etcut_L1EM24VHI = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e300_etcut_L1EM24VHI");
-    	p_2e12_lhloose_L12EM10VH = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_2e12_lhloose_L12EM10VH");
-    	p_2e15_lhvloose_nod0_L12EM13VH = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_2e15_lhvloose_nod0_L12EM13VH");
-    	p_2e17_lhvloose_nod0 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_2e17_lhvloose_nod0");
-    	p_2e17_lhvloose_nod0_L12EM15VHI = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_2e17_lhvloose_nod0_L12EM15VHI");
-    	p_2e19_lhvloose_nod0 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_2e19_lhvloose_nod0");
-    	p_2e24_lhvloose_nod0 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_2e24_lhvloose_nod0");
-    	p_e7_lhmedium_nod0_mu24 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e7_lhmedium_nod0_mu24");
-    	p_e7_lhmedium_mu24 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e7_lhmedium_mu24");
-    	p_e17_lhloose_mu14 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e17_lhloose_mu14");
-    	p_e17_lhloose_nod0_mu14 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e17_lhloose_nod0_mu14");
-    	p_e24_lhmedium_nod0_L1EM20VHI_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e24_lhmedium_nod0_L1EM20VHI_mu8noL1");
-    	p_e24_lhmedium_L1EM20VHI_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e24_lhmedium_L1EM20VHI_mu8noL1");
-    	p_e26_lhmedium_nod0_L1EM22VHI_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e26_lhmedium_nod0_L1EM22VHI_mu8noL1");
-    	p_e26_lhmedium_nod0_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e26_lhmedium_nod0_mu8noL1");
-    	p_e28_lhmedium_nod0_mu8noL1 = sl->tools->triggerTool().passTrigger(sl->nt->evt()->trigBits, "HLT_e28_lhmedium_nod0_mu8noL1");
+        if(!triggers.resolved()) {
+            triggers.resolve([&](const TBits& bits, const string& name) {
+                return sl->tools->triggerTool().passTrigger(bits, name);
+            });
+        }
+        triggers.decode(sl->nt->evt()->trigBits);
     };
+    *cutflow << rjt::InputScope("event triggers");
     *cutflow << NewVar("pass mu8noL1"); {
     	*cutflow << HFTname("trig_mu8noL1");
     	*cutflow << [&](Superlink* /*sl*/, var_bool*) -> bool {
@@ -757,6 +999,9 @@ int main(int argc, char* argv[])
         *cutflow << SaveVar();
     }
 
+    // re-seeded for every event (see event_seed), or with
+    // --legacy-trigger-rng a single stream over the job as in productions
+    // made before the per-event seeding
     std::default_random_engine rng;
     std::uniform_real_distribution<float> uniform_distribution(0.0, 1.0);
     float random_number = 1.0;
@@ -768,6 +1013,7 @@ int main(int argc, char* argv[])
         };
         *cutflow << SaveVar();
     }
+    *cutflow << rjt::Inputs("leptons");
     *cutflow << NewVar("pass 2017 triggers with random"); {
         *cutflow << HFTname("trig_2017dilrand");
         *cutflow << [&](Superlink* sl, var_bool*) -> bool {
@@ -776,6 +1022,10 @@ int main(int argc, char* argv[])
             float sub_pt = sl->leptons->at(1)->Pt();
             if(sl->nt->evt()->isMC) {
                 if(isEE) {
+                    if(!rj_options.legacy_trigger_rng) {
+                        rng.seed(event_seed(sl->nt->evt()->mcChannel, sl->nt->evt()->run, sl->nt->evt()->eventNumber));
+                        uniform_distribution.reset();
+                    }
                     random_number = uniform_distribution(rng);
                     if(random_number < (0.6 / 78.2)) {
                         if( (lead_pt>=26 && sub_pt>=26) && p_2e24_lhvloose_nod0 ) {
@@ -818,6 +1068,8 @@ int main(int argc, char* argv[])
         *cutflow << SaveVar();
     }
 
+    *cutflow << rjt::CounterStage("event variables");
+    *cutflow << rjt::InputScope("event");
     *cutflow << NewVar("run"); {
         *cutflow << HFTname("runNumber");
         *cutflow << [&](Superlink* sl, var_int*) -> int {
@@ -826,6 +1078,29 @@ int main(int argc, char* argv[])
         *cutflow << SaveVar();
     }
 
+    *cutflow << NewVar("event number"); {
+        *cutflow << HFTname("eventNumber");
+        *cutflow << [](Superlink* sl, var_double*) -> double {
+            return sl->nt->evt()->eventNumber;
+        };
+        *cutflow << SaveVar();
+    }
+
+    // with --ordered-merge (and --checkpoint) the worker (segment) outputs
+    // are merged back into input order on the global entry number (see
+    // RJTupler/OrderedMerge.h)
+    Long64_t global_entry = 0;
+    bool checkpointed = (rj_options.checkpoint_entries > 0 || rj_options.resume);
+    if(rj_options.ordered_merge || checkpointed) {
+        *cutflow << NewVar("global input entry"); {
+            *cutflow << HFTname("globalEntry");
+            *cutflow << [&](Superlink* /*sl*/, var_double*) -> double {
+                return global_entry;
+            };
+            *cutflow << SaveVar();
+        }
+    }
+
     *cutflow << NewVar("lumi block"); {
         *cutflow << HFTname("lumi_block");
         *cutflow << [](Superlink* sl, var_int*) -> int {
@@ -859,54 +1134,65 @@ int main(int argc, char* argv[])
     }
 
     // standard variables
-    *cutflow << NewVar("event weight"); {
-        *cutflow << HFTname("eventweight");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product() * sl->nt->evt()->wPileup;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight without pileup weight"); {
-        *cutflow << HFTname("eventweightNoPRW");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product();
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight x btag SF"); {
-        *cutflow << HFTname("eventweightbtag");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product() * sl->nt->evt()->wPileup * sl->weights->btagSf;
-        };
-        *cutflow << SaveVar();
-    }
 
-    *cutflow << NewVar("event weight x btag SF NoPRW"); {
-        *cutflow << HFTname("eventweightbtagNoPRW");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product() * sl->weights->btagSf;
-        };
-        *cutflow << SaveVar();
-    }
+    // the weights carry the object scale factors
+    *cutflow << rjt::InputScope("event weights");
+
+    // event weight variants, all computed from a single read of the weight factors
+    rjt::WeightEngine weight_engine;
+    weight_engine.add("eventweight",                    rjt::wf::Pileup);
+    weight_engine.add("eventweightNoPRW",               rjt::wf::Nominal);
+    weight_engine.add("eventweightbtag",                rjt::wf::Pileup | rjt::wf::Btag);
+    weight_engine.add("eventweightbtagNoPRW",           rjt::wf::Btag);
+    weight_engine.add("eventweightBtagJvt",             rjt::wf::Pileup | rjt::wf::Btag | rjt::wf::Jvt);
+    weight_engine.add("eventweightBtagJvtNoPRW",        rjt::wf::Btag | rjt::wf::Jvt);
+    weight_engine.add("eventweight_multi",              rjt::wf::Multi | rjt::wf::Pileup);
+    weight_engine.add("eventweightNoPRW_multi",         rjt::wf::Multi);
+    weight_engine.add("eventweightbtag_multi",          rjt::wf::Multi | rjt::wf::Pileup | rjt::wf::Btag);
+    weight_engine.add("eventweightbtagNoPRW_multi",     rjt::wf::Multi | rjt::wf::Btag);
+    weight_engine.add("eventweightBtagJvt_multi",       rjt::wf::Multi | rjt::wf::Pileup | rjt::wf::Btag | rjt::wf::Jvt);
+    weight_engine.add("eventweightBtagJvtNoPRW_multi",  rjt::wf::Multi | rjt::wf::Btag | rjt::wf::Jvt);
+
+    *cutflow << rjt::Outputs("weights");
+    *cutflow << [&](Superlink* sl, var_void*) {
+        rjt::WeightFactors factors;
+        factors.product = sl->weights->product();
+        factors.product_multi = sl->weights->product_multi();
+        factors.pileup = sl->nt->evt()->wPileup;
+        factors.lepton = sl->weights->lepSf;
+        factors.btag = sl->weights->btagSf;
+        factors.jvt = sl->weights->jvtSf;
+        weight_engine.compute(factors);
+    };
 
-    *cutflow << NewVar("event weight x btag SF x jvtSf"); {
-        *cutflow << HFTname("eventweightBtagJvt");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product() * sl->nt->evt()->wPileup * sl->weights->btagSf * sl->weights->jvtSf;
-        };
-        *cutflow << SaveVar();
+    // every variant is stored as a double branch of its own; array branches
+    // are float, so the 'eventweights' array is only an index of the same
+    // values at float precision, stored next to them
+    const vector<rjt::WeightSpec>& weight_specs = weight_engine.specs();
+    for(size_t iw = 0; iw < weight_specs.size(); iw++) {
+        *cutflow << NewVar("event weight : " + weight_specs[iw].name); {
+            *cutflow << HFTname(weight_specs[iw].name);
+            *cutflow << [&, iw](Superlink* /*sl*/, var_double*) -> double {
+                return weight_engine.value(iw);
+            };
+            *cutflow << SaveVar();
+        }
     }
-
-    *cutflow << NewVar("event weight x btag SF x jvtSf NoPRW"); {
-        *cutflow << HFTname("eventweightBtagJvtNoPRW");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product() * sl->weights->btagSf * sl->weights->jvtSf;
-        };
-        *cutflow << SaveVar();
+    if(rj_options.weight_array) {
+        cout << analysis_name << "    Storing event weight variants also in (float) array branch 'eventweights':" << endl;
+        for(size_t iw = 0; iw < weight_engine.size(); iw++) {
+        cout << analysis_name << "        eventweights[" << iw << "] : " << weight_engine.specs()[iw].name << endl;
+        }
+        *cutflow << NewVar("event weight variants"); {
+            *cutflow << HFTname("eventweights");
+            *cutflow << [&](Superlink* /*sl*/, var_float_array*) -> vector<double> {
+                return weight_engine.values();
+            };
+            *cutflow << SaveVar();
+        }
     }
 
+    *cutflow << rjt::InputScope("event");
     *cutflow << NewVar("Pile-up weight"); {
         *cutflow << HFTname("pupw");
         *cutflow << [](Superlink* sl, var_double*) -> double {
@@ -915,52 +1201,93 @@ int main(int argc, char* argv[])
         *cutflow << SaveVar();
     }
 
-    *cutflow << NewVar("event weight (multi period)"); {
-        *cutflow << HFTname("eventweight_multi");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product_multi() * sl->nt->evt()->wPileup;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight without pileup weight"); {
-        *cutflow << HFTname("eventweightNoPRW_multi");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product_multi();
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight x btag SF"); {
-        *cutflow << HFTname("eventweightbtag_multi");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product_multi() * sl->nt->evt()->wPileup * sl->weights->btagSf;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight x btag SF NoPRW"); {
-        *cutflow << HFTname("eventweightbtagNoPRW_multi");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product_multi() * sl->weights->btagSf;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight x btag SF x jvtSf"); {
-        *cutflow << HFTname("eventweightBtagJvt_multi");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product_multi() * sl->nt->evt()->wPileup * sl->weights->btagSf * sl->weights->jvtSf;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("event weight x btag SF x jvtSf NoPRW"); {
-        *cutflow << HFTname("eventweightBtagJvtNoPRW_multi");
-        *cutflow << [&](Superlink* sl, var_double*) -> double {
-            return sl->weights->product_multi() * sl->weights->btagSf * sl->weights->jvtSf;
-        };
-        *cutflow << SaveVar();
+    // weight systematics, evaluated in the nominal pass as ratios to the
+    // nominal scale factors (those the weight engine has already read for
+    // the event) and stored as branches of the nominal tree. Each ratio
+    // multiplies a weight that contains the scale factor it varies: the
+    // lepton and pile-up variations go on eventweight, the b-tagging and
+    // JVT ones on eventweightBtagJvt.
+    rjt::WeightVariations weight_variations;
+    if(rj_options.weight_syst_array) {
+        const size_t base_nominal = weight_engine.index("eventweight");
+        const size_t base_btag_jvt = weight_engine.index("eventweightBtagJvt");
+        auto lep_sf_ratio = [&](NtSys::SusyNtSys sys) -> rjt::WeightVariations::RatioFunction {
+            return [&, sys](Superlink* sl) -> double {
+                double nom = weight_engine.factors().lepton;
+                return (nom != 0 ? sl->tools->leptonEffSF(*sl->leptons, sys) / nom : 1.0);
+            };
+        };
+        auto btag_sf_ratio = [&](NtSys::SusyNtSys sys) -> rjt::WeightVariations::RatioFunction {
+            return [&, sys](Superlink* sl) -> double {
+                double nom = weight_engine.factors().btag;
+                return (nom != 0 ? sl->tools->bTagSF(*sl->jets, sys) / nom : 1.0);
+            };
+        };
+        auto jvt_sf_ratio = [&](NtSys::SusyNtSys sys) -> rjt::WeightVariations::RatioFunction {
+            return [&, sys](Superlink* sl) -> double {
+                double nom = weight_engine.factors().jvt;
+                return (nom != 0 ? sl->tools->jvtSF(*sl->jets, sys) / nom : 1.0);
+            };
+        };
+
+        // electron eff
+        weight_variations.add("EL_EFF_ID", base_nominal, lep_sf_ratio(NtSys::EL_EFF_ID_TOTAL_Uncorr_UP), lep_sf_ratio(NtSys::EL_EFF_ID_TOTAL_Uncorr_DN));
+        weight_variations.add("EL_EFF_Iso", base_nominal, lep_sf_ratio(NtSys::EL_EFF_Iso_TOTAL_Uncorr_UP), lep_sf_ratio(NtSys::EL_EFF_Iso_TOTAL_Uncorr_DN));
+        weight_variations.add("EL_EFF_Reco", base_nominal, lep_sf_ratio(NtSys::EL_EFF_Reco_TOTAL_Uncorr_UP), lep_sf_ratio(NtSys::EL_EFF_Reco_TOTAL_Uncorr_DN));
+
+        // muon eff
+        weight_variations.add("MUON_EFF_STAT", base_nominal, lep_sf_ratio(NtSys::MUON_EFF_STAT_UP), lep_sf_ratio(NtSys::MUON_EFF_STAT_DN));
+        weight_variations.add("MUON_EFF_STAT_LOWPT", base_nominal, lep_sf_ratio(NtSys::MUON_EFF_STAT_LOWPT_UP), lep_sf_ratio(NtSys::MUON_EFF_STAT_LOWPT_DN));
+        weight_variations.add("MUON_EFF_SYS", base_nominal, lep_sf_ratio(NtSys::MUON_EFF_SYS_UP), lep_sf_ratio(NtSys::MUON_EFF_SYS_DN));
+        weight_variations.add("MUON_EFF_SYS_LOWPT", base_nominal, lep_sf_ratio(NtSys::MUON_EFF_SYS_LOWPT_UP), lep_sf_ratio(NtSys::MUON_EFF_SYS_LOWPT_DN));
+        weight_variations.add("MUON_ISO_STAT", base_nominal, lep_sf_ratio(NtSys::MUON_ISO_STAT_UP), lep_sf_ratio(NtSys::MUON_ISO_STAT_DN));
+        weight_variations.add("MUON_ISO_SYS", base_nominal, lep_sf_ratio(NtSys::MUON_ISO_SYS_UP), lep_sf_ratio(NtSys::MUON_ISO_SYS_DN));
+
+        // flavor tagging eff
+        weight_variations.add("FT_EFF_B", base_btag_jvt, btag_sf_ratio(NtSys::FT_EFF_B_systematics_UP), btag_sf_ratio(NtSys::FT_EFF_B_systematics_DN));
+        weight_variations.add("FT_EFF_C", base_btag_jvt, btag_sf_ratio(NtSys::FT_EFF_C_systematics_UP), btag_sf_ratio(NtSys::FT_EFF_C_systematics_DN));
+        weight_variations.add("FT_EFF_Light", base_btag_jvt, btag_sf_ratio(NtSys::FT_EFF_Light_systematics_UP), btag_sf_ratio(NtSys::FT_EFF_Light_systematics_DN));
+        weight_variations.add("FT_EFF_extrapolation", base_btag_jvt, btag_sf_ratio(NtSys::FT_EFF_extrapolation_UP), btag_sf_ratio(NtSys::FT_EFF_extrapolation_DN));
+        weight_variations.add("FT_EFF_extrapolation_charm", base_btag_jvt, btag_sf_ratio(NtSys::FT_EFF_extrapolation_from_charm_UP), btag_sf_ratio(NtSys::FT_EFF_extrapolation_from_charm_DN));
+
+        // jvt eff
+        weight_variations.add("JET_JVTEff", base_btag_jvt, jvt_sf_ratio(NtSys::JET_JVTEff_UP), jvt_sf_ratio(NtSys::JET_JVTEff_DN));
+
+        // pileup
+        weight_variations.add("PILEUP", base_nominal,
+            [](Superlink* sl) -> double {
+                float w = sl->nt->evt()->wPileup;
+                return (w != 0 ? sl->nt->evt()->wPileup_up / w : 1.0);
+            },
+            [](Superlink* sl) -> double {
+                float w = sl->nt->evt()->wPileup;
+                return (w != 0 ? sl->nt->evt()->wPileup_dn / w : 1.0);
+            });
+
+        // the ratios read the leptons and jets, so in systematic trees
+        // (--syst-diff) they are evaluated for the varied objects
+        *cutflow << rjt::Inputs("weights leptons jets");
+        *cutflow << rjt::Outputs("syst_weights") << [&](Superlink* sl, var_void*) {
+            weight_variations.compute(sl, weight_engine.values());
+        };
+
+        // one double branch 'syst_<name>_UP/DN' per entry
+        vector<string> syst_names = weight_variations.entry_names();
+        cout << analysis_name << "    Storing weight systematics in branches 'syst_<name>':" << endl;
+        for(size_t is = 0; is < syst_names.size(); is++) {
+        cout << analysis_name << "        syst_" << syst_names[is]
+                << " (varied " << weight_engine.specs()[weight_variations.base(is / 2)].name << ")" << endl;
+        }
+        for(size_t is = 0; is < syst_names.size(); is++) {
+            *cutflow << rjt::Inputs("syst_weights");
+            *cutflow << NewVar("weight systematic : " + syst_names[is]); {
+                *cutflow << HFTname("syst_" + syst_names[is]);
+                *cutflow << [&, is](Superlink* /*sl*/, var_double*) -> double {
+                    return weight_variations.values()[is];
+                };
+                *cutflow << SaveVar();
+            }
+        }
     }
 
     *cutflow << NewVar("pile-up weight with period weight divided out"); {
@@ -1085,22 +1412,16 @@ int main(int argc, char* argv[])
         *cutflow << SaveVar();
     }
 
-//    TF1* pu_profile = new TF1("pu_profile", "gausn", -250, 250);
-    TF1 pu_profile("pu_profile", "gausn", -250, 250);
-
     *cutflow << NewVar("pileup density"); {
         *cutflow << HFTname("pileup_density");
-        *cutflow << [&](Superlink* sl, var_float*) -> double {
+        *cutflow << [](Superlink* sl, var_float*) -> double {
             float actual_mu = sl->nt->evt()->actualMu;
             float sigmaZ = sl->nt->evt()->beamPosSigmaZ;
             float beamPosZ = sl->nt->evt()->beamPosZ;
             float pvZ = sl->nt->evt()->pvZ;
 
-            pu_profile.SetParameter(0, actual_mu);
-            pu_profile.SetParameter(1, beamPosZ);
-            pu_profile.SetParameter(2, sigmaZ);
-
-            return pu_profile.Eval(pvZ);
+            // gausn(pvZ) with [0]=actualMu, [1]=beamPosZ, [2]=sigmaZ
+            return rjt::kernels::pileup_density(actual_mu, beamPosZ, sigmaZ, pvZ);
         };
         *cutflow << SaveVar();
     }
@@ -1117,1348 +1438,241 @@ int main(int argc, char* argv[])
     // lepton variables
     // lepton variables
 
-    LeptonVector leptons;
-    ElectronVector electrons;
-    MuonVector muons;
-    *cutflow << [&](Superlink* sl, var_void*) { leptons = *sl->leptons; };
-    *cutflow << [&](Superlink* sl, var_void*) { electrons = *sl->electrons; };
-    *cutflow << [&](Superlink* sl, var_void*) { muons = *sl->muons; };
-
-   *cutflow << NewVar("number of leptons"); {
-       *cutflow << HFTname("nLeptons");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return leptons.size(); };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("number of electrons"); {
-       *cutflow << HFTname("nElectrons");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return electrons.size(); };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("number of muons"); {
-       *cutflow << HFTname("nMuons");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return muons.size(); };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("is an EE event"); {
-       *cutflow << HFTname("isEE");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int  {
-            if(leptons.size()<2) return 0;
-            int val = 0;
-            if(leptons.at(0)->isEle() && leptons.at(1)->isEle()) { val = 1; }
-            else { val = 0; }
-            return val;
-       };
-       *cutflow << SaveVar();
-   }
-
-   *cutflow << NewVar("is an MM event"); {
-       *cutflow << HFTname("isMM");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(leptons.size()<2) return 0;
-            int val = 0;
-            if(leptons.at(0)->isMu() && leptons.at(1)->isMu()) { val = 1; }
-            else { val = 0; }
-            return val;
-       };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("is an EM event"); {
-       *cutflow << HFTname("isEM");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(leptons.size()<2) return 0;
-            int val = 0;
-            if(leptons.at(0)->isEle() && leptons.at(1)->isMu()) { val = 1; }
-            else { val = 0; }
-            return val;
-       };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("is an ME event"); {
-       *cutflow << HFTname("isME");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(leptons.size()<2) return 0;
-            int val = 0;
-            if(leptons.at(0)->isMu() && leptons.at(1)->isEle()) { val = 1; }
-            else { val = 0; }
-            return val;
-       };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("is a SF event"); {
-       *cutflow << HFTname("isSF");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(leptons.size()<2) return 0;
-             int val = 0;
-            if( (leptons.at(0)->isEle() && leptons.at(1)->isEle()) ||
-                (leptons.at(0)->isMu() && leptons.at(1)->isMu()) ) { val = 1; }
-            else { val = 0; }
-             return val;
-       };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("is a DF event"); {
-       *cutflow << HFTname("isDF");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-           if(leptons.size()<2) return 0;
-            int val = 0;
-           if( (leptons.at(0)->isEle() && leptons.at(1)->isMu()) ||
-               (leptons.at(0)->isMu() && leptons.at(1)->isEle()) )  { val = 1; }
-           else { val = 0; }
-            return val;
-       };
-       *cutflow << SaveVar();
-   }
-   *cutflow << NewVar("lepton flavor [EE=0,MM=1,EM=2,ME=3]"); {
-       *cutflow << HFTname("l_flav");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-           if(leptons.size()<2) return -1;
-           bool e0 = leptons.at(0)->isEle();
-           bool e1 = leptons.at(1)->isEle();
-
-           if( e0 && e1 ) { return 0; }
-           else if( !e0 && !e1 ) { return 1; }
-           else if( e0 && !e1 ) { return 2; }
-           else if( !e0 && e1 ) { return 3; }
-           else { return -1; }
-       };
-       *cutflow << SaveVar();
-   }
+    *cutflow << rjt::CounterStage("kinematic variables");
 
-   *cutflow << NewVar("lead lepton flavor [E=0, M=1]"); {
-       *cutflow << HFTname("l0_flav");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-           bool e = leptons.at(0)->isEle();
-           bool m = leptons.at(0)->isMu();
+    // the per-event object copies, and the lepton and jet variables built
+    // from them, are recorded by rjt::StopObjects
+    rjt::StopObjects objects;
+    objects.add_lepton_variables(*cutflow);
+    LeptonVector& leptons = objects.leptons;
+    ElectronVector& electrons = objects.electrons;
+    MuonVector& muons = objects.muons;
 
-           if(e && !m) return 0;
-           if(!e && m) return 1;
-           else { return -1; }
-       };
-       *cutflow << SaveVar();
-   }
+    // jet variables
+    // jet variables
+    // jet variables
 
-   *cutflow << NewVar("sub lead lepton flavor [E=0, M=1]"); {
-       *cutflow << HFTname("l1_flav");
-       *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-           if(leptons.size()<2) return -1;
-           bool e = leptons.at(1)->isEle();
-           bool m = leptons.at(1)->isMu();
-           if(e && !m) return 0;
-           if(!e && m) return 1;
-           else { return -1; }
-       };
-       *cutflow << SaveVar();
-   }
+    objects.add_jet_variables(*cutflow);
+    JetVector& jets = objects.jets;
+    JetVector& bjets = objects.bjets;
+    JetVector& sjets = objects.sjets;
 
-    *cutflow << NewVar("lead lepton q"); {
-        *cutflow << HFTname("l0_q");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int { return leptons.at(0)->q; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lepton q"); {
-        *cutflow << HFTname("l1_q");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(leptons.size()<2) return 0;
-            return leptons.at(1)->q;
+    // met variables
+    // met variables
+    // met variables
+    *cutflow << rjt::InputScope("met");
+    Met met;
+    *cutflow << rjt::Outputs("met") << [&](Superlink* sl, var_void*) { met = *sl->met; };
+    *cutflow << rjt::InputScope("leptons jets bjets sjets met");
+    *cutflow << NewVar("transverse missing energy (Etmiss)"); {
+        *cutflow << HFTname("met");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            double val = met.lv().Pt();
+            return val;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("lead lepton d0"); {
-        *cutflow << HFTname("l0_d0");
+    *cutflow << NewVar("phi coord. of Etmiss"); {
+        *cutflow << HFTname("metPhi");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return leptons.at(0)->d0;
+            double metphi = met.lv().Phi();
+            return metphi;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sublead lepton d0"); {
-        *cutflow << HFTname("l1_d0");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -10;
-            return leptons.at(1)->d0;
-        };
+    *cutflow << NewVar("met TST"); {
+        *cutflow << HFTname("metTST");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return met.softTerm_et; };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("lead lepton d0sig"); {
-        *cutflow << HFTname("l0_d0sig");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->d0sigBSCorr; };
+
+    *cutflow << NewVar("delta phi between dilepton system and met"); {
+        *cutflow << HFTname("dphi_met_ll");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            if(leptons.size()<2) return -5;
+            double dphi = met.lv().DeltaPhi(objects.dilepton());
+            return dphi;
+        };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sublead lepton d0sig"); {
-        *cutflow << HFTname("l1_d0sig");
+
+    // MET terms
+    *cutflow << NewVar("met_ele_et"); {
+        *cutflow << HFTname("met_ele_et");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -10;
-            return leptons.at(1)->d0sigBSCorr;
+            return met.refEle_et;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("lead lepton z0sinTheta"); {
-        *cutflow << HFTname("l0_z0sinTheta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->z0SinTheta(); };
+    *cutflow << NewVar("met_ele_phi"); {
+        *cutflow << HFTname("met_ele_phi");
+        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
+            return met.refEle_phi;
+        };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sublead lepton z0sinTheta"); {
-        *cutflow << HFTname("l1_z0sinTheta");
+    *cutflow << NewVar("met_ele_sumet"); {
+        *cutflow << HFTname("met_ele_sumet");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -10;
-            return leptons.at(1)->z0SinTheta();
+            return met.refEle_sumet;
         };
         *cutflow << SaveVar();
     }
 
-    // electron stuff
-    *cutflow << NewVar("lead electron clusE"); {
-        *cutflow << HFTname("e0_clusE");
+    *cutflow << NewVar("met_jet_et"); {
+        *cutflow << HFTname("met_jet_et");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(0))->clusE;
-            }
-            else { return -1; }
+            return met.refJet_et;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sublead electron clusE"); {
-        *cutflow << HFTname("e1_clusE");
+    *cutflow << NewVar("met_jet_phi"); {
+        *cutflow << HFTname("met_jet_phi");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            if(leptons.at(1)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(1))->clusE;
-            }
-            else { return -1; }
+            return met.refJet_phi;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("lead electron clusEtaBE"); {
-        *cutflow << HFTname("e0_clusEtaBE");
+    *cutflow << NewVar("met_jet_sumet"); {
+        *cutflow << HFTname("met_jet_sumet");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(0))->clusEtaBE;
-            }
-            else { return -5; }
+            return met.refJet_sumet;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sub-lead electron clusEtaBE"); {
-        *cutflow << HFTname("e1_clusEtaBE");
+    *cutflow << NewVar("met_muo_et"); {
+        *cutflow << HFTname("met_muo_et");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(1))->clusEtaBE;
-            }
-            else { return -5; }
+            return met.refMuo_et;
         };
         *cutflow << SaveVar();
     }
-
-    *cutflow << NewVar("lead electron clusPhiBE"); {
-        *cutflow << HFTname("e0_clusPhiBE");
+    *cutflow << NewVar("met_muo_phi"); {
+        *cutflow << HFTname("met_muo_phi");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(0))->clusPhiBE;
-            }
-            else { return -5; }
+            return met.refMuo_phi;
         };
         *cutflow << SaveVar();
     }
-
-    *cutflow << NewVar("sub-lead electron clusPhiBE"); {
-        *cutflow << HFTname("e1_clusPhiBE");
+    *cutflow << NewVar("met_muo_sumet"); {
+        *cutflow << HFTname("met_muo_sumet");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(1))->clusPhiBE;
-            }
-            else { return -5; }
+            return met.refMuo_sumet;
         };
         *cutflow << SaveVar();
     }
-
-    *cutflow << NewVar("lead electron track Pt"); {
-        *cutflow << HFTname("e0_trackPt");
+    *cutflow << NewVar("met_soft_et"); {
+        *cutflow << HFTname("met_soft_et");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(0))->trackPt;
-            }
-            else { return -1; }
+            return met.softTerm_et;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sub-lead electron track Pt"); {
-        *cutflow << HFTname("e1_trackPt");
+    *cutflow << NewVar("met_soft_phi"); {
+        *cutflow << HFTname("met_soft_phi");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            if(leptons.at(1)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(1))->trackPt;
-            }
-            else { return -1; }
+            return met.softTerm_phi;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("lead electron track Eta"); {
-        *cutflow << HFTname("e0_trackEta");
+    *cutflow << NewVar("met_soft_sumet"); {
+        *cutflow << HFTname("met_soft_sumet");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(0))->trackEta;
-            }
-            else { return -5; }
+            return met.softTerm_sumet;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sub-lead electron track Eta"); {
-        *cutflow << HFTname("e1_trackEta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isEle()) {
-                return static_cast<Susy::Electron*>(leptons.at(1))->trackEta;
+
+
+    *cutflow << NewVar("mt2"); {
+        *cutflow << HFTname("mt2");
+        *cutflow << [&](Superlink* sl, var_float*) -> double {
+            double mt2 = -10.0;
+            if(leptons.size() == 2) {
+                mt2 = kin::getMT2(*sl->leptons, *sl->met);
             }
-            else { return -5; }
+            return mt2;
         };
         *cutflow << SaveVar();
     }
 
-    // muon stuff
-    *cutflow << NewVar("lead muon ID track Pt"); {
-        *cutflow << HFTname("mu0_idTrackPt");
+    double meff;
+    *cutflow << rjt::Outputs("meff");
+    *cutflow << NewVar("meff : scalar sum pt of all jets, leptons, and met"); {
+        *cutflow << HFTname("meff");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackPt;
+            meff = 0.0;
+            // met
+            meff += met.lv().Pt();
+            // jets
+            for(unsigned int ij = 0; ij < jets.size(); ij++){
+                meff += jets.at(ij)->Pt();
             }
-            else return -1;
+            // leptons
+            for(unsigned int il=0; il < leptons.size(); il++){
+                meff += leptons.at(il)->Pt();
+            }
+            return meff;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sub lead muon ID track Pt"); {
-        *cutflow << HFTname("mu1_idTrackPt");
+    double meff_S2L;
+    *cutflow << rjt::Outputs("meff_S2L");
+    *cutflow << NewVar("meff S2L : scalar sum pt of leptons, met, and up to two jets"); {
+        *cutflow << HFTname("meff_S2L");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackPt;
+            meff_S2L = 0.0;
+            // met
+            meff_S2L += met.lv().Pt();
+            // leptons
+            for(int il=0; il < (int)leptons.size(); il++){
+                meff_S2L += leptons.at(il)->Pt();
+            }
+            // jets
+            int n_j = 0;
+            for(int ij = 0; ij < (int)jets.size(); ij++){
+                if(n_j < 2) {
+                    meff_S2L += jets.at(ij)->Pt();
+                    n_j++;
+                }
             }
-            else return -1;
+            return meff_S2L;
         };
         *cutflow << SaveVar();
     }
-
-    *cutflow << NewVar("lead muon ID track Eta"); {
-        *cutflow << HFTname("mu0_idTrackEta");
+    *cutflow << rjt::Inputs("meff");
+    *cutflow << NewVar("R1 : met / meff"); {
+        *cutflow << HFTname("R1");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackEta;
+            double R1 = -10.0;
+            if(meff>0.0) {
+                R1 = met.lv().Pt() / meff * 1.0;
             }
-            return -5;
+            return R1;
         };
         *cutflow << SaveVar();
     }
-    *cutflow << NewVar("sublead muon ID track Eta"); {
-        *cutflow << HFTname("mu1_idTrackEta");
+    *cutflow << rjt::Inputs("meff_S2L");
+    *cutflow << NewVar("R1 S2L : met / meff_S2L"); {
+        *cutflow << HFTname("R1_S2L");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackEta;
+            double R1_S2L = -10.0;
+            if(meff_S2L>0.0) {
+                R1_S2L = met.lv().Pt() / (meff_S2L * 1.0);
             }
-            return -5;
+            return R1_S2L;
         };
         *cutflow << SaveVar();
     }
-
-    *cutflow << NewVar("lead muon ID track Phi"); {
-        *cutflow << HFTname("mu0_idTrackPhi");
+    *cutflow << NewVar("R2 : met / (met + l0pt + l1pt)"); {
+        *cutflow << HFTname("R2");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackPhi;
+            double R2 = -10.0;
+            if(leptons.size() == 2) {
+                double denom = met.lv().Pt() + leptons.at(0)->Pt() + leptons.at(1)->Pt();
+                R2 = met.lv().Pt() / denom * 1.0;
             }
-            else { return -5; }
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("sublead muon ID track Phi"); {
-        *cutflow << HFTname("mu1_idTrackPhi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackPhi;
-            }
-            else { return -5; }
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead muon ID q/p"); {
-        *cutflow << HFTname("mu0_idTrackQoverP");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->idTrackQoverP;
-            }
-            else return -5;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead muon ID q/p"); {
-        *cutflow << HFTname("mu1_idTrackQoverP");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->idTrackQoverP;
-            }
-            else return -5;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead muon MS track Pt"); {
-        *cutflow << HFTname("mu0_msTrackPt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackPt;
-            }
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead muon MS track Pt"); {
-        *cutflow << HFTname("mu1_msTrackPt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackPt;
-            }
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead muon MS track Eta"); {
-        *cutflow << HFTname("mu0_msTrackEta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackEta;
-            }
-            return -5;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead muon MS track Eta"); {
-        *cutflow << HFTname("mu1_msTrackEta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackEta;
-            }
-            return -5;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead muon MS track Phi"); {
-        *cutflow << HFTname("mu0_msTrackPhi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackPhi;
-            }
-            else { return -5; }
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("sublead muon MS track Phi"); {
-        *cutflow << HFTname("mu1_msTrackPhi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackPhi;
-            }
-            else { return -5; }
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead muon MS q/p"); {
-        *cutflow << HFTname("mu0_msTrackQoverP");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.at(0)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(0))->msTrackQoverP;
-            }
-            else return -5;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead muon MS q/p"); {
-        *cutflow << HFTname("mu1_msTrackQoverP");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            if(leptons.at(1)->isMu()) {
-                return static_cast<Susy::Muon*>(leptons.at(1))->msTrackQoverP;
-            }
-            else return -5;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead lepton pt"); {
-        *cutflow << HFTname("l0_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return leptons.at(0)->Pt();
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("sublead lepton pt"); {
-        *cutflow << HFTname("l1_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->Pt();
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep topoetcone20"); {
-        *cutflow << HFTname("l0_topoetcone20");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->topoetcone20; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep topoetcone20"); {
-        *cutflow << HFTname("l1_topoetcone20");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->topoetcone20;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep topoetcone30"); {
-        *cutflow << HFTname("l0_topoetcone30");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->topoetcone30; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep topoetcone30"); {
-        *cutflow << HFTname("l1_topoetcone30");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->topoetcone30;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep ptcone20"); {
-        *cutflow << HFTname("l0_ptcone20");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptcone20; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep ptcone20"); {
-        *cutflow << HFTname("l1_ptcone20");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->ptcone20;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep ptcone30"); {
-        *cutflow << HFTname("l0_ptcone30");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptcone30; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep ptcone30"); {
-        *cutflow << HFTname("l1_ptcone30");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->ptcone30;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep ptvarcone20"); {
-        *cutflow << HFTname("l0_ptvarcone20");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptvarcone20; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep ptvarcone20"); {
-        *cutflow << HFTname("l1_ptvarcone20");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->ptvarcone20;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep ptvarcone30"); {
-        *cutflow << HFTname("l0_ptvarcone30");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return leptons.at(0)->ptvarcone30; };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep ptvarcone30"); {
-        *cutflow << HFTname("l1_ptvarcone30");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -1;
-            return leptons.at(1)->ptvarcone30;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep eta"); {
-        *cutflow << HFTname("l0_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return leptons.at(0)->Eta();
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep eta"); {
-        *cutflow << HFTname("l1_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            return leptons.at(1)->Eta();
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead lep phi"); {
-        *cutflow << HFTname("l0_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return leptons.at(0)->Phi();
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sublead lep phi"); {
-        *cutflow << HFTname("l1_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-           if(leptons.size()<2) return -5;
-           return leptons.at(1)->Phi();
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("mll leptons"); {
-        *cutflow << HFTname("mll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double mll = -10.0;
-            if(leptons.size() == 2) {
-                Lepton* l0 = leptons.at(0);
-                Lepton* l1 = leptons.at(1);
-                mll = (*l0 + *l1).M();
-            }
-            return mll;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("dilepton pT"); {
-        *cutflow << HFTname("pTll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double pTll = -10.0;
-            if(leptons.size() == 2) {
-                Lepton* l0 = leptons.at(0);
-                Lepton* l1 = leptons.at(1);
-                pTll = (*l0 + *l1).Pt();
-            }
-            return pTll;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("delta phi between to leptons"); {
-        *cutflow << HFTname("dphi_ll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double dphi = -10.0;
-            if(leptons.size() == 2) {
-                Lepton l0 = *leptons.at(0);
-                Lepton l1 = *leptons.at(1);
-                dphi = l0.DeltaPhi(l1);
-            }
-            return dphi;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("delta eta between two leptons"); {
-        *cutflow << HFTname("deta_ll");
-        *cutflow << [&](Superlink* /* sl */, var_float*) -> double {
-            double deta = -10.0;
-            if(leptons.size() == 2) {
-                Lepton l0 = *leptons.at(0);
-                Lepton l1 = *leptons.at(1);
-                deta = l0.Eta() - l1.Eta();
-            }
-            return deta;
-        };
-        *cutflow << SaveVar();
-    }
-
-    // jet variables
-    // jet variables
-    // jet variables
-
-    JetVector jets;
-    JetVector bjets;
-    JetVector sjets;
-
-    *cutflow << [&](Superlink* sl, var_void*) { jets = *sl->jets; };
-    *cutflow << [&](Superlink* sl, var_void*) {
-        for(int i = 0; i < (int)jets.size(); i++) {
-            Jet* j = jets[i];
-            if(sl->tools->jetSelector().isBJet(j))  bjets.push_back(j);
-            else { sjets.push_back(j); }
-        }// i
-    };
-
-    *cutflow << NewVar("lead jet jvt"); {
-        *cutflow << HFTname("j0_jvt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>0) return jets.at(0)->jvt;
-            else { return -10; }
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead sjet jvt"); {
-        *cutflow << HFTname("sj0_jvt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->jvt;
-            else { return -10; }
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead bjet jvt"); {
-        *cutflow << HFTname("bj0_jvt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>0) return bjets.at(0)->jvt;
-            else { return -10; }
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("jet nTracks"); {
-        *cutflow << HFTname("j0_nTracks");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(jets.size()>0) return jets.at(0)->nTracks;
-            else { return -1; }
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sjet nTracks"); {
-        *cutflow << HFTname("sj0_nTracks");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(sjets.size()>0) return sjets.at(0)->nTracks;
-            else { return -1; }
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("bjet nTracks"); {
-        *cutflow << HFTname("bj0_nTracks");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            if(bjets.size()>0) return bjets.at(0)->nTracks;
-            else { return -1; }
-        };
-        *cutflow << SaveVar();
-    }
-
-
-    *cutflow << NewVar("jet sumTrkPt"); {
-        *cutflow << HFTname("j0_sumTrkPt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>0) return jets.at(0)->sumTrkPt;
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sjet sumTrkPt"); {
-        *cutflow << HFTname("sj0_sumTrkPt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->sumTrkPt;
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("bjet sumTrkPt"); {
-        *cutflow << HFTname("bj0_sumTrkPt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>0) return bjets.at(0)->sumTrkPt;
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("jet mv2c10"); {
-        *cutflow << HFTname("j0_mv2c10");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>0) return jets.at(0)->mv2c10;
-            else return -10;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sjet mv2c10"); {
-        *cutflow << HFTname("sj0_mv2c10");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->mv2c10;
-            else return -10;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("bjet mv2c10"); {
-        *cutflow << HFTname("bj0_mv2c10");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>0) return bjets.at(0)->mv2c10;
-            else return -10;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("jet emfrac"); {
-        *cutflow << HFTname("j0_emfrac");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>0) return jets.at(0)->emfrac;
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sjet emfrac"); {
-        *cutflow << HFTname("sj0_emfrac");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->emfrac;
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("bjet emfrac"); {
-        *cutflow << HFTname("bj0_emfrac");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>0) return bjets.at(0)->emfrac;
-            else return -1;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("number of jets"); {
-        *cutflow << HFTname("nJets");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            return jets.size();
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("number of sjets"); {
-        *cutflow << HFTname("nSJets");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            return sjets.size();
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("number of bjets"); {
-        *cutflow << HFTname("nBJets");
-        *cutflow << [&](Superlink* /*sl*/, var_int*) -> int {
-            return bjets.size();
-        };
-        *cutflow << SaveVar();
-    }
-
-
-    *cutflow << NewVar("lead jet pt"); {
-        *cutflow << HFTname("j0_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10;
-            if(jets.size()>0) val = jets.at(0)->Pt();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead jet pt"); {
-        *cutflow << HFTname("j1_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(jets.size()>1) val = jets.at(1)->Pt();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead jet pt"); {
-        *cutflow << HFTname("j2_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>2) return jets.at(2)->Pt();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead sjet pt"); {
-        *cutflow << HFTname("sj0_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->Pt();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead sjet pt"); {
-        *cutflow << HFTname("sj1_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>1) return sjets.at(1)->Pt();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead sjet pt"); {
-        *cutflow << HFTname("sj2_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>2) return sjets.at(2)->Pt();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead bjet pt"); {
-        *cutflow << HFTname("bj0_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(bjets.size()>0) val = bjets.at(0)->Pt();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead bjet pt"); {
-        *cutflow << HFTname("bj1_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(bjets.size()>1) val = bjets.at(1)->Pt();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead bjet pt"); {
-        *cutflow << HFTname("bj2_pt");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>2) return bjets.at(2)->Pt();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead jet eta"); {
-        *cutflow << HFTname("j0_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(jets.size()>0) val = jets.at(0)->Eta();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead jet eta"); {
-        *cutflow << HFTname("j1_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(jets.size()>1) val = jets.at(1)->Eta();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead jet eta"); {
-        *cutflow << HFTname("j2_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>2)  return jets.at(2)->Eta();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("lead sjet eta"); {
-        *cutflow << HFTname("sj0_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->Eta();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead sjet eta"); {
-        *cutflow << HFTname("sj1_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>1) return sjets.at(1)->Eta();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead sjet eta"); {
-        *cutflow << HFTname("sj2_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>2) return sjets.at(2)->Eta();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("sub lead bjet eta"); {
-        *cutflow << HFTname("bj1_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(bjets.size()>1) val = bjets.at(1)->Eta();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead bjet eta"); {
-        *cutflow << HFTname("bj2_eta");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>2) return bjets.at(2)->Eta();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead jet phi"); {
-        *cutflow << HFTname("j0_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(jets.size()>0) val = jets.at(0)->Phi();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead jet phi"); {
-        *cutflow << HFTname("j1_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(jets.size()>1) val = jets.at(1)->Phi();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead jet phi"); {
-        *cutflow << HFTname("j2_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(jets.size()>2) return jets.at(2)->Phi();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead sjet phi"); {
-        *cutflow << HFTname("sj0_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>0) return sjets.at(0)->Phi();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead sjet phi"); {
-        *cutflow << HFTname("sj1_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>1)  return sjets.at(1)->Phi();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead sjet phi"); {
-        *cutflow << HFTname("sj2_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(sjets.size()>2) return sjets.at(2)->Phi();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("lead bjet phi"); {
-        *cutflow << HFTname("bj0_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(bjets.size()>0) val = bjets.at(0)->Phi();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("sub lead bjet phi"); {
-        *cutflow << HFTname("bj1_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            float val = -10.;
-            if(bjets.size()>1) val = bjets.at(1)->Phi();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("third lead bjet phi"); {
-        *cutflow << HFTname("bj2_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(bjets.size()>2) return bjets.at(2)->Phi();
-            else return -10.;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("delta phi between dilepton system and leading jet"); {
-        *cutflow << HFTname("dphi_j0_ll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double out = -10.;
-            if(jets.size()>0 && leptons.size()>=2) {
-                TLorentzVector l0, l1, ll;
-                l0.SetPtEtaPhiM(leptons.at(0)->Pt(), leptons.at(0)->Eta(), leptons.at(0)->Phi(), leptons.at(0)->M());
-                l1.SetPtEtaPhiM(leptons.at(1)->Pt(), leptons.at(1)->Eta(), leptons.at(1)->Phi(), leptons.at(1)->M());
-                ll = l0 + l1;
-                out = jets.at(0)->DeltaPhi(ll);
-            }
-            return out;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("delta phi between leading lepton and leading sjet"); {
-        *cutflow << HFTname("dphi_j0_l0");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double out = -10.;
-            if(jets.size()>0) {
-                out = jets.at(0)->DeltaPhi(*leptons.at(0));
-            }
-            return out;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("delta phi between dilepton system and leading sjet"); {
-        *cutflow << HFTname("dphi_sj0_ll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double out = -10;
-            if(sjets.size()>0 && leptons.size()>=2) {
-                TLorentzVector l0, l1, ll;
-                l0.SetPtEtaPhiM(leptons.at(0)->Pt(), leptons.at(0)->Eta(), leptons.at(0)->Phi(), leptons.at(0)->M());
-                l1.SetPtEtaPhiM(leptons.at(1)->Pt(), leptons.at(1)->Eta(), leptons.at(1)->Phi(), leptons.at(1)->M());
-                ll = l0 + l1;
-                out = sjets.at(0)->DeltaPhi(ll);
-            }
-            return out;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("delta phi between leading lepton and leading sjet"); {
-        *cutflow << HFTname("dphi_sj0_l0");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double out = -10;
-            if(sjets.size()>0) {
-                out = sjets.at(0)->DeltaPhi(*leptons.at(0));
-            }
-            return out;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("delta phi between dilepton system and leading bjet"); {
-        *cutflow << HFTname("dphi_bj0_ll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double out = -10.;
-            if(bjets.size()>0 && leptons.size()>=2) {
-                TLorentzVector l0, l1, ll;
-                l0.SetPtEtaPhiM(leptons.at(0)->Pt(), leptons.at(0)->Eta(), leptons.at(0)->Phi(), leptons.at(0)->M());
-                l1.SetPtEtaPhiM(leptons.at(1)->Pt(), leptons.at(1)->Eta(), leptons.at(1)->Phi(), leptons.at(1)->M());
-                ll = l0 + l1;
-                out = bjets.at(0)->DeltaPhi(ll);
-            }
-            return out;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("delta phi between leading lepton and leading bjet"); {
-        *cutflow << HFTname("dphi_bj0_l0");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double out = -10.;
-            if(bjets.size()>0) {
-                out = bjets.at(0)->DeltaPhi(*leptons.at(0));
-            }
-            return out;
-        };
-        *cutflow << SaveVar();
-    }
-    // met variables
-    // met variables
-    // met variables
-    Met met;
-    *cutflow << [&](Superlink* sl, var_void*) { met = *sl->met; };
-    *cutflow << NewVar("transverse missing energy (Etmiss)"); {
-        *cutflow << HFTname("met");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double val = met.lv().Pt();
-            return val;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("phi coord. of Etmiss"); {
-        *cutflow << HFTname("metPhi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double metphi = met.lv().Phi();
-            return metphi;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met TST"); {
-        *cutflow << HFTname("metTST");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double { return met.softTerm_et; };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("delta phi between dilepton system and met"); {
-        *cutflow << HFTname("dphi_met_ll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            TLorentzVector l0, l1, ll;
-            l0.SetPtEtaPhiM(leptons.at(0)->Pt(), leptons.at(0)->Eta(), leptons.at(0)->Phi(), leptons.at(0)->M());
-            l1.SetPtEtaPhiM(leptons.at(1)->Pt(), leptons.at(1)->Eta(), leptons.at(1)->Phi(), leptons.at(1)->M());
-            ll = l0 + l1;
-            double dphi = met.lv().DeltaPhi(ll);
-            return dphi;
-        };
-        *cutflow << SaveVar();
-    }
-
-    // MET terms
-    *cutflow << NewVar("met_ele_et"); {
-        *cutflow << HFTname("met_ele_et");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refEle_et;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_ele_phi"); {
-        *cutflow << HFTname("met_ele_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refEle_phi;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_ele_sumet"); {
-        *cutflow << HFTname("met_ele_sumet");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refEle_sumet;
-        };
-        *cutflow << SaveVar();
-    }
-
-    *cutflow << NewVar("met_jet_et"); {
-        *cutflow << HFTname("met_jet_et");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refJet_et;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_jet_phi"); {
-        *cutflow << HFTname("met_jet_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refJet_phi;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_jet_sumet"); {
-        *cutflow << HFTname("met_jet_sumet");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refJet_sumet;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_muo_et"); {
-        *cutflow << HFTname("met_muo_et");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refMuo_et;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_muo_phi"); {
-        *cutflow << HFTname("met_muo_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refMuo_phi;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_muo_sumet"); {
-        *cutflow << HFTname("met_muo_sumet");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.refMuo_sumet;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_soft_et"); {
-        *cutflow << HFTname("met_soft_et");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.softTerm_et;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_soft_phi"); {
-        *cutflow << HFTname("met_soft_phi");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.softTerm_phi;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("met_soft_sumet"); {
-        *cutflow << HFTname("met_soft_sumet");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return met.softTerm_sumet;
-        };
-        *cutflow << SaveVar();
-    }
-
-
-    *cutflow << NewVar("mt2"); {
-        *cutflow << HFTname("mt2");
-        *cutflow << [&](Superlink* sl, var_float*) -> double {
-            double mt2 = -10.0;
-            if(leptons.size() == 2) {
-                mt2 = kin::getMT2(*sl->leptons, *sl->met);
-            }
-            return mt2;
-        };
-        *cutflow << SaveVar();
-    }
-
-    double meff;
-    *cutflow << NewVar("meff : scalar sum pt of all jets, leptons, and met"); {
-        *cutflow << HFTname("meff");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            meff = 0.0;
-            // met
-            meff += met.lv().Pt();
-            // jets
-            for(unsigned int ij = 0; ij < jets.size(); ij++){
-                meff += jets.at(ij)->Pt();
-            }
-            // leptons
-            for(unsigned int il=0; il < leptons.size(); il++){
-                meff += leptons.at(il)->Pt();
-            }
-            return meff;
-        };
-        *cutflow << SaveVar();
-    }
-    double meff_S2L;
-    *cutflow << NewVar("meff S2L : scalar sum pt of leptons, met, and up to two jets"); {
-        *cutflow << HFTname("meff_S2L");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            meff_S2L = 0.0;
-            // met
-            meff_S2L += met.lv().Pt();
-            // leptons
-            for(int il=0; il < (int)leptons.size(); il++){
-                meff_S2L += leptons.at(il)->Pt();
-            }
-            // jets
-            int n_j = 0;
-            for(int ij = 0; ij < (int)jets.size(); ij++){
-                if(n_j < 2) {
-                    meff_S2L += jets.at(ij)->Pt();
-                    n_j++;
-                }
-            }
-            return meff_S2L;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("R1 : met / meff"); {
-        *cutflow << HFTname("R1");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double R1 = -10.0;
-            if(meff>0.0) {
-                R1 = met.lv().Pt() / meff * 1.0;
-            }
-            return R1;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("R1 S2L : met / meff_S2L"); {
-        *cutflow << HFTname("R1_S2L");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double R1_S2L = -10.0;
-            if(meff_S2L>0.0) {
-                R1_S2L = met.lv().Pt() / (meff_S2L * 1.0);
-            }
-            return R1_S2L;
-        };
-        *cutflow << SaveVar();
-    }
-    *cutflow << NewVar("R2 : met / (met + l0pt + l1pt)"); {
-        *cutflow << HFTname("R2");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            double R2 = -10.0;
-            if(leptons.size() == 2) {
-                double denom = met.lv().Pt() + leptons.at(0)->Pt() + leptons.at(1)->Pt();
-                R2 = met.lv().Pt() / denom * 1.0;
-            }
-            return R2;
+            return R2;
         };
         *cutflow << SaveVar();
     }
@@ -2508,7 +1722,7 @@ int main(int argc, char* argv[])
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
             double mbb = -10.;
             if(bjets.size()>=2) {
-                mbb = (*bjets.at(0) + *bjets.at(1)).M();
+                mbb = objects.dibjet().M();
             }
             return mbb;
         };
@@ -2535,10 +1749,8 @@ int main(int argc, char* argv[])
             if(bjets.size()>=2 && leptons.size()>=2) {
                 TLorentzVector l0 = (*leptons.at(0));
                 TLorentzVector l1 = (*leptons.at(1));
-                TLorentzVector b0 = (*bjets.at(0));
-                TLorentzVector b1 = (*bjets.at(1));
 
-                return ( (l0 + l1).DeltaR( (b0 + b1) ) );
+                return ( (l0 + l1).DeltaR( objects.dibjet() ) );
             }
             return -10.;
         };
@@ -2550,7 +1762,7 @@ int main(int argc, char* argv[])
         *cutflow << HFTname("dphi_ll_bb");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
             if(bjets.size()>=2 && leptons.size()>=2) {
-                return ( (*bjets.at(0) + *bjets.at(1)).DeltaPhi( (*leptons.at(0) + *leptons.at(1)) ) );
+                return ( objects.dibjet().DeltaPhi( (*leptons.at(0) + *leptons.at(1)) ) );
             }
             return -10.;
         };
@@ -2562,22 +1774,14 @@ int main(int argc, char* argv[])
         *cutflow << HFTname("dphi_WW_bb");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
             if(bjets.size()>=2 && leptons.size()>=2) {
-                return ( (met.lv() + *leptons.at(0) + *leptons.at(1)).DeltaPhi( (*bjets.at(0) + *bjets.at(1)) ) );
+                return ( (met.lv() + *leptons.at(0) + *leptons.at(1)).DeltaPhi( objects.dibjet() ) );
             }
             return -10.;
         };
         *cutflow << SaveVar();
     }
 
-    // dphi_met_ll
-    *cutflow << NewVar("delta phi between MET and dilepton system"); {
-        *cutflow << HFTname("dphi_met_ll");
-        *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            if(leptons.size()<2) return -5;
-            return ( (met.lv().DeltaPhi( (*leptons.at(0) + *leptons.at(1)) )) );
-        };
-        *cutflow << SaveVar();
-    }
+    // dphi_met_ll : stored with the met variables above
 
     // mass_met_ll
     *cutflow << NewVar("mass of met and dilepton system"); {
@@ -2630,7 +1834,7 @@ int main(int argc, char* argv[])
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
             float out = -10.;
             if(bjets.size()>=2 && leptons.size()>=2) {
-                double HT2 = ( (*bjets.at(0) + *bjets.at(1)).Pt() +
+                double HT2 = ( objects.dibjet().Pt() +
                     (*leptons.at(0) + *leptons.at(1) + met.lv()).Pt() );
                 out = HT2;
             }
@@ -2644,7 +1848,7 @@ int main(int argc, char* argv[])
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
             float out = -10.;
             if(bjets.size()>=2 && leptons.size()>=2) {
-                double num = ( (*bjets.at(0) + *bjets.at(1)).Pt() +
+                double num = ( objects.dibjet().Pt() +
                     (*leptons.at(0) + *leptons.at(1) + met.lv()).Pt() );
 
                 double den = ((*bjets.at(0)).Pt());
@@ -2675,238 +1879,22 @@ int main(int argc, char* argv[])
     }
 
     // RESTFRAMES BEGIN
-    LabRecoFrame lab("lab", "lab");
-    DecayRecoFrame ss("ss", "ss");
-    DecayRecoFrame s1("s1", "s1");
-    DecayRecoFrame s2("s2", "s2");
-    VisibleRecoFrame v1("v1", "v1");
-    VisibleRecoFrame v2("v2", "v2");
-    InvisibleRecoFrame i1("i1", "i1");
-    InvisibleRecoFrame i2("i2", "i2");
-
-    // connect thte frames
-    lab.SetChildFrame(ss);
-    ss.AddChildFrame(s1);
-    ss.AddChildFrame(s2);
-    s1.AddChildFrame(i1);
-    s1.AddChildFrame(v1);
-    s2.AddChildFrame(i2);
-    s2.AddChildFrame(v2);
-
-    if(!lab.InitializeTree()) {
-        cout << options.ana_name << "    RestFrames::InitializeTree ERROR (" << __LINE__ << ") Unable to initialize tree from lab frame. Exitting." << endl;
-        exit(1);
-    }
-    InvisibleGroup inv("inv", "invisible group jigsaws");
-    inv.AddFrame(i1);
-    inv.AddFrame(i2);
-
-    CombinatoricGroup vis("vis", "visible object jigsaws");
-    vis.AddFrame(v1);
-    vis.SetNElementsForFrame(v1, 1, false);
-    vis.AddFrame(v2);
-    vis.SetNElementsForFrame(v2, 1, false);
-
-    SetMassInvJigsaw MinMassJigsaw("MinMass", "Invisible system mass jigsaw");
-    inv.AddJigsaw(MinMassJigsaw);
-
-    SetRapidityInvJigsaw RapidityJigsaw("RapidityJigsaw", "Invisible system rapidity jigsaw");
-    inv.AddJigsaw(RapidityJigsaw);
-    RapidityJigsaw.AddVisibleFrames(lab.GetListVisibleFrames());
-
-    ContraBoostInvJigsaw ContraBoostJigsaw("ContraBoostJigsaw", "ContraBoost Invariant Jigsaw");
-    inv.AddJigsaw(ContraBoostJigsaw);
-    ContraBoostJigsaw.AddVisibleFrames((s1.GetListVisibleFrames()), 0);
-    ContraBoostJigsaw.AddVisibleFrames((s2.GetListVisibleFrames()), 1);
-    ContraBoostJigsaw.AddInvisibleFrame(i1, 0);
-    ContraBoostJigsaw.AddInvisibleFrame(i2, 1);
-
-    MinMassesCombJigsaw HemiJigsaw("hemi_jigsaw", "Minimize m_{v_{1,2}} jigsaw");
-    vis.AddJigsaw(HemiJigsaw);
-    HemiJigsaw.AddFrame(v1, 0);
-    HemiJigsaw.AddFrame(v2, 1);
-
-    if(!lab.InitializeAnalysis()) {
-        cout << options.ana_name << "    RestFrames::InitializeAnalysis ERROR (" << __LINE__ << ") Unable to initialize analysis from lab frame. Exiting." << endl;
+    // the decay tree and the variables computed from it live in rjt::StopRJTree
+    rjt::StopRJTree rj;
+    if(!rj.initialize()) {
+        cout << options.ana_name << "    ERROR (" << __LINE__ << ") Unable to initialize the RestFrames tree. Exiting." << endl;
         exit(1);
     }
 
-    double H_11_SS;
-    double H_21_SS;
-    double H_12_SS;
-    double H_22_SS;
-    double H_11_S1;
-    double H_11_SS_T;
-    double H_21_SS_T;
-    double H_22_SS_T;
-    double H_11_S1_T;
-    double shat;
-    double pTT_T;
-    double pTT_Z;
-    double RPT;
-    double RPT_H_11_SS;
-    double RPT_H_21_SS;
-    double RPT_H_22_SS;
-    double RPZ_H_11_SS;
-    double RPZ_H_21_SS;
-    double RPZ_H_22_SS;
-    double RPT_H_11_SS_T;
-    double RPT_H_21_SS_T;
-    double RPT_H_22_SS_T;
-    double RPZ;
-    double RPZ_H_11_SS_T;
-    double RPZ_H_21_SS_T;
-    double RPZ_H_22_SS_T;
-    double gamInvRp1;
-    double MDR;
-    double costheta_SS;
-    double dphi_v_SS;
-    double DPB_vSS;
-    double cosB_1;
-    double cosB_2;
-    double cosB_3;
-    double cosB_4;
-    double dphi_v1_i1_ss;
-    double dphi_s1_s2_ss;
-    double dphiS_I_ss;
-    double dphiS_I_s1;
-
+    *cutflow << rjt::CounterStage("restframes");
+    *cutflow << rjt::InputScope("leptons met");
+    *cutflow << rjt::Outputs("restframes");
     *cutflow << [&](Superlink* sl, var_void*) {
-
-        // clear the tree on each event
-        lab.ClearEvent();
-
-        // set the met
         TVector3 met3vector(sl->met->lv().Px(), sl->met->lv().Py(), sl->met->lv().Pz());
-        inv.SetLabFrameThreeVector(met3vector);
-
-        // add leptons to the visible group
-        vis.AddLabFrameFourVector(*leptons.at(0));
-        vis.AddLabFrameFourVector(*leptons.at(1));
-
-        // analyze the event
-        lab.AnalyzeEvent();
-
-        //////////////////////////////
-        // HT variables -- SS frame
-        //////////////////////////////
-
-        // H_1_1^SS
-        TLorentzVector tlv_v1_ss = v1.GetFourVector(ss);
-        TLorentzVector tlv_v2_ss = v2.GetFourVector(ss);
-        TLorentzVector tlv_i1_ss = i1.GetFourVector(ss);
-        TLorentzVector tlv_i2_ss = i2.GetFourVector(ss);
-
-        TVector3 p_v1_ss = tlv_v1_ss.Vect();
-        TVector3 p_v2_ss = tlv_v2_ss.Vect();
-        TVector3 p_i1_ss = tlv_i1_ss.Vect();
-        TVector3 p_i2_ss = tlv_i2_ss.Vect();
-
-        TVector3 p_v_ss = p_v1_ss + p_v2_ss;
-        TVector3 p_i_ss = p_i1_ss + p_i2_ss;
-
-        H_11_SS = p_v_ss.Mag() + p_i_ss.Mag();
-
-        // H_2_1^SS
-        H_21_SS = p_v1_ss.Mag() + p_v2_ss.Mag() + p_i_ss.Mag();
-
-        // H_1_2^SS
-        H_12_SS = p_v_ss.Mag() + p_i1_ss.Mag() + p_i2_ss.Mag();
-
-        // H_2_2^SS
-        H_22_SS = p_v1_ss.Mag() + p_v2_ss.Mag() + p_i1_ss.Mag() + p_i2_ss.Mag();
-
-        //////////////////////////////
-        // HT variables -- S1 frame
-        //////////////////////////////
-        TLorentzVector tlv_v1_s1 = v1.GetFourVector(s1);
-        TLorentzVector tlv_i1_s1 = i1.GetFourVector(s1);
-
-        TVector3 p_v1_s1 = tlv_v1_s1.Vect();
-        TVector3 p_i1_s1 = tlv_i1_s1.Vect();
-
-        H_11_S1 = p_v1_s1.Mag() + p_i1_s1.Mag();
-
-        ///////////////////////////////
-        // transverse scale variables
-        ///////////////////////////////
-        TVector3 tp_v1_ss = tlv_v1_ss.Vect(); tp_v1_ss.SetZ(0.);
-        TVector3 tp_v2_ss = tlv_v2_ss.Vect(); tp_v2_ss.SetZ(0.);
-        TVector3 tp_i1_ss = tlv_i1_ss.Vect(); tp_i1_ss.SetZ(0.);
-        TVector3 tp_i2_ss = tlv_i2_ss.Vect(); tp_i2_ss.SetZ(0.);
-        TVector3 tp_v1_s1 = tlv_v1_s1.Vect(); tp_v1_s1.SetZ(0.);
-        TVector3 tp_i1_s1 = tlv_i1_s1.Vect(); tp_i1_s1.SetZ(0.);
-
-        H_11_SS_T = (tp_v1_ss + tp_v2_ss).Mag() + (tp_i1_ss + tp_i2_ss).Mag();
-        H_21_SS_T = tp_v1_ss.Mag() + tp_v2_ss.Mag() + (tp_i1_ss + tp_i2_ss).Mag();
-        H_22_SS_T = tp_v1_ss.Mag() + tp_v2_ss.Mag() + tp_i1_ss.Mag() + tp_i2_ss.Mag();
-        H_11_S1_T = tp_v1_s1.Mag() + tp_i1_s1.Mag();
-
-        /// system mass
-        shat = ss.GetMass();
-
-        //////////////////////
-        // RATIO OF CM pT
-        TVector3 vPTT = ss.GetFourVector(lab).Vect();
-        pTT_T = vPTT.Pt();
-        pTT_Z = vPTT.Pz();
-        RPT = vPTT.Pt() / (vPTT.Pt() + shat / 4.);
-        RPZ = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + shat / 4.);
-
-        RPT_H_11_SS = vPTT.Pt() / (vPTT.Pt() + H_11_SS/4.);
-        RPT_H_21_SS = vPTT.Pt() / (vPTT.Pt() + H_21_SS/4.);
-        RPT_H_22_SS = vPTT.Pt() / (vPTT.Pt() + H_22_SS/4.);
-        RPZ_H_11_SS = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_11_SS/4.);
-        RPZ_H_21_SS = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_21_SS/4.);
-        RPZ_H_22_SS = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_22_SS/4.);
-
-        RPT_H_11_SS_T = vPTT.Pt() / (vPTT.Pt() + H_11_SS_T/4.);
-        RPT_H_21_SS_T = vPTT.Pt() / (vPTT.Pt() + H_21_SS_T/4.);
-        RPT_H_22_SS_T = vPTT.Pt() / (vPTT.Pt() + H_22_SS_T/4.);
-        RPZ_H_11_SS_T = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_11_SS_T/4.);
-        RPZ_H_21_SS_T = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_21_SS_T/4.);
-        RPZ_H_22_SS_T = fabs(vPTT.Pz()) / (fabs(vPTT.Pz()) + H_22_SS_T/4.);
-
-        //////////////////////
-        // shapes
-        gamInvRp1 = ss.GetVisibleShape();
-
-        //////////////////////
-        // MDR
-        MDR = 2.0 * v1.GetEnergy(s1);
-
-        /////////////////////
-        // ANGLES
-        costheta_SS = ss.GetCosDecayAngle();
-        dphi_v_SS = ss.GetDeltaPhiVisible();
-
-        // costhetaB emulatur
-        TVector3 v_s = s1.GetFourVector(ss).Vect().Unit();
-        TVector3 v_v = v1.GetFourVector(s1).Vect().Unit();
-        cosB_1 = v_s.Dot(v_v);
-
-        cosB_2 = v1.GetCosDecayAngle(s1);
-
-        cosB_3 = v1.GetCosDecayAngle(ss);
-
-        TVector3 v_v2 = v1.GetFourVector(ss).Vect().Unit();
-        cosB_4 = v_s.Dot(v_v2);
-
-        // angle between invisible
-        dphi_v1_i1_ss = -1.;//v1.GetFourVector(ss).DeltaPhi(i1.GetFourVector(ss));
-        dphi_s1_s2_ss = -1.;//s1.GetFourVector(ss).DeltaPhi(s2.GetFourVector(ss));
-
-
-        dphiS_I_ss = -1.;//s1.GetFourVector(ss).DeltaPhi(i1.GetFourVector(ss));
-        dphiS_I_s1 = -1.;//s1.GetFourVector(ss).DeltaPhi(i1.GetFourVector(s1));
-
-
-
-        ////////////////////
-        // BOOST ANGLES
-        DPB_vSS = ss.GetDeltaPhiBoostVisible();
+        rj.analyze(met3vector, *leptons.at(0), *leptons.at(1));
     };
 
+    *cutflow << rjt::CounterStage("kinematic variables");
     *cutflow << NewVar("gamInvRp1_KIN"); {
         *cutflow << HFTname("gamInvRp1_KIN");
         *cutflow <<[&](Superlink* sl, var_float*) -> double {
@@ -2978,38 +1966,40 @@ int main(int argc, char* argv[])
 
 
 
+    *cutflow << rjt::CounterStage("restframes");
+    *cutflow << rjt::InputScope("leptons met restframes");
     *cutflow << NewVar("HT : H_11_SS"); {
         *cutflow << HFTname("H_11_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_11_SS;
+            return rj.H_11_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("HT : H_21_SS"); {
         *cutflow << HFTname("H_21_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_21_SS;
+            return rj.H_21_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("HT : H_12_SS"); {
         *cutflow << HFTname("H_12_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_12_SS;
+            return rj.H_12_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("HT : H_22_SS"); {
         *cutflow << HFTname("H_22_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_22_SS;
+            return rj.H_22_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("HT : H_11_S1"); {
         *cutflow << HFTname("H_11_S1");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_11_S1;
+            return rj.H_11_S1;
         };
         *cutflow << SaveVar();
     }
@@ -3017,105 +2007,105 @@ int main(int argc, char* argv[])
     *cutflow << NewVar("H_11_SS_T"); {
         *cutflow << HFTname("H_11_SS_T");
         *cutflow <<[&](Superlink* /*sl*/, var_float*) -> double {
-            return H_11_SS_T;
+            return rj.H_11_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("H_21_SS_T"); {
         *cutflow << HFTname("H_21_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_21_SS_T;
+            return rj.H_21_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("H_22_SS_T"); {
         *cutflow << HFTname("H_22_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_22_SS_T;
+            return rj.H_22_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("H_11_S1_T"); {
         *cutflow << HFTname("H_11_S1_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return H_11_S1_T;
+            return rj.H_11_S1_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("shat"); {
         *cutflow << HFTname("shat");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return shat;
+            return rj.shat;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("pTT_T"); {
         *cutflow << HFTname("pTT_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return pTT_T;
+            return rj.pTT_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("pTT_Z"); {
         *cutflow << HFTname("pTT_Z");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return pTT_Z;
+            return rj.pTT_Z;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPT"); {
         *cutflow << HFTname("RPT");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT;
+            return rj.RPT;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ"); {
         *cutflow << HFTname("RPZ");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ;
+            return rj.RPZ;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPT_H_11_SS"); {
         *cutflow << HFTname("RPT_H_11_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT_H_11_SS;
+            return rj.RPT_H_11_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPT_H_21_SS"); {
         *cutflow << HFTname("RPT_H_21_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT_H_21_SS;
+            return rj.RPT_H_21_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPT_H_22_SS"); {
         *cutflow << HFTname("RPT_H_22_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT_H_22_SS;
+            return rj.RPT_H_22_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ_H_11_SS"); {
         *cutflow << HFTname("RPZ_H_11_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ_H_11_SS;
+            return rj.RPZ_H_11_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ_H_21_SS"); {
         *cutflow << HFTname("RPZ_H_21_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ_H_21_SS;
+            return rj.RPZ_H_21_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ_H_22_SS"); {
         *cutflow << HFTname("RPZ_H_22_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ_H_22_SS;
+            return rj.RPZ_H_22_SS;
         };
         *cutflow << SaveVar();
     }
@@ -3123,42 +2113,42 @@ int main(int argc, char* argv[])
     *cutflow << NewVar("RPT_H_11_SS_T"); {
         *cutflow << HFTname("RPT_H_11_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT_H_11_SS_T;
+            return rj.RPT_H_11_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPT_H_21_SS_T"); {
         *cutflow << HFTname("RPT_H_21_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT_H_21_SS_T;
+            return rj.RPT_H_21_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPT_H_22_SS_T"); {
         *cutflow << HFTname("RPT_H_22_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPT_H_22_SS_T;
+            return rj.RPT_H_22_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ_H_11_SS_T"); {
         *cutflow << HFTname("RPZ_H_11_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ_H_11_SS_T;
+            return rj.RPZ_H_11_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ_H_21_SS_T"); {
         *cutflow << HFTname("RPZ_H_21_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ_H_21_SS_T;
+            return rj.RPZ_H_21_SS_T;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("RPZ_H_22_SS_T"); {
         *cutflow << HFTname("RPZ_H_22_SS_T");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return RPZ_H_22_SS_T;
+            return rj.RPZ_H_22_SS_T;
         };
         *cutflow << SaveVar();
     }
@@ -3166,28 +2156,28 @@ int main(int argc, char* argv[])
     *cutflow << NewVar("gamInvRp1"); {
         *cutflow << HFTname("gamInvRp1");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return gamInvRp1;
+            return rj.gamInvRp1;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("MDR"); {
         *cutflow << HFTname("MDR");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return MDR;
+            return rj.MDR;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("costheta_SS"); {
         *cutflow << HFTname("costheta_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return costheta_SS;
+            return rj.costheta_SS;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("dphi_v_SS"); {
         *cutflow << HFTname("dphi_v_SS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return dphi_v_SS;
+            return rj.dphi_v_SS;
         };
         *cutflow << SaveVar();
     }
@@ -3195,14 +2185,14 @@ int main(int argc, char* argv[])
     *cutflow << NewVar("dphiS_I_SS"); {
         *cutflow << HFTname("dphiS_I_ss");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return dphiS_I_ss;
+            return rj.dphiS_I_ss;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("dphiS_I_s1"); {
         *cutflow << HFTname("dphiS_I_s1");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return dphiS_I_s1;
+            return rj.dphiS_I_s1;
         };
         *cutflow << SaveVar();
     }
@@ -3223,27 +2213,29 @@ int main(int argc, char* argv[])
     *cutflow << NewVar("delta phi between visible & invisible in SS frame"); {
         *cutflow << HFTname("dphi_v1_i1_ss");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return dphi_v1_i1_ss;
+            return rj.dphi_v1_i1_ss;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("delta phi between s1 and s2 in SS frame"); {
         *cutflow << HFTname("dphi_s1_s2_ss");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return dphi_s1_s2_ss;
+            return rj.dphi_s1_s2_ss;
         };
         *cutflow << SaveVar();
     }
     *cutflow << NewVar("DPB_vSS"); {
         *cutflow << HFTname("DPB_vSS");
         *cutflow << [&](Superlink* /*sl*/, var_float*) -> double {
-            return DPB_vSS;
+            return rj.DPB_vSS;
         };
         *cutflow << SaveVar();
     }
 
 
     // clear the wectors
+    *cutflow << rjt::CounterStage("output fill");
+    *cutflow << rjt::InputScope("");
     *cutflow << [&](Superlink* /* sl */, var_void*) { leptons.clear(); };
     *cutflow << [&](Superlink* /* sl */, var_void*) { electrons.clear(); };
     *cutflow << [&](Superlink* /* sl */, var_void*) { muons.clear(); };
@@ -3251,6 +2243,10 @@ int main(int argc, char* argv[])
     *cutflow << [&](Superlink* /* sl */, var_void*) { bjets.clear(); };
     *cutflow << [&](Superlink* /* sl */, var_void*) { sjets.clear(); };
     *cutflow << [&](Superlink* /* sl */, var_void*) { met.clear(); };
+    *cutflow << [&](Superlink* /* sl */, var_void*) { objects.end_event(); };
+
+    // whatever follows the last variable is the output fill
+    *cutflow << [&](Superlink* /* sl */, var_void*) { if(clock) clock->enter(rjt::StageClock::Fill); };
 
 
     ////////////////////////////////////////////////////////////////////////
@@ -3268,213 +2264,36 @@ int main(int argc, char* argv[])
     // weight systematics
     ////////////////////////////////////
 
-//    // electron eff
-//    *cutflow << NewSystematic("shift in electron ID efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::EL_EFF_ID_UP, SupersysWeight::EL_EFF_ID_DN);
-//        *cutflow << TreeName("EL_EFF_ID");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in electron ISO efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::EL_EFF_ISO_UP, SupersysWeight::EL_EFF_ISO_DN);
-//        *cutflow << TreeName("EL_EFF_Iso");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in electron RECO efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::EL_EFF_RECO_UP, SupersysWeight::EL_EFF_RECO_DN);
-//        *cutflow << TreeName("EL_EFF_Reco");
-//        *cutflow << SaveSystematic();
-//    }
-//
-//    // muon eff
-//    *cutflow << NewSystematic("muon eff stat uncertainty"); {
-//        *cutflow << WeightSystematic(SupersysWeight::MUON_EFF_STAT_UP, SupersysWeight::MUON_EFF_STAT_DN);
-//        *cutflow << TreeName("MUON_EFF_STAT");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon eff stat uncertainty (low pt)"); {
-//        *cutflow << WeightSystematic(SupersysWeight::MUON_EFF_STAT_LOWPT_UP, SupersysWeight::MUON_EFF_STAT_LOWPT_DN);
-//        *cutflow << TreeName("MUON_EFF_STAT_LOWPT");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon eff syst uncertainty"); {
-//        *cutflow << WeightSystematic(SupersysWeight::MUON_EFF_SYS_UP, SupersysWeight::MUON_EFF_SYS_DN);
-//        *cutflow << TreeName("MUON_EFF_SYS");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon eff syst uncertainty (low pt"); {
-//        *cutflow << WeightSystematic(SupersysWeight::MUON_EFF_SYS_LOWPT_UP, SupersysWeight::MUON_EFF_SYS_LOWPT_DN);
-//        *cutflow << TreeName("MUON_EFF_SYS_LOWPT");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon eff iso stat uncertainty"); {
-//        *cutflow << WeightSystematic(SupersysWeight::MUON_EFF_ISO_STAT_UP, SupersysWeight::MUON_EFF_ISO_STAT_DN);
-//        *cutflow << TreeName("MUON_ISO_STAT");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon eff iso syst uncertainty"); {
-//        *cutflow << WeightSystematic(SupersysWeight::MUON_EFF_ISO_SYS_UP, SupersysWeight::MUON_EFF_ISO_SYS_DN);
-//        *cutflow << TreeName("MUON_ISO_SYS");
-//        *cutflow << SaveSystematic();
-//    }
-//
-//    // flavor tagging eff
-//    *cutflow << NewSystematic("shift in b-tag efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::FT_EFF_B_UP, SupersysWeight::FT_EFF_B_DN);
-//        *cutflow << TreeName("FT_EFF_B");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in c-tag efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::FT_EFF_C_UP, SupersysWeight::FT_EFF_C_DN);
-//        *cutflow << TreeName("FT_EFF_C");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in light tag (i.e. mis-tag) efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::FT_EFF_LT_UP, SupersysWeight::FT_EFF_LT_DN);
-//        *cutflow << TreeName("FT_EFF_Light");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift flavor tagging extrapolation ?"); {
-//        *cutflow << WeightSystematic(SupersysWeight::FT_EFF_EXTRAP_UP, SupersysWeight::FT_EFF_EXTRAP_DN);
-//        *cutflow << TreeName("FT_EFF_extrapolation");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift flavor tagging extrapolation - charm ?"); {
-//        *cutflow << WeightSystematic(SupersysWeight::FT_EFF_EXTRAPC_UP, SupersysWeight::FT_EFF_EXTRAPC_DN);
-//        *cutflow << TreeName("FT_EFF_extrapolation_charm");
-//        *cutflow << SaveSystematic();
-//    }
-//
-//    // jvt eff
-//    *cutflow << NewSystematic("shift in JVT efficiency"); {
-//        *cutflow << WeightSystematic(SupersysWeight::JVT_EFF_UP, SupersysWeight::JVT_EFF_DN);
-//        *cutflow << TreeName("JET_JVTEff");
-//        *cutflow << SaveSystematic();
-//    }
-//
-//    // pileup
-//    *cutflow << NewSystematic("shift in data mu (pile-up)"); {
-//        *cutflow << WeightSystematic(SupersysWeight::PILEUP_UP, SupersysWeight::PILEUP_DN);
-//        *cutflow << TreeName("PILEUP");
-//        *cutflow << SaveSystematic();
-//    }
-//
-//
-//    ////////////////////////////////////
-//    // shape systematics
-//    ////////////////////////////////////
-//
-//    // egamma
-//    *cutflow << NewSystematic("shift in e-gamma resolution (UP)"); {
-//        *cutflow << EventSystematic(NtSys::EG_RESOLUTION_ALL_UP);
-//        *cutflow << TreeName("EG_RESOLUTION_ALL_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in e-gamma resolution (DOWN)"); {
-//        *cutflow << EventSystematic(NtSys::EG_RESOLUTION_ALL_DN);
-//        *cutflow << TreeName("EG_RESOLUTION_ALL_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in e-gamma scale (UP)"); {
-//        *cutflow << EventSystematic(NtSys::EG_SCALE_ALL_UP);
-//        *cutflow << TreeName("EG_SCALE_ALL_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("shift in e-gamma scale (DOWN)"); {
-//        *cutflow << EventSystematic(NtSys::EG_SCALE_ALL_DN);
-//        *cutflow << TreeName("EG_SCALE_ALL_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    // muon
-//    *cutflow << NewSystematic("muon ID (UP)"); {
-//        *cutflow << EventSystematic(NtSys::MUON_ID_UP);
-//        *cutflow << TreeName("MUON_ID_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon ID (DOWN)"); {
-//        *cutflow << EventSystematic(NtSys::MUON_ID_DN);
-//        *cutflow << TreeName("MUON_ID_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon MS (UP)"); {
-//        *cutflow << EventSystematic(NtSys::MUON_MS_UP);
-//        *cutflow << TreeName("MUON_MS_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon MS (DOWN)"); {
-//        *cutflow << EventSystematic(NtSys::MUON_MS_DN);
-//        *cutflow << TreeName("MUON_MS_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon scale shift (UP)"); {
-//        *cutflow << EventSystematic(NtSys::MUON_SCALE_UP);
-//        *cutflow << TreeName("MUON_SCALE_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("muon scale shift (DN)"); {
-//        *cutflow << EventSystematic(NtSys::MUON_SCALE_DN);
-//        *cutflow << TreeName("MUON_SCALE_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//
-//    // jet
-//    *cutflow << NewSystematic("JER"); {
-//        *cutflow << EventSystematic(NtSys::JER);
-//        *cutflow << TreeName("JER");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("JES NP set 1 (up)"); {
-//        *cutflow << EventSystematic(NtSys::JET_GroupedNP_1_UP);
-//        *cutflow << TreeName("JET_GroupedNP_1_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("JES NP set 1 (down)"); {
-//        *cutflow << EventSystematic(NtSys::JET_GroupedNP_1_DN);
-//        *cutflow << TreeName("JET_GroupedNP_1_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("JES NP set 2 (up)"); {
-//        *cutflow << EventSystematic(NtSys::JET_GroupedNP_2_UP);
-//        *cutflow << TreeName("JET_GroupedNP_2_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("JES NP set 2 (down)"); {
-//        *cutflow << EventSystematic(NtSys::JET_GroupedNP_2_DN);
-//        *cutflow << TreeName("JET_GroupedNP_2_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("JES NP set 3 (up)"); {
-//        *cutflow << EventSystematic(NtSys::JET_GroupedNP_3_UP);
-//        *cutflow << TreeName("JET_GroupedNP_3_UP");
-//        *cutflow << SaveSystematic();
-//    }
-//    *cutflow << NewSystematic("JES NP set 3 (down)"); {
-//        *cutflow << EventSystematic(NtSys::JET_GroupedNP_3_DN);
-//        *cutflow << TreeName("JET_GroupedNP_3_DN");
-//        *cutflow << SaveSystematic();
-//    }
-//    //#warning only setting MET systematics
-//    // met
-//    //*cutflow << NewSystematic("MET TST Soft-Term resolution (parallel)"); {
-//    //    *cutflow << EventSystematic(NtSys::MET_SoftTrk_ResoPara);
-//    //    *cutflow << TreeName("MET_SoftTrk_ResoPara");
-//    //    *cutflow << SaveSystematic();
-//    //}
-//    //*cutflow << NewSystematic("MET TST Soft-Term resolution (perpendicular)"); {
-//    //    *cutflow << EventSystematic(NtSys::MET_SoftTrk_ResoPerp);
-//    //    *cutflow << TreeName("MET_SoftTrk_ResoPerp");
-//    //    *cutflow << SaveSystematic();
-//    //}
-//    //*cutflow << NewSystematic("MET TST Soft-Term shift in scale (UP)"); {
-//    //    *cutflow << EventSystematic(NtSys::MET_SoftTrk_ScaleUp);
-//    //    *cutflow << TreeName("MET_SoftTrk_ScaleUp");
-//    //    *cutflow << SaveSystematic();
-//    //}
-//    //*cutflow << NewSystematic("MET TST Soft-Term shift in scale (DOWN)"); {
-//    //    *cutflow << EventSystematic(NtSys::MET_SoftTrk_ScaleDown);
-//    //    *cutflow << TreeName("MET_SoftTrk_ScaleDown");
-//    //    *cutflow << SaveSystematic();
-//    //}
+    // The weight systematics (EL_EFF, MUON_EFF, FT_EFF, JVT_EFF, PILEUP) are
+    // no longer run as separate trees, see the 'syst_<name>' branches above
+    // (enabled with --weight-syst-array).
+
+    ////////////////////////////////////
+    // shape systematics
+    ////////////////////////////////////
 
+    // Each shape systematic is written to its own tree. Superflow reads each
+    // input event once and re-runs the object selection and the variables for
+    // every registered systematic, so with --syst-workers the systematics are
+    // split across forked workers that each read the input once for their
+    // whole group.
+    vector<const ShapeSystematic*> shape_syst_to_run;
+    if(rj_options.shape_syst) {
+        for(const ShapeSystematic& syst : shape_systematics) {
+            shape_syst_to_run.push_back(&syst);
+        }
+    }
+    auto register_shape_systematics = [&](int worker_idx, int n_workers) {
+        for(size_t is = 0; is < shape_syst_to_run.size(); is++) {
+            if((int)is % n_workers != worker_idx) continue;
+            const ShapeSystematic* syst = shape_syst_to_run[is];
+            *cutflow << NewSystematic(syst->description); {
+                *cutflow << EventSystematic(syst->sys);
+                *cutflow << TreeName(syst->tree_name);
+                *cutflow << SaveSystematic();
+            }
+        }
+    };
 
     ////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////
@@ -3486,10 +2305,611 @@ int main(int argc, char* argv[])
     ////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////
 
-//    delete pu_profile;
+    if(!cutflow->validate()) {
+        cout << analysis_name << "    ERROR Inconsistent variable dependencies, exiting" << endl;
+        exit(1);
+    }
+
+    // With --vars only the matching variables are booked, and only the
+    // producers (trigger decoding, object copies, RestFrames, ...) that they
+    // depend on are run.
+    if(!rj_options.var_patterns.empty()) {
+        if(rj_options.ordered_merge || checkpointed) rj_options.var_patterns.push_back("globalEntry");
+        if(!cutflow->select_variables(rj_options.var_patterns)) exit(1);
+        vector<string> columns = cutflow->saved_columns();
+        cout << analysis_name << "    Storing " << columns.size() << " selected variables, evaluating "
+                << cutflow->n_active() << " of " << cutflow->n_evaluable() << " variables and producers" << endl;
+        if(columns.empty()) {
+            cout << analysis_name << "    ERROR No variables selected with --vars" << endl;
+            exit(1);
+        }
+    }
+
+    // With differential storage (--syst-diff) the systematic trees hold only
+    // the variables that read a systematically varied object, plus the event
+    // key to join them back to the nominal tree (see RJTupler/SystematicJoin.h).
+    // The full nominal tree is then written by its own nominal-only worker.
+    // Events that a variation moves into the selection have no nominal
+    // entry to join to; join_nominal flags them.
+    const vector<string> varied_inputs = { "leptons", "jets", "met", "weights" };
+    const vector<string> event_key = { "runNumber", "eventNumber" };
+    bool syst_diff = (rj_options.syst_diff && !shape_syst_to_run.empty());
+
+    // Forked workers tag their report files with their output suffix.
+    auto tagged_file = [](string filename, const string& tag) -> string {
+        if(tag == "") return filename;
+        size_t ext = filename.rfind('.');
+        if(ext == string::npos || filename.find('/', ext) != string::npos) ext = filename.size();
+        filename.insert(ext, "_" + tag);
+        return filename;
+    };
+    auto job_label = [&](const string& tag) -> string {
+        return analysis_name + (tag == "" ? "" : " [" + tag + "]");
+    };
+
+    // With --timing every cut, variable and producer is timed, and each
+    // process reports on its own event loop when it is done.
+    rjt::StageTimer* timer = nullptr;
+    auto report_timing = [&](const string& tag) {
+        if(!timer) return;
+        timer->print_report(cout, job_label(tag));
+        if(rj_options.timing_json != "") {
+            string json = tagged_file(rj_options.timing_json, tag);
+            if(timer->write_json(json, job_label(tag)))
+                cout << analysis_name << "    Stage timing written to " << json << endl;
+        }
+    };
+
+    // With --progress the process running an event loop reports on it
+    // periodically from a background thread.
+    auto start_progress = [&](const string& tag) {
+        if(rj_options.progress_interval <= 0) return;
+        string metrics = (rj_options.progress_file != "" ? tagged_file(rj_options.progress_file, tag) : "");
+        progress = new rjt::ProgressReporter(job_label(tag), n_job_entries,
+                rj_options.progress_interval, metrics);
+        progress->start();
+    };
+    auto stop_progress = [&]() {
+        if(!progress) return;
+        progress->stop();
+        delete progress;
+        progress = nullptr;
+    };
+
+    // With --io-pipeline the process running the event loop starts the
+    // read-ahead cache and the I/O helper threads on its own chain.
+    auto start_io = [&](TChain* loop_chain) {
+        if(!rj_options.io_pipeline) return;
+        if(!rjt::start_io_pipeline(loop_chain, rj_options.io_threads, rj_options.read_ahead_mb, analysis_name)) exit(1);
+    };
+
+    // With --stage-clock each process reports the time split of its own
+    // event loop, and with --perf-counters/--alloc-audit its hardware and
+    // allocation counts per stage (the counters are started by the process
+    // running the event loop).
+    // The event loop of a process: the whole input with TChain::Process, or
+    // the ranges of the part given with the sharding options.
+    auto run_event_loop = [&](TChain* loop_chain) {
+        if(!sharded) {
+            loop_chain->Process(superflow, options.input.c_str(), options.n_events_to_process);
+            return;
+        }
+        size_t next_range = 0;
+        rjt::process_ranges(loop_chain, superflow, options.input, [&](rjt::EntryRange& range) {
+            if(next_range >= job_ranges.size()) return false;
+            range = job_ranges[next_range++];
+            return true;
+        }, &global_entry);
+    };
+    auto start_counters = [&]() {
+        if(!counters) return;
+        if(rj_options.perf_counters) counters->open();
+        if(rj_options.alloc_audit) counters->count_allocations();
+    };
+    auto report_stages = [&](const string& tag) {
+        if(clock) clock->print_report(cout, job_label(tag));
+        if(counters) {
+            counters->pause();
+            counters->print_report(cout, job_label(tag));
+        }
+    };
+
+    // The event loop of a whole sample in a process forked from the
+    // initialized one (--sample-list, --serve), at most n_requested of its
+    // entries (all if negative). The trigger tool was set up from the
+    // first input and the trigger histogram may differ between samples,
+    // so it is set up again from the sample's own first file.
+    auto process_sample = [&](const string& sample, Long64_t n_requested, const string& tag) -> int {
+        TChain* sample_chain = new TChain("susyNt");
+        sample_chain->SetDirectory(0);
+        ChainHelper::addInput(sample_chain, sample, false);
+        Long64_t n_entries = sample_chain->GetEntries();
+        options.input = sample;
+        options.n_events_to_process = (n_requested < 0 ? n_entries : std::min(n_requested, n_entries));
+        n_job_entries = options.n_events_to_process;
+        cout << analysis_name << "    Sample " << sample << " : " << n_entries << " entries" << endl;
+
+        superflow->nttools().initTriggerTool(ChainHelper::firstFile(sample, options.dbg));
+        superflow->setSampleName(sample);
+        superflow->setChain(sample_chain);
+        if(rj_options.timing) timer = new rjt::StageTimer();
+        cutflow->build(*superflow, timer, counters);
+        start_progress(tag);
+        start_io(sample_chain);
+        if(clock) clock->restart();
+        start_counters();
+        run_event_loop(sample_chain);
+        stop_progress();
+        report_timing(tag);
+        report_stages(tag);
+        return 0;
+    };
+
+    int n_syst_workers = std::min<int>(rj_options.syst_workers, shape_syst_to_run.size());
+    if(rj_options.workers > 1 && (n_syst_workers > 1 || syst_diff)) {
+        cout << analysis_name << "    ERROR --workers can't be combined with --syst-workers or --syst-diff" << endl;
+        exit(1);
+    }
+    if((!samples.empty() || rj_options.serve_socket != "") && syst_diff) {
+        cout << analysis_name << "    ERROR --sample-list and --serve can't be combined with --syst-diff" << endl;
+        exit(1);
+    }
+    if(checkpointed && (n_syst_workers > 1 || syst_diff)) {
+        cout << analysis_name << "    ERROR --checkpoint/--resume can't be combined with --syst-workers or --syst-diff" << endl;
+        exit(1);
+    }
+    if((rj_options.ordered_merge || rj_options.static_split || rj_options.merge_outputs) && rj_options.workers <= 1) {
+        cout << analysis_name << "    ERROR --ordered-merge, --static-split and --merge need --workers" << endl;
+        exit(1);
+    }
+    if(rj_options.ordered_merge && rj_options.merge_outputs) {
+        cout << analysis_name << "    ERROR Give either --ordered-merge or --merge" << endl;
+        exit(1);
+    }
+    if(rj_options.serve_socket != "") {
+        register_shape_systematics(0, 1);
+
+        // With --serve the initialized process stays up and runs the jobs
+        // sent to it (see RJTupler/JobServer.h), each one in a child forked
+        // from this state that streams its output back to the client. The
+        // child sets up the trigger tool from the requested input (see
+        // process_sample), not the one the server was started with.
+        delete chain;
+        chain = nullptr;
+        rjt::JobServer server(rj_options.serve_socket, analysis_name);
+        if(!server.listen()) exit(1);
+        server.serve([&](const rjt::JobRequest& request) -> int {
+            if(request.suffix != "") superflow->setFileSuffix(request.suffix);
+            return process_sample(request.input, request.n_events, request.suffix);
+        });
+    }
+    else if(!samples.empty()) {
+        register_shape_systematics(0, 1);
+
+        // The RestFrames tree and the registered cuts and variables are set
+        // up once, and every sample is processed in a child forked from this
+        // state (copy-on-write), writing its own output and cutflow. With
+        // --sample-jobs several run at a time, so the output of sample i
+        // gets 'sample<i>' in its suffix: two samples with the same name
+        // can't write to the same file.
+        delete chain;
+        chain = nullptr;
+        int n_jobs = std::min<int>(rj_options.sample_jobs, samples.size());
+        cout << analysis_name << "    Running " << samples.size() << " samples, " << n_jobs << " at a time" << endl;
+
+        int n_failed = rjt::run_forked_pool(samples.size(), n_jobs, [&](int sample_idx) -> int {
+            stringstream tag;
+            tag << "sample" << sample_idx;
+            superflow->setFileSuffix(options.suffix_name == "" ? tag.str() : options.suffix_name + "_" + tag.str());
+            return process_sample(samples[sample_idx], n_events_requested, tag.str());
+        }, analysis_name);
+
+        if(n_failed > 0) {
+            cout << analysis_name << "    ERROR " << n_failed << " of " << samples.size() << " samples failed" << endl;
+            exit(1);
+        }
+    }
+    else if(rj_options.queue_dir != "") {
+        register_shape_systematics(0, 1);
+
+        // With --queue-dir the work units (entry ranges of one input file)
+        // come from a queue shared with other ntupler processes. The first
+        // process to get here creates it from its input, the others join it.
+        rjt::WorkQueue queue(rj_options.queue_dir, rj_options.queue_timeout, analysis_name);
+        if(!queue.exists()) {
+            vector<rjt::WorkUnit> units = rjt::make_work_units(chain, options.n_events_to_process, rj_options.queue_unit);
+            if(!queue.create(units)) exit(1);
+        }
+        queue.print_status(cout);
+
+        // each unit is processed in a forked child with its own chain over
+        // the whole input, so that the sum of weights is the sample's and
+        // not that of the unit's file
+        delete chain;
+        chain = nullptr;
+
+        rjt::WorkUnit unit;
+        int n_units = 0;
+        int n_failed = 0;
+        while(queue.claim(unit)) {
+            // the output is tagged with the claim until the unit is done, so
+            // that a re-issued unit never overwrites the original's output
+            string claim_tag = unit.claim.substr(unit.claim.rfind('/') + 1);
+            std::replace(claim_tag.begin(), claim_tag.end(), '@', '_');
+            string suffix = (options.suffix_name == "" ? "" : options.suffix_name + "_") + unit.id;
+            string claim_suffix = (options.suffix_name == "" ? "" : options.suffix_name + "_") + claim_tag;
+            cout << analysis_name << "    Processing " << unit.id << " : entries [" << unit.first << ", "
+                    << unit.last << ") of " << unit.file << endl;
+
+            string output_report = output_report_file(claim_tag);
+            n_job_entries = unit.last - unit.first;
+            int failed = rjt::run_forked(1, [&](int) -> int {
+                superflow->setFileSuffix(claim_suffix);
+                if(rj_options.timing) timer = new rjt::StageTimer();
+                cutflow->build(*superflow, timer, counters);
+
+                TChain* unit_chain = new TChain("susyNt");
+                unit_chain->SetDirectory(0);
+                ChainHelper::addInput(unit_chain, options.input, false);
+                vector<rjt::EntryRange> ranges = rjt::unit_ranges(unit_chain, unit, analysis_name);
+                if(ranges.empty()) return 1;
+                superflow->setChain(unit_chain);
+                start_io(unit_chain);
+                start_progress(suffix);
+                if(clock) clock->restart();
+                start_counters();
+                size_t next_range = 0;
+                rjt::process_ranges(unit_chain, superflow, options.input, [&](rjt::EntryRange& range) {
+                    if(next_range >= ranges.size()) return false;
+                    queue.heartbeat(unit);
+                    range = ranges[next_range++];
+                    return true;
+                }, &global_entry);
+                stop_progress();
+                report_timing(suffix);
+                report_stages(suffix);
+                if(!report_output_file(output_report, find_output_file(claim_suffix))) {
+                    cout << analysis_name << "    ERROR Unable to find the output of " << unit.id << endl;
+                    return 1;
+                }
+                return 0;
+            }, analysis_name);
+
+            string output = read_output_report(output_report);
+            if(failed > 0 || output == "") {
+                cout << analysis_name << "    ERROR Processing of " << unit.id << " failed, giving it back" << endl;
+                if(output != "") remove(output.c_str());
+                queue.release(unit);
+                n_failed++;
+                continue;
+            }
+            if(!queue.complete(unit)) {
+                cout << analysis_name << "    WARNING " << unit.id << " was re-issued while being processed, discarding its output" << endl;
+                remove(output.c_str());
+                continue;
+            }
+            string final_output = output;
+            size_t tag = final_output.rfind(claim_tag + ".root");
+            if(tag != string::npos) final_output = final_output.substr(0, tag) + unit.id + ".root";
+            if(rename(output.c_str(), final_output.c_str()) != 0) final_output = output;
+            cout << analysis_name << "    Finished " << unit.id << " -> " << final_output << endl;
+            n_units++;
+        }
+        cout << analysis_name << "    Processed " << n_units << " work units (" << n_failed << " failed attempts)" << endl;
+        queue.print_status(cout);
+    }
+    else if(rj_options.workers > 1) {
+        register_shape_systematics(0, 1);
+
+        // the entries are split at the cluster boundaries of the input
+        // trees, and the workers take the ranges from a shared queue,
+        // stealing from each other once their own share is done (unless
+        // --static-split keeps each one to its own contiguous block)
+        rjt::WorkStealingQueue queue((sharded ? job_ranges : rjt::cluster_ranges(chain, options.n_events_to_process)),
+                rj_options.workers, !rj_options.static_split);
+        if(!queue.valid()) exit(1);
+        cout << analysis_name << "    Running " << queue.n_ranges() << " entry ranges on "
+                << rj_options.workers << " workers" << endl;
+
+        // the workers open their own chain so that no file offsets are shared
+        delete chain;
+        chain = nullptr;
+
+        // everything initialized so far is shared copy-on-write with the
+        // workers, each one records how much of it stayed shared
+        rjt::MemoryReport memory(rj_options.workers);
+
+        // with --cpu-list each worker is pinned, and its memory kept on
+        // its cpu's NUMA node
+        vector<rjt::CpuPlacement> placement = rjt::plan_placement(rj_options.cpus, rj_options.workers);
+        rjt::print_placement(cout, analysis_name, placement);
+
+        auto worker_suffix = [&](int worker_idx) -> string {
+            stringstream suffix;
+            if(options.suffix_name != "") suffix << options.suffix_name << "_";
+            suffix << "worker" << worker_idx;
+            return suffix.str();
+        };
+
+        // named by the parent, the workers write to them
+        vector<string> output_reports;
+        for(int iw = 0; iw < rj_options.workers; iw++) output_reports.push_back(output_report_file(worker_suffix(iw)));
+
+        int n_failed = rjt::run_forked(rj_options.workers, [&](int worker_idx) -> int {
+            if(!placement.empty()) rjt::apply_placement(placement[worker_idx], analysis_name);
+            string suffix = worker_suffix(worker_idx);
+            stringstream unique_suffix;
+            unique_suffix << suffix << "_" << getpid();
+            superflow->setFileSuffix(unique_suffix.str());
+            if(rj_options.timing) timer = new rjt::StageTimer();
+            cutflow->build(*superflow, timer, counters);
+
+            TChain* worker_chain = new TChain("susyNt");
+            worker_chain->SetDirectory(0);
+            ChainHelper::addInput(worker_chain, options.input, false);
+            superflow->setChain(worker_chain);
+            start_io(worker_chain);
+            start_progress(suffix);
+            if(clock) clock->restart();
+            start_counters();
+            rjt::process_ranges(worker_chain, superflow, options.input, [&](rjt::EntryRange& range) {
+                return queue.next(worker_idx, range);
+            }, &global_entry);
+            stop_progress();
+            memory.record(worker_idx);
+            report_timing(suffix);
+            report_stages(suffix);
+            string output = finish_output_file(unique_suffix.str(), suffix);
+            if(!report_output_file(output_reports[worker_idx], output)) {
+                cout << analysis_name << "    ERROR Unable to find the output of worker " << worker_idx << endl;
+                return 1;
+            }
+            return 0;
+        }, analysis_name);
+
+        // the outputs the workers reported
+        vector<string> worker_files;
+        for(int iw = 0; iw < rj_options.workers; iw++) {
+            worker_files.push_back(read_output_report(output_reports[iw]));
+        }
+
+        queue.print_report(cout, analysis_name);
+        memory.print_report(cout, analysis_name);
+        if(n_failed > 0) {
+            cout << analysis_name << "    ERROR " << n_failed << " worker(s) failed" << endl;
+            exit(1);
+        }
+
+        // the merged file takes the name of the first worker's output
+        // without the worker tag. With --static-split (or --ordered-merge)
+        // its entries come in input order and, the random trigger draw
+        // being seeded per event, it is the same as a serial run.
+        if(rj_options.ordered_merge || rj_options.merge_outputs) {
+            string merged = worker_files[0];
+            size_t tag = merged.rfind("worker0.root");
+            if(tag != string::npos && tag > 0 && merged[tag-1] == '_') tag--;
+            merged = merged.substr(0, tag) + ".root";
+            if(rj_options.ordered_merge) {
+                if(!rjt::ordered_merge(worker_files, merged, "globalEntry", analysis_name)) exit(1);
+            }
+            else if(!rjt::concatenate_outputs(worker_files, merged, analysis_name)) {
+                exit(1);
+            }
+            for(const string& file : worker_files) remove(file.c_str());
+            cout << analysis_name << "    Output merged" << (rj_options.ordered_merge || rj_options.static_split ? " in input order" : "")
+                    << " into " << merged << endl;
+        }
+    }
+    else if(checkpointed) {
+        register_shape_systematics(0, 1);
+
+        // With --checkpoint the entries are processed in segments, each one
+        // run in a forked child writing its own output file. Once a segment
+        // is written it is recorded in the checkpoint, so that --resume can
+        // continue after the last completed segment, and at the end the
+        // segments are merged into the output of an uninterrupted run. The
+        // two agree event by event since every per-event quantity, the
+        // random trigger draw included (see event_seed), depends only on
+        // the event and not on where in the job it is processed.
+        vector<rjt::EntryRange> ranges = (sharded ? job_ranges : rjt::cluster_ranges(chain, options.n_events_to_process));
+        delete chain;
+        chain = nullptr;
+
+        string sidecar = rj_options.checkpoint_file;
+        if(sidecar == "") sidecar = tagged_file(analysis_name + ".checkpoint", options.suffix_name);
+        rjt::Checkpoint checkpoint(sidecar, options.input, n_job_entries, rj_options.checkpoint_entries);
+        if(rj_options.resume && checkpoint.exists()) {
+            if(!checkpoint.load(analysis_name)) exit(1);
+            cout << analysis_name << "    Resuming from " << sidecar << " : entries before "
+                    << checkpoint.last_entry() << " done in " << checkpoint.segments().size() << " segments" << endl;
+        }
+        else if(checkpoint.segment_entries() <= 0) {
+            cout << analysis_name << "    ERROR No checkpoint " << sidecar << " to resume from, and no --checkpoint given" << endl;
+            exit(1);
+        }
+        else if(checkpoint.exists()) {
+            cout << analysis_name << "    WARNING Overwriting the checkpoint " << sidecar << " (use --resume to continue from it)" << endl;
+        }
+
+        vector<vector<rjt::EntryRange> > segments = rjt::checkpoint_segments(ranges, checkpoint.segment_entries());
+        const vector<rjt::CheckpointSegment>& done = checkpoint.segments();
+        for(size_t is = 0; is < done.size(); is++) {
+            if(is >= segments.size() || segments[is].front().first != done[is].range.first
+                    || segments[is].back().last != done[is].range.last) {
+                cout << analysis_name << "    ERROR Checkpoint " << sidecar << " does not match the segments of this job" << endl;
+                exit(1);
+            }
+        }
+        auto segment_suffix = [&](size_t segment_idx) -> string {
+            stringstream suffix;
+            if(options.suffix_name != "") suffix << options.suffix_name << "_";
+            suffix << "segment" << segment_idx;
+            return suffix.str();
+        };
+
+        for(size_t is = done.size(); is < segments.size(); is++) {
+            string suffix = segment_suffix(is);
+            rjt::EntryRange span(segments[is].front().first, segments[is].back().last);
+            string output_report = output_report_file(suffix);
+            n_job_entries = 0;
+            for(const rjt::EntryRange& range : segments[is]) n_job_entries += range.size();
+
+            int failed = rjt::run_forked(1, [&](int) -> int {
+                // a leftover file of the interrupted run can't be mistaken
+                // for this segment's output
+                stringstream unique_suffix;
+                unique_suffix << suffix << "_" << getpid();
+                superflow->setFileSuffix(unique_suffix.str());
+                if(rj_options.timing) timer = new rjt::StageTimer();
+                cutflow->build(*superflow, timer, counters);
+
+                TChain* segment_chain = new TChain("susyNt");
+                segment_chain->SetDirectory(0);
+                ChainHelper::addInput(segment_chain, options.input, false);
+                superflow->setChain(segment_chain);
+                start_io(segment_chain);
+                start_progress(suffix);
+                if(clock) clock->restart();
+                start_counters();
+                size_t next_range = 0;
+                rjt::process_ranges(segment_chain, superflow, options.input, [&](rjt::EntryRange& range) {
+                    if(next_range >= segments[is].size()) return false;
+                    range = segments[is][next_range++];
+                    return true;
+                }, &global_entry);
+                stop_progress();
+                report_timing(suffix);
+                report_stages(suffix);
+                if(!report_output_file(output_report, finish_output_file(unique_suffix.str(), suffix))) {
+                    cout << analysis_name << "    ERROR Unable to find the output of segment " << is << endl;
+                    return 1;
+                }
+                return 0;
+            }, analysis_name);
+
+            // the exact path goes into the checkpoint
+            string output = read_output_report(output_report);
+            if(failed > 0 || output == "") {
+                cout << analysis_name << "    ERROR Segment " << is << " (entries [" << span.first << ", "
+                        << span.last << ")) failed, rerun with --resume to continue" << endl;
+                exit(1);
+            }
+            checkpoint.add_segment(span, output);
+            if(!checkpoint.save()) exit(1);
+            cout << analysis_name << "    Checkpoint: entries before " << span.last << " done ("
+                    << (is + 1) << " of " << segments.size() << " segments)" << endl;
+        }
+
+        // the merged file takes the name of the first segment's output
+        // without the segment tag
+        vector<string> segment_files;
+        for(const rjt::CheckpointSegment& segment : checkpoint.segments()) segment_files.push_back(segment.file);
+        if(segment_files.empty()) {
+            cout << analysis_name << "    ERROR No entries to process" << endl;
+            exit(1);
+        }
+        string merged = segment_files[0];
+        size_t tag = merged.rfind("segment0.root");
+        if(tag != string::npos && tag > 0 && merged[tag-1] == '_') tag--;
+        merged = merged.substr(0, tag) + ".root";
+        if(!rjt::ordered_merge(segment_files, merged, "globalEntry", analysis_name)) exit(1);
+        checkpoint.remove();
+        for(const string& file : segment_files) remove(file.c_str());
+        cout << analysis_name << "    Output of " << segment_files.size() << " segments merged into " << merged << endl;
+    }
+    else if(n_syst_workers <= 1 && !syst_diff) {
+        register_shape_systematics(0, 1);
+        if(rj_options.timing) timer = new rjt::StageTimer();
+        cutflow->build(*superflow, timer, counters);
+
+        // initialize the cutflow and start the event loop
+        start_progress("");
+        start_io(chain);
+        if(clock) clock->restart();
+        start_counters();
+        run_event_loop(chain);
+        stop_progress();
+        report_timing("");
+        report_stages("");
+    }
+    else {
+        // The nominal tree is written once, by a nominal-only worker. The
+        // sysgroup workers still make Superflow's nominal pass, which the
+        // systematic passes of each event follow, but their outputs keep
+        // only the trees of their own systematics: N copies of the nominal
+        // tree and cutflow would otherwise be added up by hadd.
+        n_syst_workers = std::max(n_syst_workers, 1);
+        int n_workers = n_syst_workers + 1;
+        cout << analysis_name << "    Running " << shape_syst_to_run.size() << " shape systematics on "
+                << n_syst_workers << " workers (+1 nominal worker)" << endl;
+        if(syst_diff) {
+            rjt::FlowBuilder probe(*cutflow);
+            probe.save_only_dependent_on(varied_inputs, event_key);
+            vector<string> columns = probe.saved_columns();
+            cout << analysis_name << "    Systematic trees store " << columns.size() << " of "
+                    << cutflow->saved_columns().size() << " variables:";
+            for(const string& column : columns) cout << " " << column;
+            cout << endl;
+        }
 
-    // initialize the cutflow and start the event loop
-    chain->Process(cutflow, options.input.c_str(), options.n_events_to_process);
+        // the workers open their own chain so that no file offsets are shared
+        delete chain;
+        chain = nullptr;
+
+        vector<rjt::CpuPlacement> placement = rjt::plan_placement(rj_options.cpus, n_workers);
+        rjt::print_placement(cout, analysis_name, placement);
+
+        int n_failed = rjt::run_forked(n_workers, [&](int worker_idx) -> int {
+            if(!placement.empty()) rjt::apply_placement(placement[worker_idx], analysis_name);
+            stringstream suffix;
+            if(options.suffix_name != "") suffix << options.suffix_name << "_";
+            vector<string> group_trees;
+            if(worker_idx == n_syst_workers) {
+                superflow->setRunMode(SuperflowRunMode::nominal);
+                suffix << "nominal";
+            }
+            else {
+                register_shape_systematics(worker_idx, n_syst_workers);
+                for(size_t is = worker_idx; is < shape_syst_to_run.size(); is += n_syst_workers) {
+                    group_trees.push_back(shape_syst_to_run[is]->tree_name);
+                }
+                if(syst_diff) cutflow->save_only_dependent_on(varied_inputs, event_key);
+                suffix << "sysgroup" << worker_idx;
+            }
+            stringstream unique_suffix;
+            unique_suffix << suffix.str() << "_" << getpid();
+            superflow->setFileSuffix(unique_suffix.str());
+            if(rj_options.timing) timer = new rjt::StageTimer();
+            cutflow->build(*superflow, timer, counters);
+
+            TChain* worker_chain = new TChain("susyNt");
+            worker_chain->SetDirectory(0);
+            ChainHelper::addInput(worker_chain, options.input, false);
+            superflow->setChain(worker_chain);
+            start_progress(suffix.str());
+            start_io(worker_chain);
+            if(clock) clock->restart();
+            start_counters();
+            run_event_loop(worker_chain);
+            stop_progress();
+            report_timing(suffix.str());
+            report_stages(suffix.str());
+
+            string output = finish_output_file(unique_suffix.str(), suffix.str());
+            if(output == "") return 1;
+            if(!group_trees.empty() && !rjt::keep_only(output, group_trees, job_label(suffix.str()))) return 1;
+            return 0;
+        }, analysis_name);
+
+        if(n_failed > 0) {
+            cout << analysis_name << "    ERROR " << n_failed << " systematic worker(s) failed" << endl;
+            exit(1);
+        }
+    }
+    delete timer;
+    delete superflow;
+    delete clock;
+    delete counters;
     delete cutflow;
     delete chain;
     cout << "La Fin." << endl;
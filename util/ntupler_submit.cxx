@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// ntupler_submit
+//
+// Sends a job to an ntupler started with --serve <socket> (see
+// RJTupler/JobServer.h), prints the job's output as it runs and exits
+// with the job's status.
+//
+//      ntupler_submit <socket> -i <input> [-n <events>] [-o <output dir>] [-s <suffix>]
+//      ntupler_submit <socket> --shutdown
+//
+// Relative input and output paths are taken from the current directory,
+// the output goes to the current directory by default.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// std
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <climits>
+
+// posix
+#include <unistd.h>
+
+// RJTupler
+#include "RJTupler/JobServer.h"
+
+using namespace std;
+
+const string analysis_name = "ntupler_submit";
+
+// the path made absolute, if it exists
+static string absolute_path(const string& path)
+{
+    char resolved[PATH_MAX];
+    if(realpath(path.c_str(), resolved)) return resolved;
+    return path;
+}
+
+void print_usage()
+{
+    cout << analysis_name << "    Usage: " << analysis_name << " <socket> -i <input> [-n <events>] [-o <output dir>] [-s <suffix>]" << endl;
+    cout << analysis_name << "           " << analysis_name << " <socket> --shutdown" << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    if(argc < 3 || string(argv[1]) == "-h" || string(argv[1]) == "--help") {
+        print_usage();
+        return (argc == 2 ? 0 : 1);
+    }
+
+    string socket_path = argv[1];
+    rjt::JobRequest request;
+    request.output_dir = ".";
+    for(int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--shutdown") request.shutdown = true;
+        else if(arg == "-i" && has_value) request.input = absolute_path(argv[++i]);
+        else if(arg == "-n" && has_value) request.n_events = atoll(argv[++i]);
+        else if(arg == "-o" && has_value) request.output_dir = argv[++i];
+        else if(arg == "-s" && has_value) request.suffix = argv[++i];
+        else {
+            cout << analysis_name << "    ERROR Unknown or incomplete argument " << arg << endl;
+            print_usage();
+            return 1;
+        }
+    }
+    if(!request.shutdown && request.input == "") {
+        cout << analysis_name << "    ERROR No input given" << endl;
+        return 1;
+    }
+    request.output_dir = absolute_path(request.output_dir);
+
+    int status = rjt::submit_job(socket_path, request, cout);
+    if(status < 0) {
+        cout << analysis_name << "    ERROR No job status received from the server" << endl;
+        return 1;
+    }
+    return status;
+}